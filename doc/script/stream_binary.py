@@ -0,0 +1,194 @@
+#!/usr/bin/env python3
+"""\
+
+Stream g-code to grbl controller with the binary protocol
+
+This script tokenizes every g-code line on the host and sends
+it to grbl as a CRC-8 checked binary frame, after switching
+grbl to the binary protocol with the 0x88 realtime command.
+Word values are sent as binary floats, or as 16-bit values in
+thousandths when that is exact, so grbl doesn't have to parse
+ASCII numbers. Lines that aren't plain g-code words, like '$'
+commands, are sent as line frames. Frames are streamed ahead
+by counting the bytes in grbl's serial read buffer, and each
+binary ack reports the status and the free planner blocks and
+serial read buffer bytes. Requires grbl compiled with
+ENABLE_BINARY_PROTOCOL, see doc/markdown/interface.md.
+
+With -o, the frames are written to a file instead, e.g. to
+pipe them into the grbl host simulator.
+
+---------------------
+The MIT License (MIT)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+---------------------
+"""
+
+import argparse
+import re
+import struct
+import sys
+import time
+
+RX_BUFFER_SIZE = 255
+BAUD_RATE = 115200
+
+CMD_RESET = 0x18
+CMD_BINARY_MODE_ENTER = 0x88
+CMD_BINARY_MODE_EXIT = 0x89
+FRAME_START = 0x02
+FRAME_ESCAPE = 0x7D
+SERIAL_NO_DATA = 0xFF  # Marks an empty serial read buffer in grbl.
+FRAME_ACK = 0xA5
+FRAME_TYPE_BLOCK = 0x01
+FRAME_TYPE_LINE = 0x02
+REALTIME_COMMANDS = ('?', '!', '~')  # Sent as is between frames.
+
+WORD = re.compile(r'([A-Z])([-+]?(?:\d+\.?\d*|\.\d+))')
+
+
+def crc8(data):
+    """CRC-8 with polynomial 0x07 and initial value 0, as in grbl's crc8_update()."""
+    crc = 0
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+def clean_line(line):
+    """Removes comments and whitespace and capitalizes, like grbl's line protocol does."""
+    line = re.sub(r'\(.*?\)', '', line.split(';')[0])
+    return re.sub(r'\s', '', line).upper()
+
+
+def encode_payload(line):
+    """Returns the frame payload of a clean line: a tokenized block, or the line itself."""
+    if line.startswith('$') or WORD.sub('', line):
+        return bytes([FRAME_TYPE_LINE]) + line.encode('ascii')
+    payload = bytearray([FRAME_TYPE_BLOCK])
+    for letter, text in WORD.findall(line):
+        value = float(text)
+        fixed = round(value*1000)
+        decimals = len(text.split('.')[1]) if '.' in text else 0
+        if decimals <= 3 and -32768 <= fixed <= 32767:
+            payload += letter.lower().encode('ascii') + struct.pack('<h', fixed)
+        else:
+            payload += letter.encode('ascii') + struct.pack('<f', value)
+    return bytes(payload)
+
+
+def encode_frame(payload):
+    """Returns the frame of a payload, escapes included, as it's stored in grbl's read buffer."""
+    data = payload + bytes([crc8(payload)])
+    frame = bytearray([FRAME_START])
+    for byte in bytes([len(data)]) + data:
+        if byte in (CMD_RESET, FRAME_START, FRAME_ESCAPE, SERIAL_NO_DATA):
+            frame += bytes([FRAME_ESCAPE, byte ^ 0x20])
+        else:
+            frame.append(byte)
+    return bytes(frame)
+
+
+def read_ack(port, verbose):
+    """Waits for the next ack, passing on any text grbl sends meanwhile."""
+    text = b''
+    while True:
+        byte = port.read(1)
+        if not byte:
+            continue
+        if byte[0] != FRAME_ACK:
+            text += byte
+            if byte == b'\n':
+                if verbose:
+                    print('  ' + text.decode('ascii', 'replace').strip())
+                text = b''
+            continue
+        ack = port.read(4)
+        if len(ack) == 4 and crc8(ack[:3]) == ack[3]:
+            return ack[0], ack[1], ack[2]
+        print('  Corrupt ack ' + ack.hex())
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Stream g-code file to grbl with binary frames. (pySerial library required, unless -o is used)')
+    parser.add_argument('gcode_file', type=argparse.FileType('r'),
+            help='g-code filename to be streamed')
+    parser.add_argument('device_file', nargs='?',
+            help='serial device path')
+    parser.add_argument('-o', '--output', type=argparse.FileType('wb'),
+            help='write the frames to this file instead of streaming them')
+    parser.add_argument('-q', '--quiet', action='store_true', default=False,
+            help='suppress output text')
+    args = parser.parse_args()
+
+    frames = []
+    for line in args.gcode_file:
+        line = clean_line(line)
+        if line in REALTIME_COMMANDS:
+            frames.append((None, line.encode('ascii')))
+        elif line:
+            frames.append((line, encode_frame(encode_payload(line))))
+
+    if args.output:
+        args.output.write(bytes([CMD_BINARY_MODE_ENTER]))
+        for line, frame in frames:
+            args.output.write(frame)
+        args.output.write(bytes([CMD_BINARY_MODE_EXIT]))
+        return
+    if not args.device_file:
+        parser.error('a serial device or an output file is required')
+
+    import serial
+    port = serial.Serial(args.device_file, BAUD_RATE, timeout=0.1)
+    port.write(b'\r\n\r\n')  # Wake up grbl
+    time.sleep(2)
+    port.reset_input_buffer()
+    port.write(bytes([CMD_BINARY_MODE_ENTER]))
+
+    # Send frames while they fit in grbl's serial read buffer, counting the bytes of each frame,
+    # and retire the oldest frame upon each ack.
+    sent = []
+    errors = 0
+    for line, frame in frames + [(None, b'')]:
+        size = len(frame) if line else 0
+        while sent and ((not frame) or sum(s for _, s in sent) + size > RX_BUFFER_SIZE):
+            status, planner_free, rx_free = read_ack(port, not args.quiet)
+            done, _ = sent.pop(0)
+            if status:
+                errors += 1
+            if not args.quiet:
+                print('%-5s %s [planner free:%d rx free:%d]' % (
+                    'ok' if status == 0 else 'error:%d' % status, done, planner_free, rx_free))
+        if not frame:
+            break
+        port.write(frame)
+        if line:
+            sent.append((line, size))
+
+    port.write(bytes([CMD_BINARY_MODE_EXIT]))
+    port.close()
+    if errors:
+        sys.exit('%d frames failed' % errors)
+
+
+if __name__ == '__main__':
+    main()
@@ -32,7 +32,8 @@
 
 #include "grbl.h" // For Arduino IDE compatibility.
 
-// Serial baud rate
+// Serial baud rate. Also the default of the $40 baud rate setting, which Grbl switches to at power-up.
+// The $B=<baud> command switches the baud rate until the next power-up, once the host confirms it.
 #define BAUD_RATE 115200
 
 // Define CPU pin map and default settings.
@@ -206,6 +207,10 @@
 #define CMD_SAFETY_DOOR 0x84
 #define CMD_JOG_CANCEL  0x85
 #define CMD_DEBUG_REPORT 0x86 // Only when DEBUG enabled, sends debug report in '{}' braces.
+#define CMD_ISR_PROFILE_REPORT 0x87 // Only when STEPPER_ISR_PROFILER enabled, sends and clears ISR profile.
+#define CMD_BINARY_MODE_ENTER 0x88 // Only when ENABLE_BINARY_PROTOCOL enabled, streams binary frames.
+#define CMD_BINARY_MODE_EXIT 0x89  // Only when ENABLE_BINARY_PROTOCOL enabled, returns to g-code lines.
+#define CMD_STARVATION_RESET 0x8A  // Only when REPORT_FIELD_STARVATION_COUNTERS enabled, clears counters.
 #define CMD_FEED_OVR_RESET 0x90         // Restores feed override value to 100%.
 #define CMD_FEED_OVR_COARSE_PLUS 0x91
 #define CMD_FEED_OVR_COARSE_MINUS 0x92
@@ -411,6 +416,36 @@
 // Enables code for debugging purposes. Not for general use and always in constant flux.
 //#define DEBUG // Uncomment to enable. Default disabled.
 
+// Instruments the stepper interrupt to measure how long it takes, in CPU cycles, by reading TCNT1 on
+// entry and exit. The minimum, mean and maximum durations, the worst interrupt latency, the number of
+// overruns past the next Timer1 compare and a histogram in 4usec bins are kept for each AMASS level.
+// Sending the CMD_ISR_PROFILE_REPORT realtime command prints one '[ISR:...]' line per AMASS level and
+// clears the counters, so a measurement covers the time since the previous report. This shows how
+// much headroom is left at high step rates before steps are dropped. The main loop time spent to
+// prepare each step segment is also measured with the otherwise unused Timer5 and reported on a
+// '[PREP:...]' line, including any interrupts serviced meanwhile.
+// NOTE: Requires AMASS, which keeps Timer1 unprescaled. The measurement itself adds a few cycles.
+// #define STEPPER_ISR_PROFILER // Default disabled. Uncomment to enable.
+
+// Enables a binary streaming protocol alongside the normal g-code line protocol. After the
+// CMD_BINARY_MODE_ENTER realtime command, the host sends CRC-8 protected frames holding pre-tokenized
+// g-code blocks, i.e. word letters with binary float or fixed-point values, so Grbl doesn't have to
+// scan and convert ASCII numbers. Each frame is answered with a short binary ack, instead of 'ok' or
+// 'error:', that also carries the free planner blocks and serial RX bytes, so a host can keep both
+// buffers full without counting characters. Realtime commands work as usual between frames, and a
+// soft-reset or CMD_BINARY_MODE_EXIT returns to the line protocol. See doc/markdown/interface.md for
+// the frame format and doc/script/stream_binary.py for a host implementation.
+// #define ENABLE_BINARY_PROTOCOL // Default disabled. Uncomment to enable.
+
+// Tokenizes g-code lines while they are read from the serial buffer, converting each word value to
+// a float as its characters arrive, instead of copying the whole line into the line buffer and
+// scanning it a second time in the g-code parser. The words are stored in the same tokenized form
+// as the binary protocol blocks. '$' system commands are still stored and parsed as text lines.
+// Since every word takes five bytes, a line fits at most 51 words, but no longer has a limit on its
+// characters otherwise.
+// NOTE: Not compatible with REPORT_ECHO_LINE_RECEIVED, which needs the received line as text.
+// #define TOKENIZE_GCODE_ON_RECEIVE // Default disabled. Uncomment to enable.
+
 // Configure rapid, feed, and spindle override settings. These values define the max and min
 // allowable override values and the coarse and fine increments per command received. Please
 // note the allowable values in the descriptions following each define.
@@ -448,6 +483,13 @@
 #define REPORT_FIELD_OVERRIDES // Default enabled. Comment to disable.
 #define REPORT_FIELD_LINE_NUMBERS // Default enabled. Comment to disable.
 
+// Adds a '|St:' field to every status report, counting the times the serial read buffer, the planner
+// buffer and the step segment buffer ran dry while there was still motion to execute. This shows
+// whether a slow job is limited by the serial link, by the parser and planner, or by the step segment
+// preparation. The CMD_STARVATION_RESET realtime command clears the counters. Meant for diagnostics.
+// See doc/markdown/interface.md for what each counter measures.
+// #define REPORT_FIELD_STARVATION_COUNTERS // Default disabled. Uncomment to enable.
+
 // Some status report data isn't necessary for realtime, only intermittently, because the values don't
 // change often. The following macros configures how many times a status report needs to be called before
 // the associated data is refreshed and included in the status report. However, if one of these value
@@ -471,6 +513,16 @@
 // certain the step segment buffer is increased/decreased to account for these changes.
 #define ACCELERATION_TICKS_PER_SECOND 100
 
+// Maximum length of a step segment while cruising, in acceleration ticks. A segment that starts in
+// the cruise portion of a block is extended up to this many ticks, but never past the start of the
+// deceleration ramp, so ramps are still computed once per tick. This cuts the main loop time spent
+// in segment prep during long cruises. To keep the feed hold and override response unchanged, the
+// segment buffer is then only filled up to the time that SEGMENT_BUFFER_SIZE-1 ticks would hold,
+// rather than by segment count. Each extended segment may add up to the extra ticks to that latency.
+// NOTE: Only cruises with at least one step per tick are extended, and the steps of an extended
+// segment are bounded to fit the 16-bit segment step count.
+#define SEGMENT_CRUISE_TICKS 4 // (1-8) Set to 1 for fixed length segments.
+
 // Adaptive Multi-Axis Step Smoothing (AMASS) is an advanced feature that does what its name implies,
 // smoothing the stepping of multi-axis motions. This feature smooths motion particularly at low step
 // frequencies below 10kHz, where the aliasing between axes of multi-axis motions can cause audible
@@ -478,6 +530,50 @@
 // step smoothing. See stepper.c for more details on the AMASS system works.
 #define ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING  // Default enabled. Comment to disable.
 
+// Computes the step segments in integer fixed-point math rather than floats. The planner and the
+// velocity profile of each block, evaluated once per block load or replan, remain in floats. The
+// per-segment ramp integration and step rate computation, which run for every segment in the main
+// loop, track the distance remaining as Q32.32 steps, speeds as Q16.16 steps per segment and time as
+// Q16.16 segments. Full segments then cost only integer adds and shifts, and the distance is
+// integrated exactly instead of losing float precision on long blocks. The segment time sent to the
+// stepper ISR is rounded to 1/256 of a step, which is well below the ISR timer resolution.
+// NOTE: The acceleration is rounded to 1/65536 step per segment squared, which is noticeable only
+// with very low acceleration and steps/mm settings. Blocks must not exceed 2^31 steps.
+// #define USE_FIXED_POINT_MOTION // Default disabled. Uncomment to enable.
+
+// Executes the acceleration and deceleration ramps of every block as jerk-limited S-curves, instead of
+// jumping straight to full acceleration. Each ramp ramps its acceleration up at the jerk limit, holds
+// it and ramps it back down, so the speed changes smoothly and excites less frame resonance. The
+// maximum jerk of each axis is set by $140-$145. The planner plans every ramp with the time the jerk
+// limit needs, the trapezoidal ramp time stretched by acceleration/jerk, so the S-curves stay within
+// both the $120-$125 acceleration and the jerk settings. The speed profile is then no longer linear in
+// speed squared, so each new block replans the whole buffer, except the block being executed, which
+// keeps its exit speed. An override or feed hold that changes a block midway may still ramp it faster
+// than the jerk limit, if the rest of the block is too short for it.
+// NOTE: Not compatible with USE_FIXED_POINT_MOTION. Adds a few float computations to each segment.
+// Replanning costs a few roots for every block on the deceleration ramp, which is most of the buffer
+// with short segments. On the host simulator (sim -p), a program of 3000 short segments plans in
+// 9.7us per block with 80 blocks and 5.0us with 36, against 0.26us with the trapezoidal ramps. Lower
+// BLOCK_BUFFER_SIZE if such programs stream too slowly.
+// #define ENABLE_S_CURVE_ACCELERATION // Default disabled. Uncomment to enable.
+
+// Shapes the acceleration and deceleration ramps of every block with an input shaper, to cancel the
+// ringing of a frame resonance that the ramps would otherwise excite. The constant acceleration of
+// each ramp is convolved with the impulses of a ZV, ZVD or EI shaper, set by $41, tuned to the
+// resonance frequency and damping ratio set by $42 and $43. ZV is the shortest and most sensitive
+// to a mistuned frequency, ZVD and EI take twice as long but tolerate more error. The shaper acts
+// along the path, so all axes share one frequency, and corners stay limited by junction deviation.
+// The shaper only delays the acceleration, so the planner plans the full $120-$125 acceleration and
+// adds the shaper time to each ramp. Like with the S-curves above, each new block then replans the
+// whole buffer. Ramps in blocks too short to cover within the shaper time run unshaped. The shaped
+// ramps are executed in segments of at most 5ms, and of 1/ACCELERATION_TICKS_PER_SECOND if shorter,
+// which should be well below the resonance period.
+// NOTE: Not compatible with USE_FIXED_POINT_MOTION or ENABLE_S_CURVE_ACCELERATION. Adds a few float
+// computations to each ramp segment. Replanning costs two square roots for every block on the deceleration
+// ramp. On the host simulator (sim -p), a program of 3000 short segments plans in 1.8us per block with
+// 80 blocks and 1.6us with 36, against 0.26us with the trapezoidal ramps.
+// #define ENABLE_INPUT_SHAPING // Default disabled. Uncomment to enable.
+
 // Sets the maximum step rate allowed to be written as a Grbl setting. This option enables an error
 // check in the settings module to prevent settings values that will exceed this limitation. The maximum
 // step rate is strictly limited by the CPU speed and will change if something other than an AVR running
@@ -526,6 +622,16 @@
 // greater than zero. This option does that.
 // #define SPINDLE_ENABLE_OFF_WITH_ZERO_SPEED // Default disabled. Uncomment to enable.
 
+// By default, every spindle, coolant, and M62/M63 digital output change in a g-code program waits for
+// the planner buffer to empty, so the machine decelerates to a stop before the output changes. With
+// this option, these changes are carried by the next planner block instead, and the stepper ISR sets
+// them just before that block starts stepping, without stopping the motion. Only starting or reversing
+// a spindle, which must spin up before cutting, still waits for the motion to complete. Laser mode
+// carries all spindle changes. Changes with no following motion are set when the cycle completes.
+// NOTE: Spindle speed overrides, coolant override toggles, and M64/M65 still act immediately.
+// #define ENABLE_INLINE_OUTPUT_CHANGES // Default disabled. Uncomment to enable.
+#define INLINE_SPINDLE_SPIN_UP_DELAY 0.0 // Float (seconds). Dwell after a spindle start or reversal.
+
 // With this enabled, Grbl sends back an echo of the line it has received, which has been pre-parsed (spaces
 // removed, capitalized letters, no comments) and is to be immediately executed by Grbl. Echoes will not be
 // sent upon a line buffer overflow, but should for all normal lines sent to Grbl. For example, if a user
@@ -555,6 +661,29 @@
 // bogged down by too many trig calculations.
 #define N_ARC_CORRECTION 12 // Integer (1-255)
 
+// Adapts the number of arc line segments to the arc speed, and not only to the arc tolerance ($12).
+// Each segment is made to last at least ARC_ADAPTIVE_SEGMENT_TIME at the speed the arc can reach,
+// i.e. the programmed feed rate, limited to the centripetal speed sqrt(acceleration*radius). The
+// minimum time is scaled by the current planner buffer fill, so an arc starting from an empty buffer
+// keeps the full resolution, while streams of arcs no longer fill the planner with tiny segments that
+// each take less time than it takes to plan them. The segment deviation is allowed to grow up to
+// ARC_ADAPTIVE_MAX_TOLERANCE times the arc tolerance, never more.
+// NOTE: Has no effect with ENABLE_NATIVE_ARCS, which does not put arc segments in the planner.
+// #define ENABLE_ADAPTIVE_ARC_SEGMENTS // Default disabled. Uncomment to enable.
+#define ARC_ADAPTIVE_SEGMENT_TIME 10.0 // (ms) Float, minimum segment time at a full planner buffer.
+#define ARC_ADAPTIVE_MAX_TOLERANCE 4.0 // Float (>=1.0), maximum multiple of the arc tolerance.
+
+// Computes the sine and cosine of the arc generator, and of the other trig callers, from a 65-entry
+// quarter-wave table in flash instead of the avr-libc sin() and cos() routines. The angle is reduced
+// to the nearest table angle, and the remainder of at most pi/256 rad is applied with the angle sum
+// identities and short series. A sine and cosine pair then costs 11 float multiplies, 6 float adds,
+// one lround() and one int to float conversion, in place of two full libm evaluations, and stays within
+// a few float ulp of libm. From the avr-libc float routine costs, that is an estimated 2,500 CPU cycles
+// (~160us at 16MHz) per pair, against about 3,500 for sin() and cos(). This makes the arc correction
+// cheap enough to lower N_ARC_CORRECTION for tight tolerance contouring.
+// NOTE: The table takes 260 bytes of flash.
+// #define USE_TRIG_LOOKUP_TABLE // Default disabled. Uncomment to enable.
+
 // The arc G2/3 g-code standard is problematic by definition. Radius-based arcs have horrible numerical
 // errors when arc at semi-circles(pi) or full-circles(2*pi). Offset-based arcs are much more accurate
 // but still have a problem when arcs are full-circles (2*pi). This define accounts for the floating
@@ -565,6 +694,31 @@
 // much greater than this. The default setting should capture most, if not all, full arc error situations.
 #define ARC_ANGULAR_TRAVEL_EPSILON 5E-7 // Float (radians)
 
+// Sets the most line segments a G5/G5.1 spline is split into. The segments are made as long as the
+// $12 arc tolerance allows, but no shorter than this many per spline, which also bounds the time taken
+// by a zero or tiny arc tolerance. Splines bent tighter than that get a larger chord error.
+#define SPLINE_SEGMENTS_MAX 1000
+
+// Plans each G2/G3 arc as a single planner block, instead of chopping it into many short line motions.
+// The step segment generator traces the arc chords itself, as it executes the block, with the same
+// chord count as set by the $12 arc tolerance. This keeps the planner look-ahead free for the motions
+// after the arc, skips a full planner pass per chord and runs the arc at the programmed feed rate,
+// limited by the centripetal acceleration of its radius and the junction speed of its chords. Long
+// arcs are still split, when their step counts exceed the planner block limit.
+// NOTE: Not compatible with USE_FIXED_POINT_MOTION, ENABLE_S_CURVE_ACCELERATION, ENABLE_INPUT_SHAPING or
+// COREXY. Adds 16 bytes of RAM to each planner block. Lower BLOCK_BUFFER_SIZE if RAM gets short.
+// #define ENABLE_NATIVE_ARCS // Default disabled. Uncomment to enable.
+
+// Enables G64 P<tolerance> path blending, which merges consecutive feed motions into a single line
+// motion, as long as every end point it skips stays within the tolerance of the merged line. Curves
+// exported by CAM as many tiny facets then run without slowing down at each junction. G61 remains the
+// default mode. When disabled, G64 is rejected as an unsupported command, as in stock Grbl.
+// #define ENABLE_PATH_BLENDING // Default disabled. Uncomment to enable.
+
+// Sets the maximum number of end points G64 path blending merges into one line motion. Each one
+// costs N_AXIS floats of RAM. Only used when ENABLE_PATH_BLENDING is enabled.
+#define PATH_BLENDING_MAX_POINTS 8 // Integer (2-255)
+
 // Time delay increments performed during a dwell. The default value is set at 50ms, which provides
 // a maximum time delay of roughly 55 minutes, more than enough for most any application. Increasing
 // this delay will increase the maximum dwell time linearly, but also reduces the responsiveness of
@@ -583,12 +737,36 @@
 // values for certain setups have ranged from 5 to 20us.
 // #define STEP_PULSE_DELAY 10 // Step pulse delay in microseconds. Default disabled.
 
+// Generates the step pulses in hardware, with the Timer5 one-shot output compare units, for the
+// axes whose step pin is a Timer5 output compare pin, as defined by STEP_OC5A_AXIS, STEP_OC5B_AXIS
+// and STEP_OC5C_AXIS in cpu_map.h. The stepper interrupt starts Timer5 counting, and the timer
+// raises and then drops these pins on its own, without the Timer0 step pulse reset interrupt.
+// When every step pin is on an output compare pin, the reset interrupt is not used at all, which
+// halves the interrupt load at high step rates and the jitter it adds to the serial interrupt.
+// The other axes keep ending their pulses in the reset interrupt. Works with STEP_PULSE_DELAY.
+// NOTE: Timer5 is then reserved for the step pulses and can't be used with STEPPER_ISR_PROFILER.
+// #define STEP_PULSE_OUTPUT_COMPARE // Default disabled. Uncomment to enable.
+
 // The number of linear motions in the planner buffer to be planned at any give time. The vast
 // majority of RAM that Grbl uses is based on this buffer size. Only increase if there is extra
 // available RAM, like when re-compiling for a Mega or Sanguino. Or decrease if the Arduino
 // begins to crash due to the lack of available RAM or if the CPU is having trouble keeping
 // up with planning new incoming motions as they are executed.
-// #define BLOCK_BUFFER_SIZE 36  // Uncomment to override default in planner.h.
+// NOTE: Blocks are packed to 51 bytes with 6 axes, ramp index included. The default of 80 leaves about
+// 2KB of the Mega's 8KB for the stack, which peaks around 1.3KB while parsing an arc. Options that add
+// RAM, like ENABLE_PATH_BLENDING, CACHE_COORD_DATA_IN_RAM or ENABLE_NATIVE_ARCS, come out of that
+// headroom. Lower this by a block per 51 bytes they take. Motions over 65535 steps on an axis are split
+// into several blocks.
+// #define BLOCK_BUFFER_SIZE 80  // Uncomment to override default in planner.h.
+
+// Queues parsed line motions ahead of the planner, once its buffer is full, instead of waiting
+// inside the g-code parser for a block to free up. The 'ok' goes out at once and the following lines
+// are received, parsed, and unit converted meanwhile, until the queue also fills. When a planner
+// block completes, the main loop only has to plan the next queued motion. Motions are still
+// planned in program order, and a buffer sync plans all queued motions first.
+// NOTE: Each queued motion costs N_AXIS floats and a planner data struct of RAM, about 40 bytes.
+// #define ENABLE_PARSE_AHEAD_QUEUE // Default disabled. Uncomment to enable.
+#define PARSE_AHEAD_QUEUE_SIZE 8 // Integer (2-255). Number of queued line motions.
 
 // Governs the size of the intermediary step segment buffer between the step execution algorithm
 // and the planner blocks. Each segment is set of steps executed at a constant velocity over a
@@ -686,6 +864,22 @@
 // job. At this time, this option only forces a planner buffer sync with these g-code commands.
 #define FORCE_BUFFER_SYNC_DURING_EEPROM_WRITE // Default enabled. Comment to disable.
 
+// Keeps a copy of the G54-G59, G28, and G30 coordinate data in RAM. It is loaded from EEPROM at startup
+// and updated with every write, so coordinate system changes, G28/G30, and `$#` reports never read the
+// EEPROM, which is slow, byte by byte with a checksum. Costs (N_COORDINATE_SYSTEM+2)*N_AXIS*4 bytes of RAM.
+// #define CACHE_COORD_DATA_IN_RAM // Default disabled. Uncomment to enable.
+
+// Queues EEPROM writes in RAM and programs them one byte at a time from the EEPROM ready interrupt,
+// instead of disabling interrupts and waiting about 3.4ms for every byte written. Settings, startup
+// line, and G10/G28.1/G30.1 writes then return at once, and stepping and serial receive continue
+// while the EEPROM is programmed in the background. Reads return queued data that is not programmed
+// yet. With this enabled, FORCE_BUFFER_SYNC_DURING_EEPROM_WRITE no longer syncs the planner buffer,
+// since the write no longer blocks the stepper interrupt. A write only waits when the queue is full.
+// NOTE: A setting is stored a few milliseconds per changed byte after its 'ok'. `$RST=` commands wait
+// for all writes to complete. Costs EEPROM_WRITE_QUEUE_SIZE*3 bytes of RAM (255 entries max).
+// #define USE_EEPROM_WRITE_QUEUE // Default disabled. Uncomment to enable.
+#define EEPROM_WRITE_QUEUE_SIZE 64 // Number of queued byte writes.
+
 // In Grbl v0.9 and prior, there is an old outstanding bug where the `WPos:` work position reported
 // may not correlate to what is executing, because `WPos:` is based on the g-code parser state, which
 // can be several motions behind. This option forces the planner buffer to empty, sync, and stop
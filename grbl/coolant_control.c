@@ -56,6 +56,10 @@ uint8_t coolant_get_state()
 // an interrupt-level. No report flag set, but only called by routines that don't need it.
 void coolant_stop()
 {
+  #ifdef ENABLE_INLINE_OUTPUT_CHANGES
+    uint8_t sreg = SREG; // The stepper ISR writes these ports too. Keep read-modify-writes atomic.
+    cli();
+  #endif
   #ifdef INVERT_COOLANT_FLOOD_PIN
     COOLANT_FLOOD_PORT |= (1 << COOLANT_FLOOD_BIT);
   #else
@@ -66,6 +70,9 @@ void coolant_stop()
   #else
     COOLANT_MIST_PORT &= ~(1 << COOLANT_MIST_BIT);
   #endif
+  #ifdef ENABLE_INLINE_OUTPUT_CHANGES
+    SREG = sreg;
+  #endif
 }
 
 
@@ -77,6 +84,10 @@ void coolant_set_state(uint8_t mode)
 {
   if (sys.abort) { return; } // Block during abort.  
   
+  #ifdef ENABLE_INLINE_OUTPUT_CHANGES
+    uint8_t sreg = SREG;
+    cli();
+  #endif
   if (mode & COOLANT_FLOOD_ENABLE) {
     #ifdef INVERT_COOLANT_FLOOD_PIN
       COOLANT_FLOOD_PORT &= ~(1 << COOLANT_FLOOD_BIT);
@@ -104,6 +115,9 @@ void coolant_set_state(uint8_t mode)
       COOLANT_MIST_PORT &= ~(1 << COOLANT_MIST_BIT);
     #endif
   }
+  #ifdef ENABLE_INLINE_OUTPUT_CHANGES
+    SREG = sreg;
+  #endif
   
   sys.report_ovr_counter = 0; // Set to report change immediately
 }
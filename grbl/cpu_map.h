@@ -74,6 +74,10 @@
   #define STEP_PORT(i) _STEP_PORT(i)
   #define STEP_PIN(i) _PIN(STEP_PORT_##i)
 
+  // Step pins on the Timer5 output compare pins OC5A (D46), OC5B (D45) and OC5C (D44), which
+  // STEP_PULSE_OUTPUT_COMPARE pulses in hardware. Define the axis index of each one in use.
+  #define STEP_OC5A_AXIS 2 // Z Step - Pin D46
+
   // Define step direction output pins.
   #define DIRECTION_PORT_0 F
   #define DIRECTION_PORT_1 F
@@ -304,11 +308,15 @@
   // TIMER0 (controls pin D13,  D4);      => Timer0 is used by stepper.c
   // TIMER1 (controls pin D12, D11);      => Timer1 is used by stepper.c
   // TIMER2 (controls pin D10,  D9);      => Timer2 is used by analog output or spindle PWM on D9
-  // TIMER3 (controls pin  D5,  D3,  D2); => Timer3 is used by sleep.c
+  // TIMER3 (controls pin  D5,  D3,  D2); => Timer3 is used by sleep.c, and times the stepper idle lock
+  //                                         with the OCR3B compare (TIMER3_COMPB_vect in stepper.c).
+  //                                         Don't reconfigure Timer3, nor use OC3B (D2/PE4) as PWM.
   // TIMER4 (controls pin  D8,  D7,  D6); => Timer4 is used by analog output or spindle PWM on D8 or D6
   // TIMER5 (controls pin D46, D45, D44); => Timer5 is unused by grbl-Mega-5X. It's possible to add 
   //                                         PWM capability to ports D44 (RAMPS AUX-2), D45 (RAMPS AUX-4). 
   //                                         D46 is not available for PWM because it's used by Z step.
+  //                                         STEPPER_ISR_PROFILER runs it as a free counter, outputs off.
+  //                                         STEP_PULSE_OUTPUT_COMPARE generates the D46 Z step pulses with it.
   // Arduino pin number and the corresponding register for controlling the duty cycle :
   // Pin  Register
   //   2  OCR3B
@@ -895,11 +903,14 @@
 // TIMER0 (controls pin D13,  D4);      => Timer0 is used by stepper.c
 // TIMER1 (controls pin D12, D11);      => Timer1 is used by stepper.c
 // TIMER2 (controls pin D10,  D9);      => Timer2 is used by analog output or spindle PWM on D9
-// TIMER3 (controls pin  D5,  D3,  D2); => Timer3 is used by sleep.c
+// TIMER3 (controls pin  D5,  D3,  D2); => Timer3 is used by sleep.c, and times the stepper idle lock
+//                                         with the OCR3B compare (TIMER3_COMPB_vect in stepper.c).
+//                                         Don't reconfigure Timer3, nor use OC3B (D2/PE4) as PWM.
 // TIMER4 (controls pin  D8,  D7,  D6); => Timer4 is used by analog output or spindle PWM on D8, D7 or D6
 // TIMER5 (controls pin D46, D45, D44); => Timer5 is unused by grbl-Mega-5X. It's possible to add 
 //                                         PWM capability to ports D44 (RAMPS AUX-2), D45 (RAMPS AUX-4). 
 //                                         D46 is not available for PWM because it's used by Z step.
+//                                         STEPPER_ISR_PROFILER runs it as a free counter, outputs off.
 // Arduino pin number and the corresponding register for controlling the duty cycle :
 // Pin  Register
 //   2  OCR3B
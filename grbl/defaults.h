@@ -340,5 +340,25 @@
 #define DEFAULT_HOMING_PULLOFF 3.0 // mm
 #endif 
 
+// Serial baud rate setting, common to all machines.
+#ifndef DEFAULT_BAUD_RATE
+  #define DEFAULT_BAUD_RATE BAUD_RATE // baud
+#endif
+
+// Axis jerk setting, common to all machines and axes. Only used by ENABLE_S_CURVE_ACCELERATION.
+#ifndef DEFAULT_AXIS_JERK
+  #define DEFAULT_AXIS_JERK (1000.0*60*60*60) // 1000*60*60*60 mm/min^3 = 1000 mm/sec^3
+#endif
+
+// Input shaper settings, common to all machines. Only used by ENABLE_INPUT_SHAPING.
+#ifndef DEFAULT_INPUT_SHAPER_TYPE
+  #define DEFAULT_INPUT_SHAPER_TYPE 1 // ZV
+#endif
+#ifndef DEFAULT_INPUT_SHAPER_FREQUENCY
+  #define DEFAULT_INPUT_SHAPER_FREQUENCY 40.0 // Hz
+#endif
+#ifndef DEFAULT_INPUT_SHAPER_DAMPING
+  #define DEFAULT_INPUT_SHAPER_DAMPING 0.1 // Ratio
+#endif
 
 #endif
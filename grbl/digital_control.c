@@ -128,6 +128,10 @@ uint8_t digital_get_state()
 void digital_stop(const uint8_t mode)
 {
 #ifdef   DIGITAL_OUTPUT_PORT_0
+  #ifdef ENABLE_INLINE_OUTPUT_CHANGES
+    uint8_t sreg = SREG; // The stepper ISR writes these ports too. Keep read-modify-writes atomic.
+    cli();
+  #endif
   if (mode & DIGITAL_OUTPUT_STATE_P0) {
     #ifdef INVERT_DIGITAL_OUTPUT_PIN_0
       DIGITAL_OUTPUT_PORT_0 |= (1 << DIGITAL_OUTPUT_BIT_0);
@@ -156,6 +160,9 @@ void digital_stop(const uint8_t mode)
       DIGITAL_OUTPUT_PORT_3 &= ~(1 << DIGITAL_OUTPUT_BIT_3);
     #endif
   }
+  #ifdef ENABLE_INLINE_OUTPUT_CHANGES
+    SREG = sreg;
+  #endif
 #endif
 }
 
@@ -167,6 +174,10 @@ void digital_set_state(uint8_t mode)
 #ifdef   DIGITAL_OUTPUT_PORT_0
   if (sys.abort) { return; } // Block during abort.  
   
+  #ifdef ENABLE_INLINE_OUTPUT_CHANGES
+    uint8_t sreg = SREG;
+    cli();
+  #endif
   if (mode & DIGITAL_OUTPUT_STATE_P0) {
     #ifdef INVERT_DIGITAL_OUTPUT_PIN_0
       DIGITAL_OUTPUT_PORT_0 &= ~(1 << DIGITAL_OUTPUT_BIT_0);
@@ -219,6 +230,9 @@ void digital_set_state(uint8_t mode)
       DIGITAL_OUTPUT_PORT_3 &= ~(1 << DIGITAL_OUTPUT_BIT_3);
     #endif
   }
+  #ifdef ENABLE_INLINE_OUTPUT_CHANGES
+    SREG = sreg;
+  #endif
   sys.report_ovr_counter = 0; // Set to report change immediately
 #endif
 }
@@ -23,6 +23,7 @@
 ****************************************************************************/
 #include <avr/io.h>
 #include <avr/interrupt.h>
+#include "grbl.h"
 
 /* These EEPROM bits have different names on different devices. */
 #ifndef EEPE
@@ -46,17 +47,47 @@
  *  \param  addr  EEPROM address to read from.
  *  \return  The byte read from the EEPROM address.
  */
+#ifdef USE_EEPROM_WRITE_QUEUE
+	// Pending EEPROM writes, programmed one byte per EE_READY interrupt. The main program queues at
+	// the head and the interrupt only moves the tail, so queued entries stay intact until programmed.
+	static volatile uint16_t eeprom_queue_addr[EEPROM_WRITE_QUEUE_SIZE];
+	static volatile uint8_t eeprom_queue_data[EEPROM_WRITE_QUEUE_SIZE];
+	static volatile uint8_t eeprom_queue_head; // Index of the next write to queue.
+	static volatile uint8_t eeprom_queue_tail; // Index of the next write to program.
+#endif
+
 unsigned char eeprom_get_char( unsigned int addr )
 {
+#ifdef USE_EEPROM_WRITE_QUEUE
+	unsigned char value;
+	// Return the newest queued value of the address, if any, since it is not programmed yet.
+	// NOTE: An entry the interrupt pops during the scan is being programmed with the same value.
+	uint8_t tail = eeprom_queue_tail;
+	uint8_t idx = eeprom_queue_head;
+	while (idx != tail) {
+		if (idx == 0) { idx = EEPROM_WRITE_QUEUE_SIZE; }
+		idx--;
+		if (eeprom_queue_addr[idx] == addr) { return(eeprom_queue_data[idx]); }
+	}
+	// Hold the queue off while the byte in progress completes, without blocking other interrupts.
+	cli(); EECR &= ~(1<<EERIE); sei();
+	do {} while( EECR & (1<<EEPE) ); // Wait for completion of previous write.
+	EEAR = addr; // Set EEPROM address register.
+	EECR = (1<<EERE); // Start EEPROM read operation.
+	value = EEDR;
+	if (eeprom_queue_head != eeprom_queue_tail) { EECR |= (1<<EERIE); } // Resume programming.
+	return(value);
+#else
 	do {} while( EECR & (1<<EEPE) ); // Wait for completion of previous write.
 	EEAR = addr; // Set EEPROM address register.
 	EECR = (1<<EERE); // Start EEPROM read operation.
 	return EEDR; // Return the byte read from EEPROM.
+#endif
 }
 
-/*! \brief  Write byte to EEPROM.
+/*! \brief  Program byte into EEPROM.
  *
- *  This function writes one byte to a given EEPROM address.
+ *  This function programs one byte at a given EEPROM address.
  *  The differences between the existing byte and the new value is used
  *  to select the most efficient EEPROM programming mode.
  *
@@ -68,23 +99,19 @@ unsigned char eeprom_get_char( unsigned int addr )
  *
  *  \note  The EEPROM_GetChar() function checks the EEPE bit automatically.
  *
+ *  \note  The caller must wait for EEPE to clear and keep interrupts disabled.
+ *
  *  \param  addr  EEPROM address to write to.
  *  \param  new_value  New EEPROM value.
+ *  \param  eecr_ie  EERIE bit to keep set in EECR, while programming.
  */
-void eeprom_put_char( unsigned int addr, unsigned char new_value )
+static void eeprom_program_char( unsigned int addr, unsigned char new_value, unsigned char eecr_ie )
 {
 	char old_value; // Old EEPROM value.
 	char diff_mask; // Difference mask, i.e. old value XOR new value.
 
-	cli(); // Ensure atomic operation for the write operation.
-	
-	do {} while( EECR & (1<<EEPE) ); // Wait for completion of previous write.
-	#ifndef EEPROM_IGNORE_SELFPROG
-	do {} while( SPMCSR & (1<<SELFPRGEN) ); // Wait for completion of SPM.
-	#endif
-	
 	EEAR = addr; // Set EEPROM address register.
-	EECR = (1<<EERE); // Start EEPROM read operation.
+	EECR = eecr_ie | (1<<EERE); // Start EEPROM read operation.
 	old_value = EEDR; // Get old EEPROM value.
 	diff_mask = old_value ^ new_value; // Get bit differences.
 	
@@ -97,13 +124,13 @@ void eeprom_put_char( unsigned int addr, unsigned char new_value )
 			// Now we know that some bits need to be programmed to '0' also.
 			
 			EEDR = new_value; // Set EEPROM data register.
-			EECR = (1<<EEMPE) | // Set Master Write Enable bit...
+			EECR = eecr_ie | (1<<EEMPE) | // Set Master Write Enable bit...
 			       (0<<EEPM1) | (0<<EEPM0); // ...and Erase+Write mode.
 			EECR |= (1<<EEPE);  // Start Erase+Write operation.
 		} else {
 			// Now we know that all bits should be erased.
 
-			EECR = (1<<EEMPE) | // Set Master Write Enable bit...
+			EECR = eecr_ie | (1<<EEMPE) | // Set Master Write Enable bit...
 			       (1<<EEPM0);  // ...and Erase-only mode.
 			EECR |= (1<<EEPE);  // Start Erase-only operation.
 		}
@@ -115,13 +142,66 @@ void eeprom_put_char( unsigned int addr, unsigned char new_value )
 			// Now we know that _some_ bits need to the programmed to '0'.
 			
 			EEDR = new_value;   // Set EEPROM data register.
-			EECR = (1<<EEMPE) | // Set Master Write Enable bit...
+			EECR = eecr_ie | (1<<EEMPE) | // Set Master Write Enable bit...
 			       (1<<EEPM1);  // ...and Write-only mode.
 			EECR |= (1<<EEPE);  // Start Write-only operation.
 		}
 	}
+}
+
+
+// Writes one byte to a given EEPROM address. With USE_EEPROM_WRITE_QUEUE, the write is queued and
+// programmed by the EE_READY interrupt. It only waits when the queue is full.
+void eeprom_put_char( unsigned int addr, unsigned char new_value )
+{
+#ifdef USE_EEPROM_WRITE_QUEUE
+	uint8_t head = eeprom_queue_head;
+	uint8_t next_head = head+1;
+	if (next_head == EEPROM_WRITE_QUEUE_SIZE) { next_head = 0; }
+	do {} while( next_head == eeprom_queue_tail ); // Queue full. Wait for the oldest write to program.
+	eeprom_queue_addr[head] = addr;
+	eeprom_queue_data[head] = new_value;
+	eeprom_queue_head = next_head;
+	cli(); EECR |= (1<<EERIE); sei(); // Start or continue programming from the EE_READY interrupt.
+#else
+	cli(); // Ensure atomic operation for the write operation.
+	
+	do {} while( EECR & (1<<EEPE) ); // Wait for completion of previous write.
+	#ifndef EEPROM_IGNORE_SELFPROG
+	do {} while( SPMCSR & (1<<SELFPRGEN) ); // Wait for completion of SPM.
+	#endif
+	
+	eeprom_program_char(addr, new_value, 0);
 	
 	sei(); // Restore interrupt flag state.
+#endif
+}
+
+
+#ifdef USE_EEPROM_WRITE_QUEUE
+	// Fires whenever the EEPROM is ready, while enabled. Programs the oldest queued write, if any.
+	// Writes that leave a byte unchanged start no programming, so the interrupt fires again at once.
+	ISR(EE_READY_vect)
+	{
+		uint8_t tail = eeprom_queue_tail;
+		if (tail == eeprom_queue_head) {
+			EECR &= ~(1<<EERIE); // Queue empty. Disable until the next write.
+			return;
+		}
+		eeprom_program_char(eeprom_queue_addr[tail], eeprom_queue_data[tail], (1<<EERIE));
+		if (++tail == EEPROM_WRITE_QUEUE_SIZE) { tail = 0; }
+		eeprom_queue_tail = tail;
+	}
+#endif
+
+
+// Waits until all queued writes are programmed into the EEPROM.
+void eeprom_flush()
+{
+#ifdef USE_EEPROM_WRITE_QUEUE
+	do {} while( eeprom_queue_head != eeprom_queue_tail );
+#endif
+	do {} while( EECR & (1<<EEPE) ); // Wait for completion of the last write.
 }
 
 // Extensions added as part of Grbl 
@@ -60,12 +60,44 @@ void gc_sync_position()
 }
 
 
-// Executes one line of 0-terminated G-Code. The line is assumed to contain only uppercase
-// characters and signed floating point values (no whitespace). Comments and block delete
-// characters have been removed. In this function, all units and positions are converted and
-// exported to grbl's internal functions in terms of (mm, mm/min) and absolute machine
-// coordinates, respectively.
-uint8_t gc_execute_line(char *line)
+#ifdef ENABLE_INLINE_OUTPUT_CHANGES
+  // Returns true and marks an output change pending, when planner motion is queued or executing. The
+  // next planner block then carries the change to the stepper ISR, which sets it when the block starts.
+  // Otherwise, the caller sets the change right away, since a buffer sync would not wait for anything.
+  // NOTE: A line motion held back by path blending is planned first, so the change follows it.
+  static uint8_t gc_defer_output(uint8_t output)
+  {
+    #ifdef ENABLE_PATH_BLENDING
+      mc_flush_blending();
+    #endif
+    if (plan_get_current_block() || (sys.state == STATE_CYCLE)) {
+      gc_state.output_pending |= output;
+      return(true);
+    }
+    return(false);
+  }
+
+
+  // Sets the output changes left pending by the parser, when no planner block followed to carry them.
+  // Called by the main program when a cycle completes.
+  void gc_sync_outputs()
+  {
+    if (gc_state.output_pending & GC_OUTPUT_PENDING_SPINDLE) {
+      spindle_set_state(gc_state.modal.spindle, gc_state.pending_spindle_speed);
+    }
+    if (gc_state.output_pending & GC_OUTPUT_PENDING_COOLANT) { coolant_set_state(gc_state.modal.coolant); }
+    if (gc_state.output_pending & GC_OUTPUT_PENDING_DIGITAL) { digital_set_state(gc_state.digital_state); }
+    gc_state.output_pending = 0;
+  }
+#endif
+
+
+// Executes one block of G-Code, either a 0-terminated line or, with a non-zero length, a
+// tokenized block from a binary frame or a received line. A line is assumed to contain only uppercase characters
+// and signed floating point values (no whitespace). Comments and block delete characters have
+// been removed. In this function, all units and positions are converted and exported to grbl's
+// internal functions in terms of (mm, mm/min) and absolute machine coordinates, respectively.
+static uint8_t gc_execute(char *line, uint8_t length)
 {
   /* -------------------------------------------------------------------------------------
      STEP 1: Initialize parser block struct and copy current g-code state modes. The parser
@@ -107,9 +139,10 @@ uint8_t gc_execute_line(char *line)
   uint32_t command_dwords = 0; // Tracks G and M command words. Also used for modal group violations.
   uint32_t value_dwords = 0;   // Tracks value words.
   uint8_t gc_parser_flags = GC_PARSER_NONE;
+  uint8_t is_negative_pq = false; // P or Q word is negative. Only valid for G5.
 
   // Determine if the line is a jogging motion or a normal g-code block.
-  if (line[0] == '$') { // NOTE: `$J=` already parsed when passed to this function.
+  if ((length == 0) && (line[0] == '$')) { // NOTE: `$J=` already parsed when passed to this function.
     // Set G1 and G94 enforced modes to ensure accurate error checks.
     gc_parser_flags |= GC_PARSER_JOG_MOTION;
     gc_block.modal.motion = MOTION_MODE_LINEAR;
@@ -132,13 +165,35 @@ uint8_t gc_execute_line(char *line)
   if (gc_parser_flags & GC_PARSER_JOG_MOTION) { char_counter = 3; } // Start parsing after `$J=`
   else { char_counter = 0; }
 
-  while (line[char_counter] != 0) { // Loop until no more g-code words in line.
+  while (length ? (char_counter < length) : (line[char_counter] != 0)) { // Loop until no more g-code words in line.
 
     // Import the next g-code word, expecting a letter followed by a value. Otherwise, error out.
-    letter = line[char_counter];
-    if((letter < 'A') || (letter > 'Z')) { FAIL(STATUS_EXPECTED_COMMAND_LETTER); } // [Expected word letter]
-    char_counter++;
-    if (!read_float(line, &char_counter, &value)) { FAIL(STATUS_BAD_NUMBER_FORMAT); } // [Expected word value]
+    letter = line[char_counter++];
+    #if defined(ENABLE_BINARY_PROTOCOL) || defined(TOKENIZE_GCODE_ON_RECEIVE)
+    if (length) {
+      // Tokenized word. An uppercase letter is followed by a float value, a lowercase letter by a
+      // 16-bit signed value in thousandths, for short exact words like G and M commands. Both are
+      // little-endian, as is the AVR.
+      if ((letter >= 'a') && (letter <= 'z')) {
+        if (char_counter+2 > length) { FAIL(STATUS_BAD_NUMBER_FORMAT); } // [Expected word value]
+        int16_t fixed = (uint8_t)line[char_counter] | ((uint16_t)(uint8_t)line[char_counter+1] << 8);
+        value = fixed/1000.0;
+        char_counter += 2;
+        letter -= 'a'-'A';
+      } else {
+        if (letter == GC_TOKEN_BAD_NUMBER) { FAIL(STATUS_BAD_NUMBER_FORMAT); } // [Expected word value]
+        if((letter < 'A') || (letter > 'Z')) { FAIL(STATUS_EXPECTED_COMMAND_LETTER); } // [Expected word letter]
+        if (char_counter+4 > length) { FAIL(STATUS_BAD_NUMBER_FORMAT); } // [Expected word value]
+        memcpy(&value, line+char_counter, sizeof(float));
+        if (isnan(value) || isinf(value)) { FAIL(STATUS_BAD_NUMBER_FORMAT); } // [Value not a number]
+        char_counter += 4;
+      }
+    } else
+    #endif
+    {
+      if((letter < 'A') || (letter > 'Z')) { FAIL(STATUS_EXPECTED_COMMAND_LETTER); } // [Expected word letter]
+      if (!read_float(line, &char_counter, &value)) { FAIL(STATUS_BAD_NUMBER_FORMAT); } // [Expected word value]
+    }
 
     // Convert values to smaller uint8 significand and mantissa values for parsing this word.
     // NOTE: Mantissa is multiplied by 100 to catch non-integer command values. This is more
@@ -178,8 +233,8 @@ uint8_t gc_execute_line(char *line)
               mantissa = 0; // Set to zero to indicate valid non-integer G command.
             }
             break;
-          case 0: case 1: case 2: case 3: case 38:
-            // Check for G0/1/2/3/38 being called with G10/28/30/92 on same block.
+          case 0: case 1: case 2: case 3: case 5: case 38:
+            // Check for G0/1/2/3/5/38 being called with G10/28/30/92 on same block.
             // * G43.1 is also an axis command but is not explicitly defined this way.
             if (axis_command) { FAIL(STATUS_GCODE_AXIS_COMMAND_CONFLICT); } // [Axis word/command conflict]
             axis_command = AXIS_COMMAND_MOTION_MODE;
@@ -193,6 +248,10 @@ uint8_t gc_execute_line(char *line)
               }
               gc_block.modal.motion += (mantissa/10)+100;
               mantissa = 0; // Set to zero to indicate valid non-integer G command.
+            } else if (int_value == 5) {
+              if (!((mantissa == 0) || (mantissa == 10))) { FAIL(STATUS_GCODE_UNSUPPORTED_COMMAND); } // [Unsupported G5.x command]
+              gc_block.modal.motion += mantissa;
+              mantissa = 0; // Set to zero to indicate valid non-integer G command.
             }
             break;
           case 17: case 18: case 19:
@@ -243,11 +302,20 @@ uint8_t gc_execute_line(char *line)
             dword_bit = MODAL_GROUP_G12;
             gc_block.modal.coord_select = int_value - 54; // Shift to array indexing.
             break;
-          case 61:
-            dword_bit = MODAL_GROUP_G13;
-            if (mantissa != 0) { FAIL(STATUS_GCODE_UNSUPPORTED_COMMAND); } // [G61.1 not supported]
-            // gc_block.modal.control = CONTROL_MODE_EXACT_PATH; // G61
-            break;
+          #ifdef ENABLE_PATH_BLENDING
+            case 61: case 64:
+              dword_bit = MODAL_GROUP_G13;
+              if (mantissa != 0) { FAIL(STATUS_GCODE_UNSUPPORTED_COMMAND); } // [G61.1 not supported]
+              if (int_value == 61) { gc_block.modal.control = CONTROL_MODE_EXACT_PATH; } // G61
+              else { gc_block.modal.control = CONTROL_MODE_CONTINUOUS; } // G64
+              break;
+          #else
+            case 61:
+              dword_bit = MODAL_GROUP_G13;
+              if (mantissa != 0) { FAIL(STATUS_GCODE_UNSUPPORTED_COMMAND); } // [G61.1 not supported]
+              // gc_block.modal.control = CONTROL_MODE_EXACT_PATH; // G61
+              break;
+          #endif
           default: FAIL(STATUS_GCODE_UNSUPPORTED_COMMAND); // [Unsupported G command]
         }
         if (mantissa > 0) { FAIL(STATUS_GCODE_COMMAND_VALUE_NOT_INTEGER); } // [Unsupported or invalid Gxx.x command]
@@ -383,9 +451,7 @@ uint8_t gc_execute_line(char *line)
               gc_block.values.p = value;
             }
             break;
-          #ifdef USE_OUTPUT_PWM
-            case 'Q': dword_bit = DWORD_Q; gc_block.values.q = value; break;
-          #endif
+          case 'Q': dword_bit = DWORD_Q; gc_block.values.q = value; break;
           case 'R': dword_bit = DWORD_R; gc_block.values.r = value; break;
           case 'S': dword_bit = DWORD_S; gc_block.values.s = value; break;
           case 'T': dword_bit = DWORD_T;
@@ -440,12 +506,12 @@ uint8_t gc_execute_line(char *line)
         if (bit_istrue(value_dwords,dwbit(dword_bit))) { FAIL(STATUS_GCODE_WORD_REPEATED); } // [Word repeated]
         // Check for invalid negative values for words F, N, O, P, T, and S.
         // NOTE: Negative value check is done here simply for code-efficiency.
-        #ifdef USE_OUTPUT_PWM
+        // NOTE: P and Q are also signed G5 control point offsets. Checked once the motion mode is known.
         if ( dwbit(dword_bit) & (dwbit(DWORD_F)|dwbit(DWORD_N)|dwbit(DWORD_Q)|dwbit(DWORD_P)|dwbit(DWORD_T)|dwbit(DWORD_S)) ) {
-        #else
-        if ( dwbit(dword_bit) & (dwbit(DWORD_F)|dwbit(DWORD_N)|dwbit(DWORD_P)|dwbit(DWORD_T)|dwbit(DWORD_S)) ) {
-        #endif
-          if (value < 0.0) { FAIL(STATUS_NEGATIVE_VALUE); } // [Word value cannot be negative]
+          if (value < 0.0) {
+            if (dwbit(dword_bit) & (dwbit(DWORD_Q)|dwbit(DWORD_P))) { is_negative_pq = true; }
+            else { FAIL(STATUS_NEGATIVE_VALUE); } // [Word value cannot be negative]
+          }
         }
         value_dwords |= dwbit(dword_bit); // Flag to indicate parameter assigned.
 
@@ -488,6 +554,15 @@ uint8_t gc_execute_line(char *line)
     if (!axis_command) { axis_command = AXIS_COMMAND_MOTION_MODE; } // Assign implicit motion-mode
   }
 
+  // Check the P and Q words outside of G5, where they are the signed control point offsets. Without
+  // USE_OUTPUT_PWM, the Q word is only used by G5 and unsupported elsewhere, as before G5 existed.
+  if ((axis_command != AXIS_COMMAND_MOTION_MODE) || (gc_block.modal.motion != MOTION_MODE_CUBIC_SPLINE)) {
+    #ifndef USE_OUTPUT_PWM
+      if (bit_istrue(value_dwords,dwbit(DWORD_Q))) { FAIL(STATUS_GCODE_UNSUPPORTED_COMMAND); } // [Q word without G5]
+    #endif
+    if (is_negative_pq) { FAIL(STATUS_NEGATIVE_VALUE); } // [Word value cannot be negative]
+  }
+
   // Check for valid line number N value.
   if (bit_istrue(value_dwords,dwbit(DWORD_N))) {
     // Line number value cannot be less than zero (done) or greater than max line number.
@@ -829,7 +904,22 @@ uint8_t gc_execute_line(char *line)
     }
   }
 
-  // [16. Set path control mode ]: N/A. Only G61. G61.1 and G64 NOT SUPPORTED.
+  #ifdef ENABLE_PATH_BLENDING
+    // [16. Set path control mode ]: G61.1 NOT SUPPORTED. G64 P is the optional path blending tolerance.
+    // NOTE: A P word already used by another command in the block, like G4, is not taken as tolerance.
+    float path_tolerance = 0.0;
+    if (bit_istrue(command_dwords,dwbit(MODAL_GROUP_G13))) {
+      if (gc_block.modal.control == CONTROL_MODE_CONTINUOUS) {
+        if (bit_istrue(value_dwords,dwbit(DWORD_P))) {
+          path_tolerance = gc_block.values.p;
+          if (gc_block.modal.units == UNITS_MODE_INCHES) { path_tolerance *= MM_PER_INCH; }
+          bit_false(value_dwords,dwbit(DWORD_P));
+        }
+      }
+    }
+  #else
+    // [16. Set path control mode ]: N/A. Only G61. G61.1 and G64 NOT SUPPORTED.
+  #endif
   // [17. Set distance mode ]: N/A. Only G91.1. G90.1 NOT SUPPORTED.
   // [18. Set retract mode ]: NOT SUPPORTED.
 
@@ -1211,6 +1301,46 @@ uint8_t gc_execute_line(char *line)
             }
           }
           break;
+        case MOTION_MODE_CUBIC_SPLINE: case MOTION_MODE_QUADRATIC_SPLINE:
+          // [G5/G5.1 Errors]: Feed rate undefined. Plane is not G17. No axis words. Axis words not in plane.
+          // [G5 Errors]: P or Q missing. Only one of I or J. I and J missing and previous motion is not a spline.
+          // [G5.1 Errors]: I and J missing.
+          // NOTE: Both are converted to a cubic Bezier, with I,J the offset of its first control point from
+          // the current position and P,Q the offset of its second control point from the target.
+          if (gc_block.modal.plane_select != PLANE_SELECT_XY) { FAIL(STATUS_GCODE_UNSUPPORTED_COMMAND); } // [Not G17]
+          if (!axis_dwords) { FAIL(STATUS_GCODE_NO_AXIS_WORDS); } // [No axis words]
+          if (axis_dwords & ~(axis_0_mask|axis_1_mask)) { FAIL(STATUS_GCODE_AXIS_WORDS_EXIST); } // [Axis words not in plane]
+          bit_false(value_dwords,(dwbit(DWORD_I)|dwbit(DWORD_J)));
+          if (gc_block.modal.units == UNITS_MODE_INCHES) {
+            gc_block.values.ijk[axis_0] *= MM_PER_INCH;
+            gc_block.values.ijk[axis_1] *= MM_PER_INCH;
+            gc_block.values.p *= MM_PER_INCH;
+            gc_block.values.q *= MM_PER_INCH;
+          }
+          if (gc_block.modal.motion == MOTION_MODE_CUBIC_SPLINE) {
+            if (bit_isfalse(value_dwords,dwbit(DWORD_P)) || bit_isfalse(value_dwords,dwbit(DWORD_Q))) {
+              FAIL(STATUS_GCODE_VALUE_WORD_MISSING); // [P or Q word missing]
+            }
+            bit_false(value_dwords,(dwbit(DWORD_P)|dwbit(DWORD_Q)));
+            if (!(ijk_words & (bit(axis_0)|bit(axis_1)))) {
+              // Continue from the previous spline with the same tangent.
+              if ((gc_state.modal.motion != MOTION_MODE_CUBIC_SPLINE) && (gc_state.modal.motion != MOTION_MODE_QUADRATIC_SPLINE)) {
+                FAIL(STATUS_GCODE_VALUE_WORD_MISSING); // [I and J words missing]
+              }
+              gc_block.values.ijk[axis_0] = -gc_state.spline_control[0];
+              gc_block.values.ijk[axis_1] = -gc_state.spline_control[1];
+            } else if ((ijk_words & (bit(axis_0)|bit(axis_1))) != (bit(axis_0)|bit(axis_1))) {
+              FAIL(STATUS_GCODE_VALUE_WORD_MISSING); // [I or J word missing]
+            }
+          } else {
+            if (!(ijk_words & (bit(axis_0)|bit(axis_1)))) { FAIL(STATUS_GCODE_NO_OFFSETS_IN_PLANE); } // [No offsets in plane]
+            // Elevate the quadratic control point Q0+(I,J) to the cubic ones, at 2/3 of the way from each end.
+            gc_block.values.p = (2.0/3.0)*(gc_block.values.ijk[axis_0]-(gc_block.values.xyz[axis_0]-gc_state.position[axis_0]));
+            gc_block.values.q = (2.0/3.0)*(gc_block.values.ijk[axis_1]-(gc_block.values.xyz[axis_1]-gc_state.position[axis_1]));
+            gc_block.values.ijk[axis_0] *= (2.0/3.0);
+            gc_block.values.ijk[axis_1] *= (2.0/3.0);
+          }
+          break;
         case MOTION_MODE_PROBE_TOWARD_NO_ERROR: case MOTION_MODE_PROBE_AWAY_NO_ERROR:
           gc_parser_flags |= GC_PARSER_PROBE_IS_NO_ERROR; // No break intentional.
         case MOTION_MODE_PROBE_TOWARD: case MOTION_MODE_PROBE_AWAY:
@@ -1279,6 +1409,9 @@ uint8_t gc_execute_line(char *line)
     // Initialize planner data to current spindle and coolant modal state.
     pl_data->spindle_speed = gc_state.spindle_speed;
     plan_data.condition = (gc_state.modal.spindle | gc_state.modal.coolant);
+    #ifdef ENABLE_INLINE_OUTPUT_CHANGES
+      pl_data->digital_state = gc_state.digital_state;
+    #endif
     #ifdef USE_OUTPUT_PWM
       // Add output PWM value to planner data
       pl_data->output_volts = gc_state.output_volts;
@@ -1292,7 +1425,8 @@ uint8_t gc_execute_line(char *line)
   // If in laser mode, setup laser power based on current and past parser conditions.
   if (bit_istrue(settings.flags,BITFLAG_LASER_MODE)) {
     if ( !((gc_block.modal.motion == MOTION_MODE_LINEAR) || (gc_block.modal.motion == MOTION_MODE_CW_ARC)
-        || (gc_block.modal.motion == MOTION_MODE_CCW_ARC)) ) {
+        || (gc_block.modal.motion == MOTION_MODE_CCW_ARC) || (gc_block.modal.motion == MOTION_MODE_CUBIC_SPLINE)
+        || (gc_block.modal.motion == MOTION_MODE_QUADRATIC_SPLINE)) ) {
       gc_parser_flags |= GC_PARSER_LASER_DISABLE;
     }
 
@@ -1306,7 +1440,8 @@ uint8_t gc_execute_line(char *line)
       // a G1/2/3 motion mode state and vice versa when there is no motion in the line.
       if (gc_state.modal.spindle == SPINDLE_ENABLE_CW) {
         if ((gc_state.modal.motion == MOTION_MODE_LINEAR) || (gc_state.modal.motion == MOTION_MODE_CW_ARC)
-            || (gc_state.modal.motion == MOTION_MODE_CCW_ARC)) {
+            || (gc_state.modal.motion == MOTION_MODE_CCW_ARC) || (gc_state.modal.motion == MOTION_MODE_CUBIC_SPLINE)
+            || (gc_state.modal.motion == MOTION_MODE_QUADRATIC_SPLINE)) {
           if (bit_istrue(gc_parser_flags,GC_PARSER_LASER_DISABLE)) {
             gc_parser_flags |= GC_PARSER_LASER_FORCE_SYNC; // Change from G1/2/3 motion mode.
           }
@@ -1339,11 +1474,20 @@ uint8_t gc_execute_line(char *line)
   if ((gc_state.spindle_speed != gc_block.values.s) || bit_istrue(gc_parser_flags,GC_PARSER_LASER_FORCE_SYNC)) {
     if (gc_state.modal.spindle != SPINDLE_DISABLE) {
       if (bit_isfalse(gc_parser_flags,GC_PARSER_LASER_ISMOTION)) {
-        if (bit_istrue(gc_parser_flags,GC_PARSER_LASER_DISABLE)) {
-           spindle_sync(gc_state.modal.spindle, 0.0);
-        } else {
-          spindle_sync(gc_state.modal.spindle, gc_block.values.s);
-        }
+        #ifdef ENABLE_INLINE_OUTPUT_CHANGES
+          // A new speed does not wait for the queued motion. The next planner block carries it.
+          if (bit_istrue(gc_parser_flags,GC_PARSER_LASER_DISABLE)) { gc_state.pending_spindle_speed = 0.0; }
+          else { gc_state.pending_spindle_speed = gc_block.values.s; }
+          if (!gc_defer_output(GC_OUTPUT_PENDING_SPINDLE)) {
+            spindle_sync(gc_state.modal.spindle, gc_state.pending_spindle_speed);
+          }
+        #else
+          if (bit_istrue(gc_parser_flags,GC_PARSER_LASER_DISABLE)) {
+             spindle_sync(gc_state.modal.spindle, 0.0);
+          } else {
+            spindle_sync(gc_state.modal.spindle, gc_block.values.s);
+          }
+        #endif
       }
     }
     gc_state.spindle_speed = gc_block.values.s; // Update spindle speed state.
@@ -1363,7 +1507,21 @@ uint8_t gc_execute_line(char *line)
     // Update spindle control and apply spindle speed when enabling it in this block.
     // NOTE: All spindle state changes are synced, even in laser mode. Also, pl_data,
     // rather than gc_state, is used to manage laser state for non-laser motions.
-    spindle_sync(gc_block.modal.spindle, pl_data->spindle_speed);
+    #ifdef ENABLE_INLINE_OUTPUT_CHANGES
+      // NOTE: Only a spindle start or reversal waits for the motion and the spindle to spin up. Stops
+      // and all laser state changes are carried by the next planner block.
+      if ((gc_block.modal.spindle != SPINDLE_DISABLE) && bit_isfalse(settings.flags,BITFLAG_LASER_MODE)) {
+        spindle_sync(gc_block.modal.spindle, pl_data->spindle_speed);
+        if ((INLINE_SPINDLE_SPIN_UP_DELAY > 0.0) && (sys.state != STATE_CHECK_MODE)) {
+          delay_sec(INLINE_SPINDLE_SPIN_UP_DELAY, DELAY_MODE_DWELL);
+        }
+      } else {
+        gc_state.pending_spindle_speed = pl_data->spindle_speed;
+        if (!gc_defer_output(GC_OUTPUT_PENDING_SPINDLE)) { spindle_sync(gc_block.modal.spindle, pl_data->spindle_speed); }
+      }
+    #else
+      spindle_sync(gc_block.modal.spindle, pl_data->spindle_speed);
+    #endif
     gc_state.modal.spindle = gc_block.modal.spindle;
   }
   pl_data->condition |= gc_state.modal.spindle; // Set condition flag for planner use.
@@ -1372,10 +1530,17 @@ uint8_t gc_execute_line(char *line)
   if (gc_state.modal.coolant != gc_block.modal.coolant) {
     // NOTE: Coolant M-codes are modal. Only one command per line is allowed. But, multiple states
     // can exist at the same time, while coolant disable clears all states.
-    coolant_sync(gc_block.modal.coolant);
+    #ifdef ENABLE_INLINE_OUTPUT_CHANGES
+      if (!gc_defer_output(GC_OUTPUT_PENDING_COOLANT)) { coolant_sync(gc_block.modal.coolant); }
+    #else
+      coolant_sync(gc_block.modal.coolant);
+    #endif
     gc_state.modal.coolant = gc_block.modal.coolant;
   }
   pl_data->condition |= gc_state.modal.coolant; // Set condition flag for planner use.
+  #ifdef ENABLE_INLINE_OUTPUT_CHANGES
+    pl_data->digital_state = gc_state.digital_state; // Record data for planner use. Updated in [22].
+  #endif
 
   // [9. Override control ]: NOT SUPPORTED. Always enabled. Except for a Grbl-only parking control.
   #ifdef ENABLE_PARKING_OVERRIDE_CONTROL
@@ -1419,8 +1584,17 @@ uint8_t gc_execute_line(char *line)
     system_flag_wco_change();
   }
 
-  // [16. Set path control mode ]: G61.1/G64 NOT SUPPORTED
-  // gc_state.modal.control = gc_block.modal.control; // NOTE: Always default.
+  #ifdef ENABLE_PATH_BLENDING
+    // [16. Set path control mode ]: G61.1 NOT SUPPORTED
+    if (bit_istrue(command_dwords,dwbit(MODAL_GROUP_G13))) {
+      gc_state.modal.control = gc_block.modal.control;
+      gc_state.path_tolerance = path_tolerance;
+      mc_set_path_blending(path_tolerance);
+    }
+  #else
+    // [16. Set path control mode ]: G61.1/G64 NOT SUPPORTED
+    // gc_state.modal.control = gc_block.modal.control; // NOTE: Always default.
+  #endif
 
   // [17. Set distance mode ]:
   gc_state.modal.distance = gc_block.modal.distance;
@@ -1482,6 +1656,11 @@ uint8_t gc_execute_line(char *line)
             axis_u, axis_v, axis_w, axis_u_mask, axis_v_mask, axis_w_mask,
             axis_d, axis_e, axis_h, axis_d_mask, axis_e_mask, axis_h_mask,
             bit_istrue(gc_parser_flags,GC_PARSER_ARC_IS_CLOCKWISE));
+      } else if ((gc_state.modal.motion == MOTION_MODE_CUBIC_SPLINE) || (gc_state.modal.motion == MOTION_MODE_QUADRATIC_SPLINE)) {
+        mc_spline(gc_block.values.xyz, pl_data, gc_state.position, gc_block.values.ijk[axis_0], gc_block.values.ijk[axis_1],
+            gc_block.values.p, gc_block.values.q, axis_0, axis_1, axis_0_mask, axis_1_mask);
+        gc_state.spline_control[0] = gc_block.values.p;
+        gc_state.spline_control[1] = gc_block.values.q;
       } else {
         // NOTE: gc_block.values.xyz is returned from mc_probe_cycle with the updated position value. So
         // upon a successful probing cycle, the machine position and the returned value should be the same.
@@ -1526,6 +1705,9 @@ uint8_t gc_execute_line(char *line)
       gc_state.modal.coord_select = 0; // G54
       gc_state.modal.spindle = SPINDLE_DISABLE;
       gc_state.modal.coolant = COOLANT_DISABLE;
+      #ifdef ENABLE_INLINE_OUTPUT_CHANGES
+        gc_state.digital_state = DIGITAL_OUTPUT_STATE_OFF;
+      #endif
       #ifdef ENABLE_PARKING_OVERRIDE_CONTROL
         #ifdef DEACTIVATE_PARKING_UPON_INIT
           gc_state.modal.override = OVERRIDE_DISABLED;
@@ -1555,18 +1737,34 @@ uint8_t gc_execute_line(char *line)
 
   // [22. Digital output ]:
   if ((gc_block.non_modal_command >= NON_MODAL_DIGITAL_SYNC_ON) && (gc_block.non_modal_command <= NON_MODAL_DIGITAL_IMMEDIATE_OFF)) {
+    // NOTE: With inline output changes, the parser tracks the programmed state, which the following
+    // planner blocks carry. M62 and M63 do not wait for the queued motion.
     uint8_t digital_mode = digital_get_state();
     switch(gc_block.non_modal_command) {
       case NON_MODAL_DIGITAL_SYNC_ON:
+        #ifdef ENABLE_INLINE_OUTPUT_CHANGES
+          gc_state.digital_state |= bit((uint8_t) gc_block.values.p);
+          if (gc_defer_output(GC_OUTPUT_PENDING_DIGITAL)) { break; }
+        #endif
         digital_sync(digital_mode | bit((uint8_t) gc_block.values.p));
         break;
       case NON_MODAL_DIGITAL_SYNC_OFF:
+        #ifdef ENABLE_INLINE_OUTPUT_CHANGES
+          gc_state.digital_state &= ~(bit((uint8_t) gc_block.values.p));
+          if (gc_defer_output(GC_OUTPUT_PENDING_DIGITAL)) { break; }
+        #endif
         digital_sync(digital_mode & ~(bit((uint8_t) gc_block.values.p)));
         break;
       case NON_MODAL_DIGITAL_IMMEDIATE_ON:
+        #ifdef ENABLE_INLINE_OUTPUT_CHANGES
+          gc_state.digital_state |= bit((uint8_t) gc_block.values.p);
+        #endif
         digital_set_state(digital_mode | bit((uint8_t) gc_block.values.p));
         break;
       case NON_MODAL_DIGITAL_IMMEDIATE_OFF:
+        #ifdef ENABLE_INLINE_OUTPUT_CHANGES
+          gc_state.digital_state &= ~(bit((uint8_t) gc_block.values.p));
+        #endif
         digital_set_state(digital_mode & ~(bit((uint8_t) gc_block.values.p)));
         break;
     }
@@ -1617,6 +1815,21 @@ uint8_t gc_execute_line(char *line)
 }
 
 
+
+uint8_t gc_execute_line(char *line)
+{
+  return(gc_execute(line,0));
+}
+
+
+#if defined(ENABLE_BINARY_PROTOCOL) || defined(TOKENIZE_GCODE_ON_RECEIVE)
+  uint8_t gc_execute_block(char *block, uint8_t length)
+  {
+    if (length == 0) { return(STATUS_OK); } // Empty block. For syncing purposes.
+    return(gc_execute(block,length));
+  }
+#endif
+
 /*
   Not supported:
 
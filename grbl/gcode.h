@@ -75,6 +75,8 @@
 #define MOTION_MODE_LINEAR 1 // G1 (Do not alter value)
 #define MOTION_MODE_CW_ARC 2  // G2 (Do not alter value)
 #define MOTION_MODE_CCW_ARC 3  // G3 (Do not alter value)
+#define MOTION_MODE_CUBIC_SPLINE 5 // G5 (Do not alter value)
+#define MOTION_MODE_QUADRATIC_SPLINE 15 // G5.1 (Do not alter value)
 #define MOTION_MODE_PROBE_TOWARD 140 // G38.2 (Do not alter value)
 #define MOTION_MODE_PROBE_TOWARD_NO_ERROR 141 // G38.3 (Do not alter value)
 #define MOTION_MODE_PROBE_AWAY 142 // G38.4 (Do not alter value)
@@ -113,6 +115,7 @@
 
 // Modal Group G13: Control mode
 #define CONTROL_MODE_EXACT_PATH 0 // G61 (Default: Must be zero)
+#define CONTROL_MODE_CONTINUOUS 1 // G64
 
 // Modal Group M7: Spindle control
 #define SPINDLE_DISABLE 0 // M5 (Default: Must be zero)
@@ -172,9 +175,7 @@
 #define DWORD_U 16
 #define DWORD_V 17
 #define DWORD_W 18
-#ifdef USE_OUTPUT_PWM
-  #define DWORD_Q 19
-#endif
+#define DWORD_Q 19
 // Define g-code parser position updating flags
 #define GC_UPDATE_POS_TARGET   0 // Must be zero
 #define GC_UPDATE_POS_SYSTEM   1
@@ -202,6 +203,13 @@
 #define GC_PARSER_LASER_DISABLE         bit(6)
 #define GC_PARSER_LASER_ISMOTION        bit(7)
 
+#ifdef ENABLE_INLINE_OUTPUT_CHANGES
+  // Define output changes the parser left pending, until a planner block carries them to the stepper.
+  #define GC_OUTPUT_PENDING_SPINDLE bit(0)
+  #define GC_OUTPUT_PENDING_COOLANT bit(1)
+  #define GC_OUTPUT_PENDING_DIGITAL bit(2)
+#endif
+
 
 // NOTE: When this struct is zeroed, the above defines set the defaults for the system.
 typedef struct {
@@ -214,7 +222,11 @@ typedef struct {
   // uint8_t cutter_comp;  // {G40} NOTE: Don't track. Only default supported.
   uint8_t tool_length;     // {G43.1,G49}
   uint8_t coord_select;    // {G54,G55,G56,G57,G58,G59}
-  // uint8_t control;      // {G61} NOTE: Don't track. Only default supported.
+  #ifdef ENABLE_PATH_BLENDING
+    uint8_t control;       // {G61,G64}
+  #else
+    // uint8_t control;    // {G61} NOTE: Don't track. Only default supported.
+  #endif
   uint8_t program_flow;    // {M0,M1,M2,M30}
   uint8_t coolant;         // {M7,M8,M9}
   uint8_t spindle;         // {M3,M4,M5}
@@ -230,10 +242,8 @@ typedef struct {
 #endif
   uint8_t l;       // G10 or canned cycles parameters
   int32_t n;       // Line number
-  #ifdef USE_OUTPUT_PWM
-    float q;         // Output PWM valus
-  #endif
-  float p;         // G10 or dwell parameters
+  float q;         // Output PWM value or G5 control point offset
+  float p;         // G10, dwell parameters or G5 control point offset
   float r;         // Arc radius
   float s;         // Spindle speed
   uint8_t t;       // Tool selection
@@ -254,6 +264,9 @@ typedef struct {
     uint8_t output_last_command; // Last command used to modify output PWM
   #endif
   float feed_rate;               // Millimeters/min
+  #ifdef ENABLE_PATH_BLENDING
+    float path_tolerance;        // G64 P path blending tolerance in mm. Zero disables blending.
+  #endif
   uint8_t tool;                  // Tracks tool number. NOT USED.
   int32_t line_number;           // Last line number sent
 
@@ -264,6 +277,13 @@ typedef struct {
   float coord_offset[N_AXIS];    // Retains the G92 coordinate offset (work coordinates) relative to
                                  // machine zero in mm. Non-persistent. Cleared upon reset and boot.
   float tool_length_offset;      // Tracks tool length offset value when enabled.
+  float spline_control[2];       // Offset of the last spline second control point from its end point (mm).
+                                 // Mirrored as the first control point of a G5 without I and J.
+  #ifdef ENABLE_INLINE_OUTPUT_CHANGES
+    uint8_t digital_state;       // Programmed M62-M65 digital output state
+    uint8_t output_pending;      // Output changes not carried by a planner block yet. See GC_OUTPUT_PENDING.
+    float pending_spindle_speed; // Spindle speed of a pending spindle change
+  #endif
 } parser_state_t;
 extern parser_state_t gc_state;
 
@@ -281,7 +301,21 @@ void gc_init();
 // Execute one block of rs275/ngc/g-code
 uint8_t gc_execute_line(char *line);
 
+#if defined(ENABLE_BINARY_PROTOCOL) || defined(TOKENIZE_GCODE_ON_RECEIVE)
+  // Word letter of a tokenized block, for a word without a valid number, tokenized from a line.
+  #define GC_TOKEN_BAD_NUMBER 0x01
+
+  // Execute one tokenized block, of a binary frame or a received line, given its length in bytes.
+  // Each word is the letter followed by its binary value, see gc_execute().
+  uint8_t gc_execute_block(char *block, uint8_t length);
+#endif
+
 // Set g-code parser position. Input in steps.
 void gc_sync_position();
 
+#ifdef ENABLE_INLINE_OUTPUT_CHANGES
+  // Sets the output changes no planner block carried. Called when a cycle completes.
+  void gc_sync_outputs();
+#endif
+
 #endif
@@ -72,6 +72,59 @@
   #error "Required HOMING_CYCLE_0 not defined."
 #endif
 
+#if defined(STEPPER_ISR_PROFILER) && !defined(ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING)
+  #error "STEPPER_ISR_PROFILER requires ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING to be enabled."
+#endif
+
+#ifdef STEP_PULSE_OUTPUT_COMPARE
+  #if defined(STEPPER_ISR_PROFILER)
+    #error "STEPPER_ISR_PROFILER is not supported with STEP_PULSE_OUTPUT_COMPARE."
+  #endif
+  #if !defined(STEP_OC5A_AXIS) && !defined(STEP_OC5B_AXIS) && !defined(STEP_OC5C_AXIS)
+    #error "STEP_PULSE_OUTPUT_COMPARE requires a step pin on a Timer5 output compare pin in cpu_map.h."
+  #endif
+  #if (defined(STEP_OC5A_AXIS) && (STEP_BIT(STEP_OC5A_AXIS) != 3)) || (defined(STEP_OC5B_AXIS) && (STEP_BIT(STEP_OC5B_AXIS) != 4)) || (defined(STEP_OC5C_AXIS) && (STEP_BIT(STEP_OC5C_AXIS) != 5))
+    #error "The Timer5 output compare step pins must be OC5A (PL3), OC5B (PL4) and OC5C (PL5)."
+  #endif
+#endif
+
+#if defined(ENABLE_S_CURVE_ACCELERATION) && defined(USE_FIXED_POINT_MOTION)
+  #error "ENABLE_S_CURVE_ACCELERATION is not supported with USE_FIXED_POINT_MOTION."
+#endif
+
+#if (SEGMENT_CRUISE_TICKS < 1) || (SEGMENT_CRUISE_TICKS > 8)
+  #error "SEGMENT_CRUISE_TICKS must be between 1 and 8."
+#endif
+
+#if defined(ENABLE_INPUT_SHAPING) && (defined(USE_FIXED_POINT_MOTION) || defined(ENABLE_S_CURVE_ACCELERATION))
+  #error "ENABLE_INPUT_SHAPING is not supported with USE_FIXED_POINT_MOTION or ENABLE_S_CURVE_ACCELERATION."
+#endif
+
+#ifdef ENABLE_NATIVE_ARCS
+  #if defined(USE_FIXED_POINT_MOTION) || defined(ENABLE_S_CURVE_ACCELERATION) || defined(ENABLE_INPUT_SHAPING)
+    #error "ENABLE_NATIVE_ARCS is not supported with USE_FIXED_POINT_MOTION, ENABLE_S_CURVE_ACCELERATION or ENABLE_INPUT_SHAPING."
+  #endif
+  #ifdef COREXY
+    #error "ENABLE_NATIVE_ARCS is not supported with COREXY."
+  #endif
+#endif
+
+#if defined(TOKENIZE_GCODE_ON_RECEIVE) && defined(REPORT_ECHO_LINE_RECEIVED)
+  #error "REPORT_ECHO_LINE_RECEIVED is not supported with TOKENIZE_GCODE_ON_RECEIVE."
+#endif
+
+#if defined(ENABLE_PARSE_AHEAD_QUEUE) && ((PARSE_AHEAD_QUEUE_SIZE < 2) || (PARSE_AHEAD_QUEUE_SIZE > 255))
+  #error "PARSE_AHEAD_QUEUE_SIZE must be between 2 and 255."
+#endif
+
+#if defined(USE_EEPROM_WRITE_QUEUE) && ((EEPROM_WRITE_QUEUE_SIZE < 2) || (EEPROM_WRITE_QUEUE_SIZE > 255))
+  #error "EEPROM_WRITE_QUEUE_SIZE must be between 2 and 255."
+#endif
+
+#if defined(ENABLE_BINARY_PROTOCOL) && (LINE_BUFFER_SIZE < 256)
+  #error "ENABLE_BINARY_PROTOCOL requires a LINE_BUFFER_SIZE of at least 256, to fit the largest frame."
+#endif
+
 #if defined(PARKING_ENABLE)
   #if defined(HOMING_FORCE_SET_ORIGIN)
     #error "HOMING_FORCE_SET_ORIGIN is not supported with PARKING_ENABLE at this time."
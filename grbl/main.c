@@ -45,9 +45,12 @@ uint8_t axis_D_mask = 0; // Global mask for axis U bits
 uint8_t axis_E_mask = 0; // Global mask for axis V bits
 uint8_t axis_H_mask = 0; // Global mask for axis W bits
 unsigned char axis_name[N_AXIS]; // Global table of axis names
-#ifdef DEBUG
+#if defined(DEBUG) || defined(STEPPER_ISR_PROFILER) || defined(REPORT_FIELD_STARVATION_COUNTERS)
   volatile uint8_t sys_rt_exec_debug;
 #endif
+#ifdef REPORT_FIELD_STARVATION_COUNTERS
+  starvation_t sys_starvation;
+#endif
 #ifdef SORT_REPORT_BY_AXIS_NAME
   uint8_t n_axis_report;
 #endif
@@ -57,6 +60,7 @@ int main(void)
   // Initialize system upon power-up.
   serial_init();   // Setup serial baud rate and interrupts
   settings_init(); // Load Grbl settings from EEPROM
+  serial_set_baud_rate(settings.baud_rate); // Nothing has been sent yet. Keeps BAUD_RATE if invalid.
   stepper_init();  // Configure stepper pins and interrupt timers
   system_init();   // Configure pinout pins and pin-change interrupt
 
@@ -506,6 +510,9 @@ int main(void)
 
     // Reset Grbl primary systems.
     serial_reset_read_buffer(); // Clear serial read buffer
+    #ifdef ENABLE_BINARY_PROTOCOL
+      serial_reset_frame_mode(); // Return to the g-code line protocol.
+    #endif
     gc_init(); // Set g-code parser to default state
     spindle_init();
     #ifdef USE_OUTPUT_PWM
@@ -516,6 +523,12 @@ int main(void)
     limits_init();
     probe_init();
     sleep_init();
+    #ifdef ENABLE_PATH_BLENDING
+      mc_reset_blending(); // Discard any line motion held back for path blending.
+    #endif
+    #ifdef ENABLE_PARSE_AHEAD_QUEUE
+      mc_reset_line_queue(); // Discard any line motions parsed ahead of the planner.
+    #endif
     plan_reset(); // Clear block buffer and planner variables
     st_reset(); // Clear stepper subsystem variables.
 
@@ -23,6 +23,259 @@
 #include "grbl.h"
 
 
+#ifdef ENABLE_PATH_BLENDING
+  // G64 path blending. Feed motions are held back and merged with the next ones into a single line,
+  // while every merged end point stays within the path tolerance of it. See mc_line().
+  typedef struct {
+    float tolerance_sqr;      // Square of the path tolerance in mm^2. Zero disables blending.
+    uint8_t n_points;         // Number of merged end points. Zero, if no line motion is held back.
+    float start[N_AXIS];      // Start of the held line. The planner position, when it was started.
+    float points[PATH_BLENDING_MAX_POINTS][N_AXIS]; // Merged end points. The last one ends the line.
+    plan_line_data_t pl_data; // Planner data of the last merged motion. Same for all but line number.
+  } blend_t;
+  static blend_t blend;
+#endif
+
+#ifdef ENABLE_PARSE_AHEAD_QUEUE
+  // Parse-ahead queue. Line motions parsed while the planner buffer is full wait here, in program
+  // order, so the main loop can go on receiving and parsing the next lines. See mc_queue_line().
+  typedef struct {
+    float target[N_AXIS];
+    plan_line_data_t pl_data;
+  } queued_line_t;
+  static queued_line_t line_queue[PARSE_AHEAD_QUEUE_SIZE];
+  static uint8_t line_queue_tail;  // Index of the oldest queued line motion.
+  static uint8_t line_queue_count; // Number of queued line motions.
+#endif
+
+
+// Waits for room in the planner buffer. Returns early upon a system abort.
+static void mc_wait_for_planner_buffer()
+{
+  // If the buffer is full: good! That means we are well ahead of the robot.
+  // Remain in this loop until there is room in the buffer.
+  do {
+    protocol_execute_realtime(); // Check for any run-time commands
+    if (sys.abort) { return; } // Bail, if system abort.
+    if ( plan_check_full_buffer() ) { protocol_auto_cycle_start(); } // Auto-cycle start when buffer is full.
+    else { break; }
+  } while (1);
+}
+
+
+// Waits for room in the planner buffer and plans a line motion. Called by mc_plan_line() only.
+static void mc_buffer_line(float *target, plan_line_data_t *pl_data)
+{
+  mc_wait_for_planner_buffer();
+  if (sys.abort) { return; } // Bail, if system abort.
+
+  // Plan and queue motion into planner buffer
+  if (plan_buffer_line(target, pl_data) == PLAN_EMPTY_BLOCK) {
+    if (bit_istrue(settings.flags,BITFLAG_LASER_MODE)) {
+      // Correctly set spindle state, if there is a coincident position passed. Forces a buffer
+      // sync while in M3 laser mode only.
+      if (pl_data->condition & PL_COND_FLAG_SPINDLE_CW) {
+        spindle_sync(PL_COND_FLAG_SPINDLE_CW, pl_data->spindle_speed);
+      }
+    }
+  }
+  #ifdef ENABLE_INLINE_OUTPUT_CHANGES
+    else { gc_state.output_pending = 0; } // The block carries the output changes left pending by the parser.
+  #endif
+}
+
+
+// Splits a line motion as needed and plans it. Called by mc_queue_line() and the parse-ahead queue only.
+static void mc_plan_line(float *target, plan_line_data_t *pl_data)
+{
+  // Planner blocks hold a limited number of steps per axis. Split longer motions into equal, collinear
+  // pieces, which the planner joins without slowing down. The last piece ends exactly on target.
+  uint16_t n_blocks = plan_get_line_block_count(target);
+  if (n_blocks > 1) {
+    float position[N_AXIS], block_target[N_AXIS];
+    uint16_t block_count;
+    uint8_t idx;
+    plan_get_planner_mpos(position);
+    // Each piece takes its share of the inverse time motion.
+    if (pl_data->condition & PL_COND_FLAG_INVERSE_TIME) { pl_data->feed_rate *= n_blocks; }
+    for (block_count=1; block_count<n_blocks; block_count++) {
+      for (idx=0; idx<N_AXIS; idx++) {
+        block_target[idx] = position[idx] + ((target[idx]-position[idx])*block_count)/n_blocks;
+      }
+      mc_buffer_line(block_target, pl_data);
+      if (sys.abort) { return; }
+    }
+  }
+  mc_buffer_line(target, pl_data);
+}
+
+
+#ifdef ENABLE_PARSE_AHEAD_QUEUE
+  void mc_plan_queued_lines()
+  {
+    float target[N_AXIS];
+    plan_line_data_t pl_data;
+    while (line_queue_count && !plan_check_full_buffer()) {
+      // Taken off the queue first, since planning may sync the buffer and plan the next ones.
+      memcpy(target, line_queue[line_queue_tail].target, sizeof(target));
+      memcpy(&pl_data, &line_queue[line_queue_tail].pl_data, sizeof(plan_line_data_t));
+      if (++line_queue_tail == PARSE_AHEAD_QUEUE_SIZE) { line_queue_tail = 0; }
+      line_queue_count--;
+      #ifdef ENABLE_INLINE_OUTPUT_CHANGES
+        // Output changes pending now may come from lines parsed after this motion. Keep them.
+        uint8_t output_pending = gc_state.output_pending;
+      #endif
+      mc_plan_line(target, &pl_data);
+      #ifdef ENABLE_INLINE_OUTPUT_CHANGES
+        gc_state.output_pending = output_pending;
+      #endif
+      if (sys.abort) { return; }
+    }
+  }
+
+
+  void mc_flush_line_queue()
+  {
+    while (line_queue_count) {
+      mc_wait_for_planner_buffer();
+      if (sys.abort) { return; }
+      mc_plan_queued_lines();
+      if (sys.abort) { return; }
+    }
+  }
+
+
+  void mc_reset_line_queue()
+  {
+    line_queue_tail = 0;
+    line_queue_count = 0;
+  }
+#endif
+
+
+// Plans a line motion. With the parse-ahead queue, the motion is queued instead, while the planner
+// buffer is full or older motions still wait. It then only waits, while the queue is full too.
+// Called by mc_line() and the path blending only.
+static void mc_queue_line(float *target, plan_line_data_t *pl_data)
+{
+  #ifdef ENABLE_PARSE_AHEAD_QUEUE
+    if (line_queue_count || plan_check_full_buffer()) {
+      while (line_queue_count == PARSE_AHEAD_QUEUE_SIZE) {
+        protocol_execute_realtime(); // Check for any run-time commands
+        if (sys.abort) { return; } // Bail, if system abort.
+        mc_plan_queued_lines();
+        if (sys.abort) { return; }
+        if (plan_check_full_buffer()) { protocol_auto_cycle_start(); } // Auto-cycle start when buffer is full.
+      }
+      uint16_t index = line_queue_tail+line_queue_count;
+      if (index >= PARSE_AHEAD_QUEUE_SIZE) { index -= PARSE_AHEAD_QUEUE_SIZE; }
+      memcpy(line_queue[index].target, target, sizeof(line_queue[index].target));
+      memcpy(&line_queue[index].pl_data, pl_data, sizeof(plan_line_data_t));
+      line_queue_count++;
+      mc_plan_queued_lines(); // Plans right away, if the planner buffer has room again.
+      if (plan_check_full_buffer()) { protocol_auto_cycle_start(); } // Auto-cycle start when buffer is full.
+      return;
+    }
+  #endif
+  mc_plan_line(target, pl_data);
+}
+
+
+#ifdef ENABLE_PATH_BLENDING
+  // Returns the position in millimeters, where the next line motion starts. The planner position,
+  // unless line motions are queued ahead of the planner. Then the last queued target, rounded to steps
+  // as the planner will.
+  static void mc_get_line_start(float *position)
+  {
+    #ifdef ENABLE_PARSE_AHEAD_QUEUE
+      if (line_queue_count) {
+        uint16_t index = line_queue_tail+line_queue_count-1;
+        if (index >= PARSE_AHEAD_QUEUE_SIZE) { index -= PARSE_AHEAD_QUEUE_SIZE; }
+        uint8_t idx;
+        for (idx=0; idx<N_AXIS; idx++) {
+          position[idx] = lround(line_queue[index].target[idx]*settings.steps_per_mm[idx])/settings.steps_per_mm[idx];
+        }
+        return;
+      }
+    #endif
+    plan_get_planner_mpos(position);
+  }
+
+
+  // Returns true, if all merged end points lie within the path tolerance of the line from the held line
+  // start to target. Distances are taken to the line segment, over all axes.
+  static uint8_t mc_blend_fits(float *target)
+  {
+    float line[N_AXIS], offset[N_AXIS];
+    float line_sqr = 0.0, t, dist_sqr;
+    uint8_t idx, n;
+    for (idx=0; idx<N_AXIS; idx++) {
+      line[idx] = target[idx]-blend.start[idx];
+      line_sqr += line[idx]*line[idx];
+    }
+    for (n=0; n<blend.n_points; n++) {
+      t = 0.0;
+      for (idx=0; idx<N_AXIS; idx++) {
+        offset[idx] = blend.points[n][idx]-blend.start[idx];
+        t += offset[idx]*line[idx];
+      }
+      // Project the end point onto the line, clamped to the segment.
+      if ((t > 0.0) && (line_sqr > 0.0)) {
+        t /= line_sqr;
+        if (t > 1.0) { t = 1.0; }
+      } else { t = 0.0; }
+      dist_sqr = 0.0;
+      for (idx=0; idx<N_AXIS; idx++) {
+        offset[idx] -= t*line[idx];
+        dist_sqr += offset[idx]*offset[idx];
+      }
+      if (dist_sqr > blend.tolerance_sqr) { return(false); }
+    }
+    return(true);
+  }
+
+
+  // Returns true, if the motion may be merged with the held line motion.
+  static uint8_t mc_blend_is_compatible(plan_line_data_t *pl_data)
+  {
+    if (blend.n_points >= PATH_BLENDING_MAX_POINTS) { return(false); }
+    if (pl_data->condition != blend.pl_data.condition) { return(false); }
+    if (pl_data->feed_rate != blend.pl_data.feed_rate) { return(false); }
+    if (pl_data->spindle_speed != blend.pl_data.spindle_speed) { return(false); }
+    #ifdef USE_OUTPUT_PWM
+      if (pl_data->output_volts != blend.pl_data.output_volts) { return(false); }
+    #endif
+    #ifdef ENABLE_INLINE_OUTPUT_CHANGES
+      if (pl_data->digital_state != blend.pl_data.digital_state) { return(false); }
+    #endif
+    return(true);
+  }
+
+
+  void mc_set_path_blending(float tolerance)
+  {
+    mc_flush_blending();
+    blend.tolerance_sqr = tolerance*tolerance;
+  }
+
+
+  void mc_flush_blending()
+  {
+    if (blend.n_points) {
+      uint8_t n_points = blend.n_points;
+      blend.n_points = 0;
+      mc_queue_line(blend.points[n_points-1], &blend.pl_data);
+    }
+  }
+
+
+  void mc_reset_blending()
+  {
+    memset(&blend, 0, sizeof(blend_t));
+  }
+#endif
+
+
 // Execute linear motion in absolute millimeter coordinates. Feed rate given in millimeters/second
 // unless invert_feed_rate is true. Then the feed_rate means that the motion should be completed in
 // (1 minute)/feed_rate time.
@@ -56,26 +309,121 @@ void mc_line(float *target, plan_line_data_t *pl_data)
   // doesn't update the machine position values. Since the position values used by the g-code
   // parser and planner are separate from the system machine positions, this is doable.
 
-  // If the buffer is full: good! That means we are well ahead of the robot.
-  // Remain in this loop until there is room in the buffer.
-  do {
-    protocol_execute_realtime(); // Check for any run-time commands
-    if (sys.abort) { return; } // Bail, if system abort.
-    if ( plan_check_full_buffer() ) { protocol_auto_cycle_start(); } // Auto-cycle start when buffer is full.
-    else { break; }
-  } while (1);
+  #ifdef ENABLE_PATH_BLENDING
+    // G64 path blending: Hold feed motions back, and merge them into one line motion with the next ones,
+    // while it stays within the path tolerance. Rapids, inverse time, jog and probe motions are never
+    // merged. The held motion is planned when the next one does not fit, or upon a buffer sync.
+    if ((blend.tolerance_sqr > 0.0) && !(pl_data->condition & (PL_COND_MOTION_MASK|PL_COND_FLAG_INVERSE_TIME))) {
+      if (blend.n_points) {
+        if (mc_blend_is_compatible(pl_data) && mc_blend_fits(target)) {
+          memcpy(blend.points[blend.n_points++], target, sizeof(blend.start));
+          blend.pl_data.line_number = pl_data->line_number; // Report the last merged line.
+          return;
+        }
+        mc_flush_blending();
+        if (sys.abort) { return; }
+      }
+      mc_get_line_start(blend.start);
+      memcpy(blend.points[0], target, sizeof(blend.start));
+      memcpy(&blend.pl_data, pl_data, sizeof(plan_line_data_t));
+      blend.n_points = 1;
+      return;
+    }
 
-  // Plan and queue motion into planner buffer
-  if (plan_buffer_line(target, pl_data) == PLAN_EMPTY_BLOCK) {
-    if (bit_istrue(settings.flags,BITFLAG_LASER_MODE)) {
-      // Correctly set spindle state, if there is a coincident position passed. Forces a buffer
-      // sync while in M3 laser mode only.
-      if (pl_data->condition & PL_COND_FLAG_SPINDLE_CW) {
-        spindle_sync(PL_COND_FLAG_SPINDLE_CW, pl_data->spindle_speed);
+    mc_flush_blending();
+    if (sys.abort) { return; }
+  #endif
+  mc_queue_line(target, pl_data);
+}
+
+
+#ifdef ENABLE_NATIVE_ARCS
+  // Plans an arc as native arc blocks, which the step segment generator traces chord by chord. Splits
+  // the arc into pieces of equal angular travel, only if it exceeds the planner block step counts. The
+  // arguments are as for mc_arc(), where angular_travel is the signed arc angle.
+  static void mc_arc_native(float *target, plan_line_data_t *pl_data, float *position, float *offset,
+    float angular_travel, uint8_t axis_0, uint8_t axis_1, uint8_t axis_0_mask, uint8_t axis_1_mask)
+  {
+    float center_axis0 = position[axis_0] + offset[axis_0];
+    float center_axis1 = position[axis_1] + offset[axis_1];
+    float radius = hypot_f(offset[axis_0], offset[axis_1]);
+    float point[N_AXIS];
+    float fraction;
+    uint8_t idx;
+
+    // Check the soft limits at the arc end and wherever the arc passes a plane axis direction, since
+    // these points bound the arc extent. Replaces the checks of the chords by mc_line().
+    if (bit_istrue(settings.flags,BITFLAG_SOFT_LIMIT_ENABLE)) {
+      float start_angle = atan2(-offset[axis_1], -offset[axis_0]);
+      float angle_step = 0.5*M_PI;
+      float angle;
+      if (angular_travel > 0.0) { angle = ceil(start_angle/angle_step)*angle_step; }
+      else {
+        angle = floor(start_angle/angle_step)*angle_step;
+        angle_step = -angle_step;
+      }
+      float sin_a, cos_a;
+      while ((fraction = (angle-start_angle)/angular_travel) < 1.0) {
+        sin_cos_f(angle, &sin_a, &cos_a);
+        for (idx=0; idx<N_AXIS; idx++) {
+          if (bit_istrue(bit(idx), axis_0_mask)) { point[idx] = center_axis0 + radius*cos_a; }
+          else if (bit_istrue(bit(idx), axis_1_mask)) { point[idx] = center_axis1 + radius*sin_a; }
+          else { point[idx] = position[idx] + fraction*(target[idx]-position[idx]); }
+        }
+        limits_soft_check(point);
+        if (sys.abort) { return; }
+        angle += angle_step;
       }
+      limits_soft_check(target);
+      if (sys.abort) { return; }
     }
+
+    // If in check gcode mode, prevent motion by blocking planner. Soft limits still work.
+    if (sys.state == STATE_CHECK_MODE) { return; }
+    #ifdef ENABLE_PATH_BLENDING
+      mc_flush_blending(); // Plan any held G64 line motion first.
+      if (sys.abort) { return; }
+    #endif
+    #ifdef ENABLE_PARSE_AHEAD_QUEUE
+      mc_flush_line_queue(); // The arc blocks are planned directly, from the planner position.
+      if (sys.abort) { return; }
+    #endif
+
+    uint16_t n_blocks = plan_get_arc_block_count(target, fabs(angular_travel)*radius, axis_0_mask|axis_1_mask);
+    // Each piece takes its share of the inverse time motion.
+    if (pl_data->condition & PL_COND_FLAG_INVERSE_TIME) { pl_data->feed_rate *= n_blocks; }
+    plan_arc_data_t arc_data;
+    arc_data.travel = angular_travel/n_blocks;
+    arc_data.axis_0_mask = axis_0_mask;
+    arc_data.axis_1_mask = axis_1_mask;
+    float cos_Ti, sin_Ti;
+    uint16_t block_count;
+    for (block_count=1; block_count<=n_blocks; block_count++) {
+      // Radius vector at the piece start, rotated from the initial one (=-offset).
+      sin_cos_f((block_count-1)*arc_data.travel, &sin_Ti, &cos_Ti);
+      arc_data.start[0] = -offset[axis_0]*cos_Ti + offset[axis_1]*sin_Ti;
+      arc_data.start[1] = -offset[axis_0]*sin_Ti - offset[axis_1]*cos_Ti;
+      if (block_count < n_blocks) {
+        // Piece end point on the arc. The last piece ends exactly on target.
+        sin_cos_f(block_count*arc_data.travel, &sin_Ti, &cos_Ti);
+        fraction = (float)block_count/n_blocks;
+        for (idx=0; idx<N_AXIS; idx++) {
+          if (bit_istrue(bit(idx), axis_0_mask)) { point[idx] = center_axis0 - offset[axis_0]*cos_Ti + offset[axis_1]*sin_Ti; }
+          else if (bit_istrue(bit(idx), axis_1_mask)) { point[idx] = center_axis1 - offset[axis_0]*sin_Ti - offset[axis_1]*cos_Ti; }
+          else { point[idx] = position[idx] + fraction*(target[idx]-position[idx]); }
+        }
+      } else {
+        memcpy(point, target, sizeof(point));
+      }
+      mc_wait_for_planner_buffer();
+      if (sys.abort) { return; }
+      plan_buffer_arc(point, pl_data, &arc_data);
+    }
+    #ifdef ENABLE_INLINE_OUTPUT_CHANGES
+      gc_state.output_pending = 0; // The arc blocks carry the output changes left pending by the parser.
+    #endif
   }
-}
+#endif
 
 
 // Execute an arc in offset mode format. position == current xyz, target == target xyz,
@@ -98,9 +446,11 @@ void mc_arc(float *target, plan_line_data_t *pl_data, float *position, float *of
   float r_axis1 = -offset[axis_1];
   float rt_axis0 = target[axis_0] - center_axis0;
   float rt_axis1 = target[axis_1] - center_axis1;
-  float a_per_segment, b_per_segment, c_per_segment;
-  float u_per_segment, v_per_segment, w_per_segment;
-  float d_per_segment, e_per_segment, h_per_segment;
+  #ifndef ENABLE_NATIVE_ARCS
+    float a_per_segment, b_per_segment, c_per_segment;
+    float u_per_segment, v_per_segment, w_per_segment;
+    float d_per_segment, e_per_segment, h_per_segment;
+  #endif
 
   // CCW angle between position and target from circle center. Only one atan2() trig computation required.
   float angular_travel = atan2(r_axis0*rt_axis1-r_axis1*rt_axis0, r_axis0*rt_axis0+r_axis1*rt_axis1);
@@ -110,6 +460,9 @@ void mc_arc(float *target, plan_line_data_t *pl_data, float *position, float *of
     if (angular_travel <= ARC_ANGULAR_TRAVEL_EPSILON) { angular_travel += 2*M_PI; }
   }
 
+  #ifdef ENABLE_NATIVE_ARCS
+    mc_arc_native(target, pl_data, position, offset, angular_travel, axis_0, axis_1, axis_0_mask, axis_1_mask);
+  #else
   // NOTE: Segment end points are on the arc, which can lead to the arc diameter being smaller by up to
   // (2x) settings.arc_tolerance. For 99% of users, this is just fine. If a different arc segment fit
   // is desired, i.e. least-squares, midpoint on arc, just change the mm_per_arc_segment calculation.
@@ -117,6 +470,28 @@ void mc_arc(float *target, plan_line_data_t *pl_data, float *position, float *of
   uint16_t segments = floor(fabs(0.5*angular_travel*radius)/
                           sqrt(settings.arc_tolerance*(2*radius - settings.arc_tolerance)) );
 
+  #ifdef ENABLE_ADAPTIVE_ARC_SEGMENTS
+    // Lengthen the segments to last at least ARC_ADAPTIVE_SEGMENT_TIME at the speed the arc can reach,
+    // which is the overridden feed rate limited by the centripetal speed sqrt(a*r) in the arc plane.
+    // The minimum time is scaled by the planner fill, so arcs from an empty buffer keep the full
+    // resolution, and the chordal tolerance is relaxed up to ARC_ADAPTIVE_MAX_TOLERANCE times
+    // settings.arc_tolerance. The segment count is rounded up, so no chord exceeds either length.
+    if (segments > 1) {
+      float arc_mm = fabs(angular_travel*radius);
+      float arc_rate = pl_data->feed_rate;
+      if (pl_data->condition & PL_COND_FLAG_INVERSE_TIME) { arc_rate *= arc_mm; }
+      if (!(pl_data->condition & PL_COND_FLAG_NO_FEED_OVERRIDE)) { arc_rate *= (0.01*sys.f_override); }
+      float centripetal_rate = sqrt(min(settings.acceleration[axis_0], settings.acceleration[axis_1])*radius);
+      if (arc_rate > centripetal_rate) { arc_rate = centripetal_rate; }
+      uint8_t block_count = (BLOCK_BUFFER_SIZE-1) - plan_get_block_buffer_available();
+      float segment_mm = arc_rate*(ARC_ADAPTIVE_SEGMENT_TIME/60000.0)*block_count/(BLOCK_BUFFER_SIZE-1);
+      float max_tolerance = min(ARC_ADAPTIVE_MAX_TOLERANCE*settings.arc_tolerance, radius);
+      float max_segment_mm = 2.0*sqrt(max_tolerance*(2*radius - max_tolerance));
+      if (segment_mm > max_segment_mm) { segment_mm = max_segment_mm; }
+      if (segment_mm*segments > arc_mm) { segments = max(ceil(arc_mm/segment_mm), 1); }
+    }
+  #endif
+
   if (segments) {
     // Multiply inverse feed_rate to compensate for the fact that this movement is approximated
     // by a number of discrete segments. The inverse feed_rate should be correct for the sum of
@@ -184,9 +559,9 @@ void mc_arc(float *target, plan_line_data_t *pl_data, float *position, float *of
         count++;
       } else {
         // Arc correction to radius vector. Computed only every N_ARC_CORRECTION increments. ~375 usec
+        // with libm, much less with USE_TRIG_LOOKUP_TABLE.
         // Compute exact location by applying transformation matrix from initial radius vector(=-offset).
-        cos_Ti = cos(i*theta_per_segment);
-        sin_Ti = sin(i*theta_per_segment);
+        sin_cos_f(i*theta_per_segment, &sin_Ti, &cos_Ti);
         r_axis0 = -offset[axis_0]*cos_Ti + offset[axis_1]*sin_Ti;
         r_axis1 = -offset[axis_0]*sin_Ti - offset[axis_1]*cos_Ti;
         count = 0;
@@ -380,6 +755,92 @@ void mc_arc(float *target, plan_line_data_t *pl_data, float *position, float *of
   }
   // Ensure last segment arrives at target location.
   mc_line(target, pl_data);
+  #endif
+}
+
+
+// Returns the spline parameter at the end of the segment starting at t. The segment is made as long
+// as its chord stays within settings.arc_tolerance of the curve. For a parameter step h, the chord
+// deviates by at most h^2/8 times the largest second derivative over the step, which is linear in t
+// for a cubic and so peaks at either end. coef_2 and coef_3 are the quadratic and cubic coefficients.
+// NOTE: The step is at least 1/SPLINE_SEGMENTS_MAX, so the spline takes no more segments than that.
+static float mc_spline_next(float t, float *coef_2, float *coef_3)
+{
+  float ddx = 2.0*coef_2[0] + 6.0*coef_3[0]*t; // Second derivative at t
+  float ddy = 2.0*coef_2[1] + 6.0*coef_3[1]*t;
+  float dd_sqr = ddx*ddx + ddy*ddy;
+  float limit = 8.0*settings.arc_tolerance;
+  float step = 1.0 - t;
+  if (dd_sqr*step*step*step*step > limit*limit) { step = sqrt(limit/sqrt(dd_sqr)); }
+  ddx += 6.0*coef_3[0]*step; // Second derivative at the step end
+  ddy += 6.0*coef_3[1]*step;
+  float dd_end_sqr = ddx*ddx + ddy*ddy;
+  if ((dd_end_sqr > dd_sqr) && (dd_end_sqr*step*step*step*step > limit*limit)) { step = sqrt(limit/sqrt(dd_end_sqr)); }
+  if (step < (1.0/SPLINE_SEGMENTS_MAX)) { step = 1.0/SPLINE_SEGMENTS_MAX; }
+  t += step;
+  if (t > 1.0) { t = 1.0; }
+  return(t);
+}
+
+
+// Execute a cubic Bezier spline in the plane of axis_0 and axis_1, from position to target. The
+// control points are given as the offset of the first from position and of the second from target.
+// The spline is split into line segments within the arc tolerance, which are only computed as the
+// planner buffer takes them, so a short G5 block can feed the planner for a long time.
+void mc_spline(float *target, plan_line_data_t *pl_data, float *position, float first_0, float first_1,
+  float second_0, float second_1, uint8_t axis_0, uint8_t axis_1, uint8_t axis_0_mask, uint8_t axis_1_mask)
+{
+  // Power basis coefficients of the curve, relative to position: B(t) = ((c3*t + c2)*t + c1)*t.
+  float delta[2], coef_1[2], coef_2[2], coef_3[2];
+  delta[0] = target[axis_0]-position[axis_0];
+  delta[1] = target[axis_1]-position[axis_1];
+  coef_1[0] = 3.0*first_0;
+  coef_1[1] = 3.0*first_1;
+  coef_2[0] = 3.0*(delta[0]+second_0) - 6.0*first_0;
+  coef_2[1] = 3.0*(delta[1]+second_1) - 6.0*first_1;
+  coef_3[0] = 3.0*(first_0-second_0) - 2.0*delta[0];
+  coef_3[1] = 3.0*(first_1-second_1) - 2.0*delta[1];
+
+  float point[N_AXIS];
+  float t, x, y;
+  uint8_t idx;
+
+  if (pl_data->condition & PL_COND_FLAG_INVERSE_TIME) {
+    // The segment count is only known once traced. Convert the inverse time to the feed rate of the
+    // traced path, which is then used for every segment.
+    float prev_x = 0.0, prev_y = 0.0, millimeters = 0.0;
+    t = 0.0;
+    do {
+      t = mc_spline_next(t, coef_2, coef_3);
+      x = ((coef_3[0]*t + coef_2[0])*t + coef_1[0])*t;
+      y = ((coef_3[1]*t + coef_2[1])*t + coef_1[1])*t;
+      millimeters += hypot_f(x-prev_x, y-prev_y);
+      prev_x = x;
+      prev_y = y;
+      // Bail mid-trace on a system abort.
+      protocol_execute_realtime();
+      if (sys.abort) { return; }
+    } while (t < 1.0);
+    pl_data->feed_rate *= millimeters;
+    bit_false(pl_data->condition,PL_COND_FLAG_INVERSE_TIME); // Force as feed absolute mode over spline segments.
+  }
+
+  memcpy(point, target, sizeof(point)); // Axes outside of the plane do not move.
+  t = mc_spline_next(0.0, coef_2, coef_3);
+  while (t < 1.0) {
+    x = position[axis_0] + ((coef_3[0]*t + coef_2[0])*t + coef_1[0])*t;
+    y = position[axis_1] + ((coef_3[1]*t + coef_2[1])*t + coef_1[1])*t;
+    for (idx=0; idx<N_AXIS; idx++) {
+      if (bit_istrue(bit(idx), axis_0_mask)) { point[idx] = x; }
+      else if (bit_istrue(bit(idx), axis_1_mask)) { point[idx] = y; }
+    }
+    mc_line(point, pl_data);
+    // Bail mid-spline on a system abort. Runtime command check already performed by mc_line.
+    if (sys.abort) { return; }
+    t = mc_spline_next(t, coef_2, coef_3);
+  }
+  // Ensure last segment arrives at target location.
+  mc_line(target, pl_data);
 }
 
 
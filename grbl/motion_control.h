@@ -30,11 +30,42 @@
 
 #define HOMING_CYCLE_ALL  0  // Must be zero.
 
+#ifdef ENABLE_PATH_BLENDING
+  // A line motion held back for G64 path blending is planned once the serial input runs dry and
+  // fewer than this many blocks are left in the planner.
+  #define PATH_BLENDING_FLUSH_BLOCKS (BLOCK_BUFFER_SIZE/4)
+#endif
+
 // Execute linear motion in absolute millimeter coordinates. Feed rate given in millimeters/second
 // unless invert_feed_rate is true. Then the feed_rate means that the motion should be completed in
 // (1 minute)/feed_rate time.
 void mc_line(float *target, plan_line_data_t *pl_data);
 
+#ifdef ENABLE_PATH_BLENDING
+  // Sets the G64 path blending tolerance in millimeters. Zero disables blending, as with G61.
+  void mc_set_path_blending(float tolerance);
+
+  // Plans the line motion held back for path blending, if any. Must be called before anything that
+  // requires all motions to be in the planner, like a buffer sync.
+  void mc_flush_blending();
+
+  // Discards any held line motion and disables path blending. Called upon a system reset.
+  void mc_reset_blending();
+#endif
+
+#ifdef ENABLE_PARSE_AHEAD_QUEUE
+  // Plans the line motions queued ahead of the planner, in program order, while the planner buffer has
+  // room. Called by the main loop after every line.
+  void mc_plan_queued_lines();
+
+  // Plans all queued line motions, waiting for planner buffer room as needed. Must be called before
+  // anything that requires all motions to be in the planner, like a buffer sync.
+  void mc_flush_line_queue();
+
+  // Discards all queued line motions. Called upon a system reset and a jog cancel.
+  void mc_reset_line_queue();
+#endif
+
 // Execute an arc in offset mode format. position == current xyz, target == target xyz,
 // offset == offset from current xyz, axis_XXX defines circle plane in tool space, axis_linear is
 // the direction of helical travel, radius == circle radius, is_clockwise_arc boolean. Used
@@ -46,6 +77,11 @@ void mc_arc(float *target, plan_line_data_t *pl_data, float *position, float *of
   uint8_t axis_d, uint8_t axis_e, uint8_t axis_h, uint8_t axis_d_mask, uint8_t axis_e_mask, uint8_t axis_h_mask,
   uint8_t is_clockwise_arc);
 
+// Execute a cubic Bezier spline in the axis_0/axis_1 plane, for G5 and G5.1. The first control point is
+// given as its offset from position and the second as its offset from target.
+void mc_spline(float *target, plan_line_data_t *pl_data, float *position, float first_0, float first_1,
+  float second_0, float second_1, uint8_t axis_0, uint8_t axis_1, uint8_t axis_0_mask, uint8_t axis_1_mask);
+
 // Dwell for a specific number of seconds
 void mc_dwell(float seconds);
 
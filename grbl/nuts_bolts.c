@@ -23,9 +23,6 @@
 #include "grbl.h"
 
 
-#define MAX_INT_DIGITS 8 // Maximum number of digits in int32 (and float)
-
-
 // Extracts a floating point value from a string. The following code is based loosely on
 // the avr-libc strtod() function by Michael Stumpf and Dmitry Xmelkov and many freely
 // available conversion method examples, but has been highly optimized for Grbl. For known
@@ -76,6 +73,15 @@ uint8_t read_float(char *line, uint8_t *char_counter, float *float_ptr)
   // Return if no digits have been read.
   if (!ndigit) { return(false); };
 
+  *float_ptr = decimal_to_float(intval, exp, isnegative);
+  *char_counter = ptr - line - 1; // Set char_counter to next statement
+
+  return(true);
+}
+
+
+float decimal_to_float(uint32_t intval, int8_t exp, uint8_t isnegative)
+{
   // Convert integer into floating point.
   float fval;
   fval = (float)intval;
@@ -96,16 +102,9 @@ uint8_t read_float(char *line, uint8_t *char_counter, float *float_ptr)
     }
   }
 
-  // Assign floating point value with correct sign.
-  if (isnegative) {
-    *float_ptr = -fval;
-  } else {
-    *float_ptr = fval;
-  }
-
-  *char_counter = ptr - line - 1; // Set char_counter to next statement
-
-  return(true);
+  // Return floating point value with correct sign.
+  if (isnegative) { return(-fval); }
+  return(fval);
 }
 
 
@@ -162,6 +161,58 @@ void delay_us(uint32_t us)
 float hypot_f(float x, float y) { return(sqrt(x*x + y*y)); }
 
 
+#ifdef USE_TRIG_LOOKUP_TABLE
+  // Sine of the table angles k*pi/128 over the first quadrant. The other quadrants and the cosine
+  // are mirrored from these 65 values. The constants are floats, so a host build computes exactly
+  // what the AVR does, where double is float.
+  #define SIN_TABLE_QUADRANT 64
+  #define SIN_TABLE_STEPS_PER_RAD 40.7436654f // 128/pi
+  #define SIN_TABLE_STEP_HI 0.02454376220703125f // pi/128, split so n*SIN_TABLE_STEP_HI is exact.
+  #define SIN_TABLE_STEP_LO -6.96008610E-8f
+  static const float sin_table[SIN_TABLE_QUADRANT+1] PROGMEM = {
+  0, 0.024541229, 0.0490676761, 0.0735645667, 0.0980171412, 0.122410677, 0.146730468, 0.170961887,
+  0.195090324, 0.219101235, 0.242980182, 0.266712755, 0.290284663, 0.313681751, 0.336889863, 0.359895051,
+  0.382683426, 0.405241311, 0.427555084, 0.449611336, 0.471396744, 0.492898196, 0.514102757, 0.534997642,
+  0.555570245, 0.575808167, 0.59569931, 0.615231574, 0.634393275, 0.653172851, 0.671558976, 0.689540565,
+  0.707106769, 0.724247098, 0.740951121, 0.757208824, 0.773010433, 0.78834641, 0.803207517, 0.817584813,
+  0.831469595, 0.84485358, 0.857728601, 0.870086968, 0.881921291, 0.893224299, 0.903989315, 0.914209783,
+  0.923879504, 0.932992816, 0.941544056, 0.949528158, 0.956940353, 0.963776052, 0.970031261, 0.975702107,
+  0.980785251, 0.985277653, 0.989176512, 0.992479563, 0.99518472, 0.997290432, 0.99879545, 0.999698818,
+  1
+  };
+#endif
+
+// Computes the sine and cosine of an angle in radians together. With USE_TRIG_LOOKUP_TABLE, the
+// angle is split into the nearest table angle and a remainder of at most pi/256, which is applied
+// by the angle sum identities with short series. The result is within a few float ulp of libm.
+void sin_cos_f(float angle, float *sin_value, float *cos_value)
+{
+  #ifdef USE_TRIG_LOOKUP_TABLE
+    int32_t n = lround(angle*SIN_TABLE_STEPS_PER_RAD);
+    float d = (angle - n*SIN_TABLE_STEP_HI) - n*SIN_TABLE_STEP_LO;
+    uint8_t idx = n & (4*SIN_TABLE_QUADRANT-1); // Table angle in [0,2*pi)
+    uint8_t k = idx & (SIN_TABLE_QUADRANT-1);
+    float sin_k = pgm_read_float(&sin_table[k]);
+    float cos_k = pgm_read_float(&sin_table[SIN_TABLE_QUADRANT-k]);
+    float sin_n, cos_n;
+    switch (idx/SIN_TABLE_QUADRANT) {
+      case 0: sin_n = sin_k; cos_n = cos_k; break;
+      case 1: sin_n = cos_k; cos_n = -sin_k; break;
+      case 2: sin_n = -sin_k; cos_n = -cos_k; break;
+      default: sin_n = -cos_k; cos_n = sin_k;
+    }
+    float d_sqr = d*d;
+    float sin_d = d*(1.0f-d_sqr*(1.0f/6.0f)); // Truncation error below 3e-12
+    float cos_d = 1.0f-0.5f*d_sqr; // Truncation error below 1e-9
+    *sin_value = sin_n*cos_d + cos_n*sin_d;
+    *cos_value = cos_n*cos_d - sin_n*sin_d;
+  #else
+    *sin_value = sin(angle);
+    *cos_value = cos(angle);
+  #endif
+}
+
+
 float convert_delta_vector_to_unit_vector(float *vector)
 {
   uint8_t idx, j;
@@ -188,6 +239,18 @@ float convert_delta_vector_to_unit_vector(float *vector)
 }
 
 
+uint8_t crc8_update(uint8_t crc, uint8_t data)
+{
+  uint8_t idx;
+  crc ^= data;
+  for (idx=0; idx<8; idx++) {
+    if (crc & 0x80) { crc = (crc << 1) ^ 0x07; }
+    else { crc <<= 1; }
+  }
+  return(crc);
+}
+
+
 float limit_value_by_axis_maximum(float *max_value, float *unit_vec)
 {
   uint8_t idx;
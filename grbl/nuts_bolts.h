@@ -27,6 +27,7 @@
 #define true 1
 
 #define SOME_LARGE_VALUE 1.0E+38
+#define MAX_INT_DIGITS 8 // Maximum number of digits in int32 (and float)
 
 // CoreXY motor assignments. DO NOT ALTER.
 // NOTE: If the A and B motor axis bindings are changed, this effects the CoreXY equations.
@@ -64,6 +65,10 @@
 // a pointer to the result variable. Returns true when it succeeds
 uint8_t read_float(char *line, uint8_t *char_counter, float *float_ptr);
 
+// Converts the digits of a decimal number, read into an integer and a power of ten exponent
+// by read_float(), into a float.
+float decimal_to_float(uint32_t intval, int8_t exp, uint8_t isnegative);
+
 // Non-blocking delay function used for general operation and suspend features.
 void delay_sec(float seconds, uint8_t mode);
 
@@ -76,6 +81,12 @@ void delay_us(uint32_t us);
 // Computes hypotenuse, avoiding avr-gcc's bloated version and the extra error checking.
 float hypot_f(float x, float y);
 
+// Computes the sine and cosine of an angle in radians. Uses the lookup table with USE_TRIG_LOOKUP_TABLE.
+void sin_cos_f(float angle, float *sin_value, float *cos_value);
+
+// Updates a CRC-8 (polynomial 0x07, as in ATM HEC and SMBus) with the next data byte. Starts at 0.
+uint8_t crc8_update(uint8_t crc, uint8_t data);
+
 float convert_delta_vector_to_unit_vector(float *vector);
 float limit_value_by_axis_maximum(float *max_value, float *unit_vec);
 
@@ -30,6 +30,20 @@ static uint8_t block_buffer_head;     // Index of the next block to be pushed
 static uint8_t next_buffer_head;      // Index of the next buffer head
 static uint8_t block_buffer_planned;  // Index of the optimally planned block
 
+// Deceleration ramp after the planned block. See planner_recalculate_appended().
+#define PLANNER_RAMP_REBASE_RATIO 16.0 // Fold the ramp offset into the blocks beyond this entry speed ratio.
+static float ramp_offset;                  // Added to the stored entry speed of every block in the ramp.
+static uint8_t ramp_cap[BLOCK_BUFFER_SIZE]; // Ring of block indices that may next reach their max entry speed.
+static uint8_t ramp_cap_tail;
+static uint8_t ramp_cap_head;
+
+// Axis step counts of a system motion block, when they exceed the 16-bit planner block step counts.
+static uint32_t system_block_steps[N_AXIS];
+
+// Motions are split into blocks of at most this many steps per axis. Leaves room below the block
+// step count limit for the rounding of the intermediate targets to steps.
+#define PLAN_SPLIT_STEPS (PLAN_BLOCK_MAX_STEPS-0xFF)
+
 // Define planner variables
 typedef struct {
   int32_t position[N_AXIS];          // The planner position of the tool in absolute steps. Kept separate
@@ -59,6 +73,98 @@ static uint8_t plan_prev_block_index(uint8_t block_index)
 }
 
 
+// Quantizes a positive float rate limit to 16 bits for block storage, by keeping the upper half of its
+// IEEE-754 representation. The truncated mantissa always rounds the limit down, by less than 0.8%.
+static uint16_t plan_quantize(float value)
+{
+  union { float f; uint32_t u; } v;
+  v.f = value;
+  return(v.u >> 16);
+}
+
+
+// Restores a rate limit quantized by plan_quantize().
+static float plan_dequantize(uint16_t value)
+{
+  union { float f; uint32_t u; } v;
+  v.u = (uint32_t)value << 16;
+  return(v.f);
+}
+
+
+// Returns the highest speed (sqr) at one end of a block that it can ramp to or from the speed (sqr) at
+// its other end, over its length. The ramps are symmetric, so this holds for either end.
+// NOTE: A jerk-limited ramp from a lower speed has more time to cover the block, so below some speed
+// it reaches higher. The planner relies on entry speeds only rising as its exit speeds rise, so the
+// speeds below that return the lowest such peak instead, which any of them can still reach.
+static float planner_ramp_speed_sqr(plan_block_t *block, float speed_sqr)
+{
+  #ifdef ENABLE_S_CURVE_ACCELERATION
+    // The peak v+dv = d/T + dv/2 is lowest for the ramp time T where dv'(T) = 2*d/T^2.
+    float jerk = plan_get_block_jerk(block);
+    float jerk_time = block->acceleration/jerk;
+    float time = cbrt(4.0*block->millimeters/jerk);
+    float delta_speed;
+    if (time <= 2.0*jerk_time) { delta_speed = 0.25*jerk*time*time; }
+    else {
+      time = sqrt(2.0*block->millimeters/block->acceleration);
+      delta_speed = block->acceleration*(time-jerk_time);
+    }
+    float speed = block->millimeters/time - 0.5*delta_speed;
+    if (speed_sqr < speed*speed) { speed += delta_speed; }
+    else { speed = plan_get_ramp_speed(block, sqrt(speed_sqr), block->millimeters, true); }
+    return(speed*speed);
+  #elif defined(ENABLE_INPUT_SHAPING)
+    // The peak is lowest from half the acceleration times the shaper time, or from the speed that
+    // covers the block within the shaper time, if lower. Faster ramps run unshaped and reach higher.
+    float speed = sqrt(speed_sqr);
+    float shaper_time = st_get_input_shaper_time();
+    float lowest_speed = 0.5*block->acceleration*shaper_time;
+    if ((speed < lowest_speed) && (speed*shaper_time < block->millimeters)) {
+      speed = min(lowest_speed, block->millimeters/shaper_time);
+    }
+    speed = plan_get_ramp_speed(block, speed, block->millimeters, true);
+    return(speed*speed);
+  #else
+    return(speed_sqr + 2*block->acceleration*block->millimeters);
+  #endif
+}
+
+
+// Forward plans the acceleration curve from the planned pointer up to the given block. Also scans for
+// optimal plan breakpoints and appropriately updates the planned pointer.
+static void planner_forward_plan(uint8_t end_index)
+{
+  plan_block_t *current;
+  plan_block_t *next = &block_buffer[block_buffer_planned]; // Begin at buffer planned pointer
+  uint8_t block_index = plan_next_block_index(block_buffer_planned);
+  float entry_speed_sqr;
+  while (block_index != end_index) {
+    current = next;
+    next = &block_buffer[block_index];
+
+    // Any acceleration detected in the forward pass automatically moves the optimal planned
+    // pointer forward, since everything before this is all optimal. In other words, nothing
+    // can improve the plan from the buffer tail to the planned pointer by logic.
+    if (current->entry_speed_sqr < next->entry_speed_sqr) {
+      entry_speed_sqr = planner_ramp_speed_sqr(current, current->entry_speed_sqr);
+      // If true, current block is full-acceleration and we can move the planned pointer forward.
+      if (entry_speed_sqr < next->entry_speed_sqr) {
+        next->entry_speed_sqr = entry_speed_sqr; // Always <= max_entry_speed_sqr. Backward pass sets this.
+        block_buffer_planned = block_index; // Set optimal plan pointer.
+      }
+    }
+
+    // Any block set at its maximum entry speed also creates an optimal plan up to this
+    // point in the buffer. When the plan is bracketed by either the beginning of the
+    // buffer and a maximum entry speed or two maximum entry speeds, every block in between
+    // cannot logically be further improved. Hence, we don't have to recompute them anymore.
+    if (next->entry_speed_sqr == next->max_entry_speed_sqr) { block_buffer_planned = block_index; }
+    block_index = plan_next_block_index( block_index );
+  }
+}
+
+
 /*                            PLANNER SPEED DEFINITION
                                      +--------+   <- current->nominal_speed
                                     /          \
@@ -122,6 +228,9 @@ static uint8_t plan_prev_block_index(uint8_t block_index)
   for the planner to compute over. It also increases the number of computations the planner has to perform
   to compute an optimal plan, so select carefully. The Arduino 328p memory is already maxed out, but future
   ARM versions should have enough memory and speed for look-ahead blocks numbering up to a hundred or more.
+  On the Mega, blocks are packed to 16-bit step counts, a direction bitmask and 16-bit rate limits, so 80 of
+  them fit with about 2KB of RAM left for the stack. Appended blocks are planned incrementally, so a larger
+  buffer does not slow down planning new incoming motions.
 
 */
 static void planner_recalculate()
@@ -140,7 +249,7 @@ static void planner_recalculate()
   plan_block_t *current = &block_buffer[block_index];
 
   // Calculate maximum entry speed for last block in buffer, where the exit speed is always zero.
-  current->entry_speed_sqr = min( current->max_entry_speed_sqr, 2*current->acceleration*current->millimeters);
+  current->entry_speed_sqr = min( current->max_entry_speed_sqr, planner_ramp_speed_sqr(current, 0.0));
 
   block_index = plan_prev_block_index(block_index);
   if (block_index == block_buffer_planned) { // Only two plannable blocks in buffer. Reverse pass complete.
@@ -157,7 +266,7 @@ static void planner_recalculate()
 
       // Compute maximum entry speed decelerating over the current block from its exit speed.
       if (current->entry_speed_sqr != current->max_entry_speed_sqr) {
-        entry_speed_sqr = next->entry_speed_sqr + 2*current->acceleration*current->millimeters;
+        entry_speed_sqr = planner_ramp_speed_sqr(current, next->entry_speed_sqr);
         if (entry_speed_sqr < current->max_entry_speed_sqr) {
           current->entry_speed_sqr = entry_speed_sqr;
         } else {
@@ -168,33 +277,153 @@ static void planner_recalculate()
   }
 
   // Forward Pass: Forward plan the acceleration curve from the planned pointer onward.
-  // Also scans for optimal plan breakpoints and appropriately updates the planned pointer.
-  next = &block_buffer[block_buffer_planned]; // Begin at buffer planned pointer
-  block_index = plan_next_block_index(block_buffer_planned);
+  planner_forward_plan(block_buffer_head);
+}
+
+
+/*                    INCREMENTAL PLANNING OF APPENDED BLOCKS
+
+  When streaming, planner_recalculate() re-plans every block after the planned pointer for each new
+  block. With dense programs of short line segments, that is often the whole buffer: the blocks are
+  too short to reach their nominal or junction speeds, so none of them bracket the plan. The work per
+  block grows with BLOCK_BUFFER_SIZE, and so does the time to parse and plan a line.
+
+  After any plan, each block after the planned pointer is decelerating at full deceleration towards
+  the complete stop at the end of the buffer. Its entry speed is not capped by its maximum entry speed
+  (or the planned pointer would have moved onto it), nor lowered by the forward pass (same again). So
+  its entry speed is exactly its exit speed plus 2*acceleration*millimeters. Appending a block raises
+  the exit speed of the old last block, and with it the entry speed of every block on this ramp, by the
+  same amount. Instead of walking the ramp, these blocks keep their entry speed relative to ramp_offset,
+  which is raised once per new block.
+
+  A ramp block ends the ramp once its raised entry speed reaches its maximum entry speed. Since the
+  offset only rises, the blocks that can be reached first are kept in the ramp_cap ring, ordered by
+  block index and by the offset at which they reach their cap. A block is dropped from the ring when a
+  later block will reach its cap no later than it, as the plan up to that later block is then final
+  anyway. Once blocks reach their caps, the ramp up to the last of them is planned as before and the
+  planned pointer moves onto it. Otherwise, only the start of the ramp is forward planned from the
+  planned block, where the machine may not be able to accelerate to the raised entry speeds.
+
+  Every block is thus planned in full once, when the planned pointer passes it. The plan is the same
+  as planner_recalculate() computes, up to float round-off, at a cost per new block that no longer
+  depends on the number of blocks in the buffer.
+
+  Shaped ramps don't add up in speed squared like this, so with ENABLE_S_CURVE_ACCELERATION or
+  ENABLE_INPUT_SHAPING, appended blocks are planned by planner_recalculate().
+*/
+
+#ifndef SHAPED_RAMPS
+// Returns the ramp offset at which the given ramp block reaches its maximum entry speed.
+static float planner_ramp_cap_offset(uint8_t block_index)
+{
+  return(block_buffer[block_index].max_entry_speed_sqr - block_buffer[block_index].entry_speed_sqr);
+}
+
+
+// Adds the newest ramp block to the ramp_cap ring, dropping the blocks it reaches its cap before.
+static void planner_ramp_push(uint8_t block_index)
+{
+  float cap_offset = planner_ramp_cap_offset(block_index);
+  while (ramp_cap_head != ramp_cap_tail) {
+    uint8_t cap_index = plan_prev_block_index(ramp_cap_head);
+    if (planner_ramp_cap_offset(ramp_cap[cap_index]) < cap_offset) { break; }
+    ramp_cap_head = cap_index;
+  }
+  ramp_cap[ramp_cap_head] = block_index;
+  ramp_cap_head = plan_next_block_index(ramp_cap_head);
+}
+
+
+#endif
+
+
+// Adds the ramp offset into the stored entry speeds of the ramp blocks, starting with the given block.
+static void planner_ramp_rebase(uint8_t block_index)
+{
   while (block_index != block_buffer_head) {
-    current = next;
-    next = &block_buffer[block_index];
+    block_buffer[block_index].entry_speed_sqr += ramp_offset;
+    block_index = plan_next_block_index(block_index);
+  }
+  ramp_offset = 0.0;
+}
 
-    // Any acceleration detected in the forward pass automatically moves the optimal planned
-    // pointer forward, since everything before this is all optimal. In other words, nothing
-    // can improve the plan from the buffer tail to the planned pointer by logic.
-    if (current->entry_speed_sqr < next->entry_speed_sqr) {
-      entry_speed_sqr = current->entry_speed_sqr + 2*current->acceleration*current->millimeters;
-      // If true, current block is full-acceleration and we can move the planned pointer forward.
-      if (entry_speed_sqr < next->entry_speed_sqr) {
-        next->entry_speed_sqr = entry_speed_sqr; // Always <= max_entry_speed_sqr. Backward pass sets this.
-        block_buffer_planned = block_index; // Set optimal plan pointer.
-      }
+
+// Moves the planned pointer onto the first ramp block, whose entry speed is now final.
+static void planner_ramp_pop(uint8_t block_index)
+{
+  block_buffer[block_index].entry_speed_sqr += ramp_offset;
+  if ((ramp_cap_tail != ramp_cap_head) && (ramp_cap[ramp_cap_tail] == block_index)) {
+    ramp_cap_tail = plan_next_block_index(ramp_cap_tail);
+  }
+  block_buffer_planned = block_index;
+  if (plan_next_block_index(block_index) == block_buffer_head) { ramp_offset = 0.0; } // Ramp empty.
+}
+
+
+#ifndef SHAPED_RAMPS
+// Updates the plan for the block just appended at the head of the buffer, incrementally.
+// NOTE: Feed holds and overrides re-plan the whole buffer through planner_recalculate() instead.
+static void planner_recalculate_appended()
+{
+  uint8_t block_index = plan_prev_block_index(block_buffer_head);
+
+  // Bail. Can't do anything with only one plan-able block.
+  if (block_index == block_buffer_planned) { return; }
+
+  // The exit speed of the first plannable block always changes. If it's the tail, notify the stepper.
+  if (block_buffer_planned == block_buffer_tail) { st_update_plan_block_parameters(); }
+
+  // Plan the new block from a complete stop and raise the ramp before it by its entry speed.
+  plan_block_t *current = &block_buffer[block_index];
+  float entry_speed_sqr = min( current->max_entry_speed_sqr, 2*current->acceleration*current->millimeters);
+  ramp_offset += entry_speed_sqr;
+  current->entry_speed_sqr = entry_speed_sqr-ramp_offset;
+  planner_ramp_push(block_index);
+
+  // Find the last block that has reached its maximum entry speed, if any. Reverse plan the ramp from
+  // its maximum entry speed, then forward plan up to it, as planner_recalculate() does.
+  if (planner_ramp_cap_offset(ramp_cap[ramp_cap_tail]) <= ramp_offset) {
+    uint8_t capped_index;
+    do {
+      capped_index = ramp_cap[ramp_cap_tail];
+      ramp_cap_tail = plan_next_block_index(ramp_cap_tail);
+    } while ((ramp_cap_tail != ramp_cap_head) && (planner_ramp_cap_offset(ramp_cap[ramp_cap_tail]) <= ramp_offset));
+
+    plan_block_t *next = &block_buffer[capped_index];
+    next->entry_speed_sqr = next->max_entry_speed_sqr;
+    block_index = plan_prev_block_index(capped_index);
+    while (block_index != block_buffer_planned) {
+      current = &block_buffer[block_index];
+      entry_speed_sqr = next->entry_speed_sqr + 2*current->acceleration*current->millimeters;
+      current->entry_speed_sqr = min( current->max_entry_speed_sqr, entry_speed_sqr);
+      next = current;
+      block_index = plan_prev_block_index(block_index);
     }
+    block_index = plan_next_block_index(capped_index);
+    planner_forward_plan(block_index);
+    block_buffer_planned = capped_index; // Ramp now starts after the capped block.
+    if (block_index == block_buffer_head) { ramp_offset = 0.0; }
+  }
 
-    // Any block set at its maximum entry speed also creates an optimal plan up to this
-    // point in the buffer. When the plan is bracketed by either the beginning of the
-    // buffer and a maximum entry speed or two maximum entry speeds, every block in between
-    // cannot logically be further improved. Hence, we don't have to recompute them anymore.
-    if (next->entry_speed_sqr == next->max_entry_speed_sqr) { block_buffer_planned = block_index; }
-    block_index = plan_next_block_index( block_index );
+  // Forward plan the start of the ramp. Further in, the ramp is always decelerating.
+  block_index = plan_next_block_index(block_buffer_planned);
+  while (block_index != block_buffer_head) {
+    current = &block_buffer[block_buffer_planned];
+    entry_speed_sqr = current->entry_speed_sqr + 2*current->acceleration*current->millimeters;
+    if (entry_speed_sqr >= block_buffer[block_index].entry_speed_sqr+ramp_offset) { break; }
+    planner_ramp_pop(block_index);
+    block_buffer[block_index].entry_speed_sqr = entry_speed_sqr; // Full-acceleration block.
+    block_index = plan_next_block_index(block_index);
+  }
+
+  // Keep the offset small against the entry speeds it is added to, so no precision is lost.
+  if (block_index != block_buffer_head) {
+    if (ramp_offset > PLANNER_RAMP_REBASE_RATIO*(block_buffer[block_index].entry_speed_sqr+ramp_offset)) {
+      planner_ramp_rebase(block_index);
+    }
   }
 }
+#endif
 
 
 void plan_reset()
@@ -210,6 +439,9 @@ void plan_reset_buffer()
   block_buffer_head = 0; // Empty = tail
   next_buffer_head = 1; // plan_next_block_index(block_buffer_head)
   block_buffer_planned = 0; // = block_buffer_tail;
+  ramp_offset = 0.0;
+  ramp_cap_tail = 0;
+  ramp_cap_head = 0;
 }
 
 
@@ -218,7 +450,10 @@ void plan_discard_current_block()
   if (block_buffer_head != block_buffer_tail) { // Discard non-empty buffer.
     uint8_t block_index = plan_next_block_index( block_buffer_tail );
     // Push block_buffer_planned pointer, if encountered.
-    if (block_buffer_tail == block_buffer_planned) { block_buffer_planned = block_index; }
+    if (block_buffer_tail == block_buffer_planned) {
+      if (block_index == block_buffer_head) { block_buffer_planned = block_index; }
+      else { planner_ramp_pop(block_index); } // Ramp block entry speed is final. Store it.
+    }
     block_buffer_tail = block_index;
   }
 }
@@ -231,6 +466,19 @@ plan_block_t *plan_get_system_motion_block()
 }
 
 
+// Copies the axis step counts of a block. Counts beyond the 16-bit block range only occur with the
+// system motion block, and are kept in the overflow record.
+void plan_get_block_steps(plan_block_t *block, uint32_t *steps)
+{
+  if (block->step_event_count > PLAN_BLOCK_MAX_STEPS) {
+    memcpy(steps, system_block_steps, sizeof(system_block_steps));
+  } else {
+    uint8_t idx;
+    for (idx=0; idx<N_AXIS; idx++) { steps[idx] = block->steps[idx]; }
+  }
+}
+
+
 // Returns address of first planner block, if available. Called by various main program functions.
 plan_block_t *plan_get_current_block()
 {
@@ -243,6 +491,9 @@ float plan_get_exec_block_exit_speed_sqr()
 {
   uint8_t block_index = plan_next_block_index(block_buffer_tail);
   if (block_index == block_buffer_head) { return( 0.0 ); }
+  if (block_buffer_tail == block_buffer_planned) { // Next block is on the deceleration ramp.
+    return( block_buffer[block_index].entry_speed_sqr + ramp_offset );
+  }
   return( block_buffer[block_index].entry_speed_sqr );
 }
 
@@ -263,13 +514,136 @@ float plan_compute_profile_nominal_speed(plan_block_t *block)
   if (block->condition & PL_COND_FLAG_RAPID_MOTION) { nominal_speed *= (0.01*sys.r_override); }
   else {
     if (!(block->condition & PL_COND_FLAG_NO_FEED_OVERRIDE)) { nominal_speed *= (0.01*sys.f_override); }
-    if (nominal_speed > block->rapid_rate) { nominal_speed = block->rapid_rate; }
+    float rapid_rate = plan_dequantize(block->rapid_rate_q);
+    if (nominal_speed > rapid_rate) { nominal_speed = rapid_rate; }
   }
   if (nominal_speed > MINIMUM_FEED_RATE) { return(nominal_speed); }
   return(MINIMUM_FEED_RATE);
 }
 
 
+#ifdef ENABLE_S_CURVE_ACCELERATION
+  float plan_get_block_jerk(plan_block_t *block)
+  {
+    return(plan_dequantize(block->jerk_q));
+  }
+
+
+  /*                            JERK-LIMITED RAMPS
+    A ramp raises its acceleration at the block jerk limit J, holds the block acceleration a and lowers
+    it again at J. A speed change dv of at least a^2/J takes T = dv/a + a/J, i.e. the trapezoidal ramp
+    time stretched by a/J. Smaller speed changes never reach a and take T = 2*sqrt(dv/J). The ramp is
+    symmetric, so it covers T*(v0+v1)/2 between the speeds v0 and v1 at its ends, either way. The planner
+    and the step segment generator both plan the ramps with these times, so the S-curves they execute
+    stay within the acceleration and jerk limits.
+  */
+  float plan_get_ramp_distance(plan_block_t *block, float speed_0, float speed_1)
+  {
+    float jerk = plan_get_block_jerk(block);
+    float delta_speed = fabs(speed_1-speed_0);
+    float time;
+    if (delta_speed*jerk >= block->acceleration*block->acceleration) {
+      time = delta_speed/block->acceleration + block->acceleration/jerk;
+    } else {
+      time = 2.0*sqrt(delta_speed/jerk);
+    }
+    return(0.5*time*(speed_0+speed_1));
+  }
+
+
+  // Inverts plan_get_ramp_distance(). Ramps reaching the block acceleration solve in closed form. The
+  // others solve distance = t*(2*speed +/- J*t^2) for half their time t with a few Newton steps, which
+  // converge monotonically from the side that keeps the speed change within the distance.
+  // NOTE: Decelerating ramps are longest a bit short of a full stop, so a slightly larger speed change
+  // may already fit within the distance. The lowest speed found is the end of the first one that does.
+  float plan_get_ramp_speed(plan_block_t *block, float speed, float distance, uint8_t is_accelerating)
+  {
+    if (distance <= 0.0) { return(speed); }
+    float jerk = plan_get_block_jerk(block);
+    float jerk_time = block->acceleration/jerk; // Time to raise the acceleration to a (min)
+    float full_delta = block->acceleration*jerk_time; // Smallest speed change reaching a, a^2/J (mm/min)
+    float time;
+    uint8_t idx;
+    if (is_accelerating) {
+      if (distance >= jerk_time*(2.0*speed+full_delta)) {
+        // Solves (v1+a^2/2J)^2 = (v0-a^2/2J)^2 + 2*a*distance.
+        speed -= 0.5*full_delta;
+        return(sqrt(speed*speed + 2.0*block->acceleration*distance) - 0.5*full_delta);
+      }
+      // Start above the solution, where the ramp would cover the distance by either term alone.
+      time = cbrt(distance/jerk);
+      if (time > jerk_time) { time = jerk_time; }
+      if (speed*time > 0.5*distance) { time = 0.5*distance/speed; }
+      for (idx=0; idx<3; idx++) {
+        time -= (time*(2.0*speed + jerk*time*time) - distance)/(2.0*speed + 3.0*jerk*time*time);
+      }
+      time = distance/(2.0*speed + jerk*time*time); // Below the solution, if Newton hasn't quite converged.
+      return(speed + jerk*time*time);
+    }
+    if (plan_get_ramp_distance(block, speed, 0.0) <= distance) { return(0.0); } // Stops within distance.
+    if ((speed >= 1.5*full_delta) && (distance >= jerk_time*(2.0*speed-full_delta))) {
+      // Solves (v1-a^2/2J)^2 = (v0+a^2/2J)^2 - 2*a*distance.
+      speed += 0.5*full_delta;
+      speed = speed*speed - 2.0*block->acceleration*distance;
+      if (speed < 0.0) { speed = 0.0; }
+      return(sqrt(speed) + 0.5*full_delta);
+    }
+    // Start below the solution, as if covering the distance at the initial speed.
+    time = 0.5*distance/speed;
+    for (idx=0; idx<3; idx++) {
+      time -= (time*(2.0*speed - jerk*time*time) - distance)/(2.0*speed - 3.0*jerk*time*time);
+    }
+    return(speed - jerk*time*time);
+  }
+#endif
+
+
+#ifdef ENABLE_INPUT_SHAPING
+  /*                            SHAPED RAMPS
+    The input shaper convolves the constant acceleration a of a ramp with its impulses, which adds the
+    shaper time Ts to the ramp without raising its acceleration. A speed change dv then takes
+    T = dv/a + Ts. The step segment generator centers the shaped acceleration in the ramp, so it covers
+    T*(v0+v1)/2 between the speeds v0 and v1 at its ends, either way. A block covered within Ts at the
+    speed a ramp starts from is too short for the shaper, and ramps it unshaped, in T = dv/a.
+  */
+  float plan_get_ramp_distance(plan_block_t *block, float speed_0, float speed_1)
+  {
+    float delta_speed = fabs(speed_1-speed_0);
+    if (delta_speed == 0.0) { return(0.0); }
+    return(0.5*(delta_speed/block->acceleration + st_get_input_shaper_time())*(speed_0+speed_1));
+  }
+
+
+  // Inverts plan_get_ramp_distance(), which is quadratic in the speed at the other end of the ramp.
+  float plan_get_ramp_speed(plan_block_t *block, float speed, float distance, uint8_t is_accelerating)
+  {
+    if (distance <= 0.0) { return(speed); }
+    float shaper_time = st_get_input_shaper_time();
+    float shaper_speed = 0.5*block->acceleration*shaper_time; // Half the speed change over Ts (mm/min)
+    float speed_sqr;
+    if (is_accelerating) {
+      if (speed*shaper_time > distance) { // Too short for the shaper.
+        return(sqrt(speed*speed + 2.0*block->acceleration*distance));
+      }
+      // Solves (v1+a*Ts/2)^2 = (v0-a*Ts/2)^2 + 2*a*distance.
+      speed_sqr = speed-shaper_speed;
+      return(sqrt(speed_sqr*speed_sqr + 2.0*block->acceleration*distance) - shaper_speed);
+    }
+    if (plan_get_ramp_distance(block, speed, 0.0) <= distance) { return(0.0); } // Stops within distance.
+    if ((speed*shaper_time > distance) || (speed <= shaper_speed)) { // Too short for the shaper.
+      speed_sqr = speed*speed - 2.0*block->acceleration*distance;
+      if (speed_sqr < 0.0) { return(0.0); }
+      return(sqrt(speed_sqr));
+    }
+    // Solves (v1-a*Ts/2)^2 = (v0+a*Ts/2)^2 - 2*a*distance.
+    speed_sqr = speed+shaper_speed;
+    speed_sqr = speed_sqr*speed_sqr - 2.0*block->acceleration*distance;
+    if (speed_sqr < 0.0) { speed_sqr = 0.0; } // Float round-off.
+    return(sqrt(speed_sqr) + shaper_speed);
+  }
+#endif
+
+
 // Computes and updates the max entry speed (sqr) of the block, based on the minimum of the junction's
 // previous and current nominal speeds and max junction speed.
 static void plan_compute_profile_parameters(plan_block_t *block, float nominal_speed, float prev_nominal_speed)
@@ -277,7 +651,8 @@ static void plan_compute_profile_parameters(plan_block_t *block, float nominal_s
   // Compute the junction maximum entry based on the minimum of the junction speed and neighboring nominal speeds.
   if (nominal_speed > prev_nominal_speed) { block->max_entry_speed_sqr = prev_nominal_speed*prev_nominal_speed; }
   else { block->max_entry_speed_sqr = nominal_speed*nominal_speed; }
-  if (block->max_entry_speed_sqr > block->max_junction_speed_sqr) { block->max_entry_speed_sqr = block->max_junction_speed_sqr; }
+  float max_junction_speed_sqr = plan_dequantize(block->max_junction_speed_sqr_q);
+  if (block->max_entry_speed_sqr > max_junction_speed_sqr) { block->max_entry_speed_sqr = max_junction_speed_sqr; }
 }
 
 
@@ -299,6 +674,61 @@ void plan_update_velocity_profile_parameters()
 }
 
 
+#ifdef ENABLE_NATIVE_ARCS
+  // Stores the arc geometry in the block and computes its path vectors. On entry, unit_vec holds the
+  // line distances of all axes (mm). Replaces it with the unit tangent at the arc start, and sets the
+  // unit tangent at the arc end and the rate limiting vector. The plane axes of the limiting vector
+  // take the full plane share of the path, which they reach where the tangent lines up with the axis.
+  // Returns the helical arc length (mm).
+  static float plan_compute_arc_vectors(plan_block_t *block, plan_arc_data_t *arc_data, float *unit_vec,
+                                        float *exit_unit_vec, float *limit_vec)
+  {
+    float travel = arc_data->travel;
+    float radius = hypot_f(arc_data->start[0], arc_data->start[1]);
+    float plane_mm = fabs(travel)*radius;
+    float sin_t, cos_t;
+    sin_cos_f(travel, &sin_t, &cos_t);
+    float end_0 = arc_data->start[0]*cos_t - arc_data->start[1]*sin_t; // Radius vector at the arc end
+    float end_1 = arc_data->start[0]*sin_t + arc_data->start[1]*cos_t;
+    uint8_t idx;
+    for (idx=0; idx<N_AXIS; idx++) {
+      // Tangents are the derivatives of the radius vector over the arc, i.e. travel times its normal.
+      if (arc_data->axis_0_mask & bit(idx)) {
+        unit_vec[idx] = -travel*arc_data->start[1];
+        exit_unit_vec[idx] = -travel*end_1;
+        limit_vec[idx] = plane_mm;
+      } else if (arc_data->axis_1_mask & bit(idx)) {
+        unit_vec[idx] = travel*arc_data->start[0];
+        exit_unit_vec[idx] = travel*end_0;
+        limit_vec[idx] = plane_mm;
+      } else {
+        exit_unit_vec[idx] = unit_vec[idx];
+        limit_vec[idx] = unit_vec[idx];
+      }
+    }
+    float millimeters = convert_delta_vector_to_unit_vector(unit_vec);
+    convert_delta_vector_to_unit_vector(exit_unit_vec);
+    for (idx=0; idx<N_AXIS; idx++) { limit_vec[idx] /= millimeters; }
+
+    // Trace the arc with the chords mc_arc() would plan. Their end points are on the arc, which lie
+    // within the arc tolerance of it.
+    float chords = 1.0;
+    if (radius > settings.arc_tolerance) {
+      chords = floor(0.5*plane_mm/sqrt(settings.arc_tolerance*(2*radius - settings.arc_tolerance)));
+      if (chords < 1.0) { chords = 1.0; }
+      else if (chords > 0xFFFF) { chords = 0xFFFF; }
+    }
+    block->arc_chords = chords;
+    block->arc_axis_0_mask = arc_data->axis_0_mask;
+    block->arc_axis_1_mask = arc_data->axis_1_mask;
+    block->arc_start[0] = arc_data->start[0];
+    block->arc_start[1] = arc_data->start[1];
+    block->arc_travel = travel;
+    return(millimeters);
+  }
+#endif
+
+
 /* Add a new linear movement to the buffer. target[N_AXIS] is the signed, absolute target position
    in millimeters. Feed rate specifies the speed of the motion. If feed rate is inverted, the feed
    rate is taken to mean "frequency" and would complete the operation in 1/feed_rate minutes.
@@ -312,8 +742,13 @@ void plan_update_velocity_profile_parameters()
    The system motion condition tells the planner to plan a motion in the always unused block buffer
    head. It avoids changing the planner state and preserves the buffer to ensure subsequent gcode
    motions are still planned correctly, while the stepper module only points to the block buffer head
-   to execute the special system motion. */
+   to execute the special system motion.
+   With native arcs, arc blocks are planned here as well, with arc_data set. NULL for line motions. */
+#ifdef ENABLE_NATIVE_ARCS
+static uint8_t plan_buffer_motion(float *target, plan_line_data_t *pl_data, plan_arc_data_t *arc_data)
+#else
 uint8_t plan_buffer_line(float *target, plan_line_data_t *pl_data)
+#endif
 {
   // Prepare and initialize new block. Copy relevant pl_data for block execution.
   plan_block_t *block = &block_buffer[block_buffer_head];
@@ -321,9 +756,13 @@ uint8_t plan_buffer_line(float *target, plan_line_data_t *pl_data)
   block->condition = pl_data->condition;
   block->spindle_speed = pl_data->spindle_speed;
   block->line_number = pl_data->line_number;
+  #ifdef ENABLE_INLINE_OUTPUT_CHANGES
+    block->digital_state = pl_data->digital_state;
+  #endif
 
   // Compute and store initial move distance data.
   int32_t target_steps[N_AXIS], position_steps[N_AXIS];
+  uint32_t steps[N_AXIS];
   float unit_vec[N_AXIS], delta_mm;
   uint8_t idx;
 
@@ -350,8 +789,8 @@ uint8_t plan_buffer_line(float *target, plan_line_data_t *pl_data)
   #ifdef COREXY
     target_steps[A_MOTOR] = lround(target[A_MOTOR]*settings.steps_per_mm[A_MOTOR]);
     target_steps[B_MOTOR] = lround(target[B_MOTOR]*settings.steps_per_mm[B_MOTOR]);
-    block->steps[A_MOTOR] = labs((target_steps[AXIS_1]-position_steps[AXIS_1]) + (target_steps[AXIS_2]-position_steps[AXIS_2]));
-    block->steps[B_MOTOR] = labs((target_steps[AXIS_1]-position_steps[AXIS_1]) - (target_steps[AXIS_2]-position_steps[AXIS_2]));
+    steps[A_MOTOR] = labs((target_steps[AXIS_1]-position_steps[AXIS_1]) + (target_steps[AXIS_2]-position_steps[AXIS_2]));
+    steps[B_MOTOR] = labs((target_steps[AXIS_1]-position_steps[AXIS_1]) - (target_steps[AXIS_2]-position_steps[AXIS_2]));
   #endif
 
   for (idx=0; idx<N_AXIS; idx++) {
@@ -361,9 +800,9 @@ uint8_t plan_buffer_line(float *target, plan_line_data_t *pl_data)
     #ifdef COREXY
       if ( !(idx == A_MOTOR) && !(idx == B_MOTOR) ) {
         target_steps[idx] = lround(target[idx]*settings.steps_per_mm[idx]);
-        block->steps[idx] = labs(target_steps[idx]-position_steps[idx]);
+        steps[idx] = labs(target_steps[idx]-position_steps[idx]);
       }
-      block->step_event_count = max(block->step_event_count, block->steps[idx]);
+      block->step_event_count = max(block->step_event_count, steps[idx]);
       if (idx == A_MOTOR) {
         delta_mm = (target_steps[AXIS_1]-position_steps[AXIS_1] + target_steps[AXIS_2]-position_steps[AXIS_2])/settings.steps_per_mm[idx];
       } else if (idx == B_MOTOR) {
@@ -373,29 +812,83 @@ uint8_t plan_buffer_line(float *target, plan_line_data_t *pl_data)
       }
     #else
       target_steps[idx] = lround(target[idx]*settings.steps_per_mm[idx]);
-      block->steps[idx] = labs(target_steps[idx]-position_steps[idx]);
-      block->step_event_count = max(block->step_event_count, block->steps[idx]);
+      steps[idx] = labs(target_steps[idx]-position_steps[idx]);
+      block->step_event_count = max(block->step_event_count, steps[idx]);
       delta_mm = (target_steps[idx] - position_steps[idx])/settings.steps_per_mm[idx];
     #endif
     unit_vec[idx] = delta_mm; // Store unit vector numerator
 
     // Set direction bits. Bit enabled always means direction is negative.
-    if (delta_mm < 0.0 ) { block->direction_bits[idx] |= get_direction_pin_mask(idx); }
+    if (delta_mm < 0.0 ) { block->direction_bits |= bit(idx); }
   }
 
   // Bail if this is a zero-length block. Highly unlikely to occur.
-  if (block->step_event_count == 0) { return(PLAN_EMPTY_BLOCK); }
+  #ifdef ENABLE_NATIVE_ARCS
+    // NOTE: A full circle arc has no net steps, but still a length.
+    if ((block->step_event_count == 0) && (arc_data == NULL)) { return(PLAN_EMPTY_BLOCK); }
+  #else
+    if (block->step_event_count == 0) { return(PLAN_EMPTY_BLOCK); }
+  #endif
+
+  // Store the step counts. Only the system motion block may exceed the block step count range, since
+  // mc_line() splits longer motions. Its counts go to the overflow record. See plan_get_block_steps().
+  if (block->step_event_count > PLAN_BLOCK_MAX_STEPS) { memcpy(system_block_steps, steps, sizeof(steps)); }
+  else {
+    for (idx=0; idx<N_AXIS; idx++) { block->steps[idx] = steps[idx]; }
+  }
 
   // Calculate the unit vector of the line move and the block maximum feed rate and acceleration scaled
   // down such that no individual axes maximum values are exceeded with respect to the line direction.
   // NOTE: This calculation assumes all axes are orthogonal (Cartesian) and works with ABC-axes,
   // if they are also orthogonal/independent. Operates on the absolute value of the unit vector.
-  block->millimeters = convert_delta_vector_to_unit_vector(unit_vec);
-  block->acceleration = limit_value_by_axis_maximum(settings.acceleration, unit_vec);
-  block->rapid_rate = limit_value_by_axis_maximum(settings.max_rate, unit_vec);
+  #ifdef ENABLE_NATIVE_ARCS
+    // Arc blocks limit their rates by the largest share of the path any axis may take along the arc,
+    // and join the neighboring blocks with their entry and exit tangents.
+    float exit_unit_vec[N_AXIS], limit_vec[N_AXIS];
+    if (arc_data != NULL) {
+      block->millimeters = plan_compute_arc_vectors(block, arc_data, unit_vec, exit_unit_vec, limit_vec);
+    } else {
+      block->millimeters = convert_delta_vector_to_unit_vector(unit_vec);
+      memcpy(limit_vec, unit_vec, sizeof(unit_vec));
+    }
+    block->acceleration = limit_value_by_axis_maximum(settings.acceleration, limit_vec);
+  #else
+    block->millimeters = convert_delta_vector_to_unit_vector(unit_vec);
+    block->acceleration = limit_value_by_axis_maximum(settings.acceleration, unit_vec);
+  #endif
+  #ifdef ENABLE_S_CURVE_ACCELERATION
+    block->jerk_q = plan_quantize(limit_value_by_axis_maximum(settings.jerk, unit_vec));
+  #endif
+  #ifdef ENABLE_NATIVE_ARCS
+    float rapid_rate = limit_value_by_axis_maximum(settings.max_rate, limit_vec);
+    if (arc_data != NULL) {
+      // Limit the arc speed to the junction speed of its chords, as if planned as lines, and to the speed
+      // where the centripetal acceleration reaches the block acceleration. Both in the arc plane.
+      // NOTE: The chord junction speed is computed as in plan_buffer_line(), where the junction angle is
+      // the chord angle. 1-cos(x/2) is taken as 2*sin(x/4)^2 for precision at small chord angles, and
+      // cos(x/2) from the double angle identity.
+      float radius = hypot_f(block->arc_start[0], block->arc_start[1]);
+      float plane_mm = fabs(block->arc_travel)*radius;
+      if (plane_mm > 0.0) {
+        float chord_angle = fabs(block->arc_travel)/block->arc_chords;
+        float sin_d4, cos_d4;
+        sin_cos_f(0.25*chord_angle, &sin_d4, &cos_d4);
+        float arc_rate_sqr = block->acceleration*radius;
+        if (sin_d4 > 0.0) {
+          float junction_rate_sqr = (block->acceleration*settings.junction_deviation*(cos_d4*cos_d4-sin_d4*sin_d4))/(2.0*sin_d4*sin_d4);
+          if (junction_rate_sqr < arc_rate_sqr) { arc_rate_sqr = junction_rate_sqr; }
+        }
+        float arc_rate = (block->millimeters/plane_mm)*sqrt(arc_rate_sqr); // Helical path rate
+        if (rapid_rate > arc_rate) { rapid_rate = arc_rate; }
+      }
+    }
+  #else
+    float rapid_rate = limit_value_by_axis_maximum(settings.max_rate, unit_vec);
+  #endif
+  block->rapid_rate_q = plan_quantize(rapid_rate);
 
   // Store programmed rate.
-  if (block->condition & PL_COND_FLAG_RAPID_MOTION) { block->programmed_rate = block->rapid_rate; }
+  if (block->condition & PL_COND_FLAG_RAPID_MOTION) { block->programmed_rate = rapid_rate; }
   else {
     block->programmed_rate = pl_data->feed_rate;
     if (block->condition & PL_COND_FLAG_INVERSE_TIME) { block->programmed_rate *= block->millimeters; }
@@ -407,7 +900,7 @@ uint8_t plan_buffer_line(float *target, plan_line_data_t *pl_data)
     // Initialize block entry speed as zero. Assume it will be starting from rest. Planner will correct this later.
     // If system motion, the system motion block always is assumed to start from rest and end at a complete stop.
     block->entry_speed_sqr = 0.0;
-    block->max_junction_speed_sqr = 0.0; // Starting from rest. Enforce start from zero velocity.
+    block->max_junction_speed_sqr_q = plan_quantize(0.0); // Starting from rest. Enforce start from zero velocity.
 
   } else {
     // Compute maximum allowable entry speed at junction by centripetal acceleration approximation.
@@ -440,21 +933,23 @@ uint8_t plan_buffer_line(float *target, plan_line_data_t *pl_data)
     }
 
     // NOTE: Computed without any expensive trig, sin() or acos(), by trig half angle identity of cos(theta).
+    float max_junction_speed_sqr;
     if (junction_cos_theta > 0.999999) {
       //  For a 0 degree acute junction, just set minimum junction speed.
-      block->max_junction_speed_sqr = MINIMUM_JUNCTION_SPEED*MINIMUM_JUNCTION_SPEED;
+      max_junction_speed_sqr = MINIMUM_JUNCTION_SPEED*MINIMUM_JUNCTION_SPEED;
     } else {
       if (junction_cos_theta < -0.999999) {
         // Junction is a straight line or 180 degrees. Junction speed is infinite.
-        block->max_junction_speed_sqr = SOME_LARGE_VALUE;
+        max_junction_speed_sqr = SOME_LARGE_VALUE;
       } else {
         convert_delta_vector_to_unit_vector(junction_unit_vec);
         float junction_acceleration = limit_value_by_axis_maximum(settings.acceleration, junction_unit_vec);
         float sin_theta_d2 = sqrt(0.5*(1.0-junction_cos_theta)); // Trig half angle identity. Always positive.
-        block->max_junction_speed_sqr = max( MINIMUM_JUNCTION_SPEED*MINIMUM_JUNCTION_SPEED,
+        max_junction_speed_sqr = max( MINIMUM_JUNCTION_SPEED*MINIMUM_JUNCTION_SPEED,
                        (junction_acceleration * settings.junction_deviation * sin_theta_d2)/(1.0-sin_theta_d2) );
       }
     }
+    block->max_junction_speed_sqr_q = plan_quantize(max_junction_speed_sqr);
   }
 
   // Block system motion from updating this data to ensure next g-code motion is computed correctly.
@@ -464,7 +959,12 @@ uint8_t plan_buffer_line(float *target, plan_line_data_t *pl_data)
     pl.previous_nominal_speed = nominal_speed;
 
     // Update previous path unit_vector and planner position.
-    memcpy(pl.previous_unit_vec, unit_vec, sizeof(unit_vec)); // pl.previous_unit_vec[] = unit_vec[]
+    #ifdef ENABLE_NATIVE_ARCS
+      if (arc_data != NULL) { memcpy(pl.previous_unit_vec, exit_unit_vec, sizeof(exit_unit_vec)); }
+      else { memcpy(pl.previous_unit_vec, unit_vec, sizeof(unit_vec)); }
+    #else
+      memcpy(pl.previous_unit_vec, unit_vec, sizeof(unit_vec)); // pl.previous_unit_vec[] = unit_vec[]
+    #endif
     memcpy(pl.position, target_steps, sizeof(target_steps)); // pl.position[] = target_steps[]
 
     // New block is all set. Update buffer head and next buffer head indices.
@@ -472,12 +972,35 @@ uint8_t plan_buffer_line(float *target, plan_line_data_t *pl_data)
     next_buffer_head = plan_next_block_index(block_buffer_head);
 
     // Finish up by recalculating the plan with the new block.
-    planner_recalculate();
+    #ifdef SHAPED_RAMPS
+      // Keep the exit speed of the block in progress. Re-planning it would restart its ramps midway from
+      // zero acceleration, which the rest of the block may not fit within the shaped ramp time.
+      if ((block_buffer_planned == block_buffer_tail) && st_is_block_in_progress()) {
+        block_buffer_planned = plan_next_block_index(block_buffer_tail);
+      }
+      planner_recalculate();
+    #else
+      planner_recalculate_appended();
+    #endif
   }
   return(PLAN_OK);
 }
 
 
+#ifdef ENABLE_NATIVE_ARCS
+  uint8_t plan_buffer_line(float *target, plan_line_data_t *pl_data)
+  {
+    return(plan_buffer_motion(target, pl_data, NULL));
+  }
+
+
+  uint8_t plan_buffer_arc(float *target, plan_line_data_t *pl_data, plan_arc_data_t *arc_data)
+  {
+    return(plan_buffer_motion(target, pl_data, arc_data));
+  }
+#endif
+
+
 // Reset the planner position vectors. Called by the system abort/initialization routine.
 void plan_sync_position()
 {
@@ -500,6 +1023,60 @@ void plan_sync_position()
 }
 
 
+// Returns the number of blocks needed to move from the planner position to target in a straight line,
+// such that no axis exceeds PLAN_SPLIT_STEPS per block. Step counts are computed as in plan_buffer_line().
+uint16_t plan_get_line_block_count(float *target)
+{
+  int32_t delta_steps[N_AXIS];
+  uint32_t steps, max_steps = 0;
+  uint8_t idx;
+  for (idx=0; idx<N_AXIS; idx++) {
+    delta_steps[idx] = lround(target[idx]*settings.steps_per_mm[idx]) - pl.position[idx];
+  }
+  for (idx=0; idx<N_AXIS; idx++) {
+    #ifdef COREXY
+      if (idx == A_MOTOR) { steps = labs(delta_steps[AXIS_1] + delta_steps[AXIS_2]); }
+      else if (idx == B_MOTOR) { steps = labs(delta_steps[AXIS_1] - delta_steps[AXIS_2]); }
+      else { steps = labs(delta_steps[idx]); }
+    #else
+      steps = labs(delta_steps[idx]);
+    #endif
+    if (steps > max_steps) { max_steps = steps; }
+  }
+  if (max_steps <= PLAN_BLOCK_MAX_STEPS) { return(1); }
+  return((max_steps+(PLAN_SPLIT_STEPS-1))/PLAN_SPLIT_STEPS);
+}
+
+
+#ifdef ENABLE_NATIVE_ARCS
+  // Returns the number of arc blocks to move from the planner position to target, such that no axis
+  // exceeds PLAN_SPLIT_STEPS per block. The plane axes are bound by the arc length, the other axes by
+  // their line distance.
+  uint16_t plan_get_arc_block_count(float *target, float arc_mm, uint8_t plane_mask)
+  {
+    uint16_t n_blocks = plan_get_line_block_count(target);
+    float max_steps_per_mm = 0.0;
+    uint8_t idx;
+    for (idx=0; idx<N_AXIS; idx++) {
+      if ((plane_mask & bit(idx)) && (settings.steps_per_mm[idx] > max_steps_per_mm)) {
+        max_steps_per_mm = settings.steps_per_mm[idx];
+      }
+    }
+    float arc_blocks = ceil(arc_mm*max_steps_per_mm/PLAN_SPLIT_STEPS);
+    if (arc_blocks > n_blocks) { n_blocks = arc_blocks; }
+    return(n_blocks);
+  }
+#endif
+
+
+// Returns the planner position in millimeters.
+void plan_get_planner_mpos(float *target)
+{
+  uint8_t idx;
+  for (idx=0; idx<N_AXIS; idx++) { target[idx] = pl.position[idx]/settings.steps_per_mm[idx]; }
+}
+
+
 // Returns the number of available blocks are in the planner buffer.
 uint8_t plan_get_block_buffer_available()
 {
@@ -523,6 +1100,19 @@ void plan_cycle_reinitialize()
 {
   // Re-plan from a complete stop. Reset planner entry speeds and buffer planned pointer.
   st_update_plan_block_parameters();
+  if (block_buffer_planned != block_buffer_head) { planner_ramp_rebase(plan_next_block_index(block_buffer_planned)); }
   block_buffer_planned = block_buffer_tail;
   planner_recalculate();
+
+  #ifndef SHAPED_RAMPS
+    // Every block after the planned pointer now lies on the deceleration ramp. Restart its bookkeeping.
+    ramp_cap_tail = ramp_cap_head;
+    if (block_buffer_planned != block_buffer_head) {
+      uint8_t block_index = plan_next_block_index(block_buffer_planned);
+      while (block_index != block_buffer_head) {
+        planner_ramp_push(block_index);
+        block_index = plan_next_block_index(block_index);
+      }
+    }
+  #endif
 }
@@ -26,7 +26,18 @@
 
 // The number of linear motions that can be in the plan at any give time
 #ifndef BLOCK_BUFFER_SIZE
-  #define BLOCK_BUFFER_SIZE 36
+  #define BLOCK_BUFFER_SIZE 80
+#endif
+
+// Maximum axis step count of a planner block. mc_line() splits longer motions into several blocks.
+// System motions (homing/parking) are planned as a single block and keep longer step counts in an
+// overflow record instead, flagged by a block step_event_count above this value.
+#define PLAN_BLOCK_MAX_STEPS 0xFFFF
+
+// Ramps executed with a shaped acceleration profile. The planner plans them with the time the shaping
+// needs on top of the trapezoidal ramp time, so that they peak at the block acceleration.
+#if defined(ENABLE_S_CURVE_ACCELERATION) || defined(ENABLE_INPUT_SHAPING)
+  #define SHAPED_RAMPS
 #endif
 
 // Returned status message from planner.
@@ -52,9 +63,10 @@
 typedef struct {
   // Fields used by the bresenham algorithm for tracing the line
   // NOTE: Used by stepper algorithm to execute the block correctly. Do not alter these values.
-  uint32_t steps[N_AXIS];    // Step count along each axis
+  // NOTE: Use plan_get_block_steps() to read the step counts, which may be held in the overflow record.
+  uint16_t steps[N_AXIS];    // Step count along each axis
   uint32_t step_event_count; // The maximum step axis count and number of steps required to complete this block.
-  uint8_t direction_bits[N_AXIS];    // The direction bit set for this block (refers to *_DIRECTION_BIT in config.h)
+  uint8_t direction_bits;    // Axis direction bitmask. Bit(idx) set means axis idx moves in the negative direction.
   // Block condition data to ensure correct execution depending on states and overrides.
   uint8_t condition;      // Block bitflag variable defining block run conditions. Copied from pl_line_data.
   int32_t line_number;  // Block line number for real-time reporting. Copied from pl_line_data.
@@ -68,16 +80,32 @@ typedef struct {
   float millimeters;         // The remaining distance for this block to be executed in (mm).
                              // NOTE: This value may be altered by stepper algorithm during execution.
 
-  // Stored rate limiting data used by planner when changes occur.
-  float max_junction_speed_sqr; // Junction entry speed limit based on direction vectors in (mm/min)^2
-  float rapid_rate;             // Axis-limit adjusted maximum rate for this block direction in (mm/min)
-  float programmed_rate;        // Programmed rate of this block (mm/min).
+  // Stored rate limiting data used by planner when changes occur. The limits are only needed again upon
+  // override changes and are stored quantized to 16 bits, rounded down. See plan_quantize().
+  uint16_t max_junction_speed_sqr_q; // Junction entry speed limit based on direction vectors in (mm/min)^2
+  uint16_t rapid_rate_q;             // Axis-limit adjusted maximum rate for this block direction in (mm/min)
+  float programmed_rate;             // Programmed rate of this block (mm/min).
+  #ifdef ENABLE_S_CURVE_ACCELERATION
+    uint16_t jerk_q;                 // Axis-limit adjusted line jerk in (mm/min^3). See plan_get_block_jerk().
+  #endif
 
   // Stored spindle speed data used by spindle overrides and resuming methods.
   float spindle_speed;    // Block spindle speed. Copied from pl_line_data.
   #ifdef USE_OUTPUT_PWM
     float output_volts; // Block output PWM value. Copied from pl_line_data.
   #endif
+  #ifdef ENABLE_INLINE_OUTPUT_CHANGES
+    uint8_t digital_state; // Block M62/M63 digital output state. Copied from pl_line_data.
+  #endif
+
+  #ifdef ENABLE_NATIVE_ARCS
+    // Arc geometry traced by the step segment generator. The other axes move linearly, as in a line block.
+    uint8_t arc_axis_0_mask; // Axes moving along the first circle plane axis. Zero for line blocks.
+    uint8_t arc_axis_1_mask; // Axes moving along the second circle plane axis.
+    uint16_t arc_chords;     // Number of chords the arc is traced with.
+    float arc_start[2];      // Radius vector from the circle center to the arc start (mm)
+    float arc_travel;        // Angular travel. Positive counter-clockwise. (radians)
+  #endif
 } plan_block_t;
 
 
@@ -90,9 +118,23 @@ typedef struct {
   #endif
   int32_t line_number;    // Desired line number to report when executing.
   uint8_t condition;      // Bitflag variable to indicate planner conditions. See defines above.
+  #ifdef ENABLE_INLINE_OUTPUT_CHANGES
+    uint8_t digital_state; // Desired digital output state through line motion.
+  #endif
 } plan_line_data_t;
 
 
+#ifdef ENABLE_NATIVE_ARCS
+  // Arc data prototype. Passed along with the planner data to plan an arc block.
+  typedef struct {
+    float start[2];       // Radius vector from the circle center to the arc start (mm)
+    float travel;         // Angular travel. Positive counter-clockwise. (radians)
+    uint8_t axis_0_mask;  // Axes moving along the first circle plane axis
+    uint8_t axis_1_mask;  // Axes moving along the second circle plane axis
+  } plan_arc_data_t;
+#endif
+
+
 // Initialize and reset the motion plan subsystem
 void plan_reset(); // Reset all
 void plan_reset_buffer(); // Reset buffer only.
@@ -102,6 +144,12 @@ void plan_reset_buffer(); // Reset buffer only.
 // rate is taken to mean "frequency" and would complete the operation in 1/feed_rate minutes.
 uint8_t plan_buffer_line(float *target, plan_line_data_t *pl_data);
 
+#ifdef ENABLE_NATIVE_ARCS
+  // Add a new arc movement to the buffer, as a single block. Same as plan_buffer_line(), where the axes
+  // of the arc plane follow the circle given by arc_data on their way to target.
+  uint8_t plan_buffer_arc(float *target, plan_line_data_t *pl_data, plan_arc_data_t *arc_data);
+#endif
+
 // Called when the current block is no longer needed. Discards the block and makes the memory
 // availible for new blocks.
 void plan_discard_current_block();
@@ -109,6 +157,19 @@ void plan_discard_current_block();
 // Gets the planner block for the special system motion cases. (Parking/Homing)
 plan_block_t *plan_get_system_motion_block();
 
+// Copies the axis step counts of a block into steps[N_AXIS]. Called by the stepper on block load.
+void plan_get_block_steps(plan_block_t *block, uint32_t *steps);
+
+// Returns the number of blocks, with at most PLAN_BLOCK_MAX_STEPS steps per axis, needed to move
+// from the planner position to target. Used by mc_line() to split long motions.
+uint16_t plan_get_line_block_count(float *target);
+
+#ifdef ENABLE_NATIVE_ARCS
+  // Returns the number of arc blocks needed to move from the planner position to target along an arc
+  // of arc_mm length in the plane of the axes in plane_mask. Used by mc_arc() to split long arcs.
+  uint16_t plan_get_arc_block_count(float *target, float arc_mm, uint8_t plane_mask);
+#endif
+
 // Gets the current block. Returns NULL if buffer empty
 plan_block_t *plan_get_current_block();
 
@@ -121,6 +182,20 @@ float plan_get_exec_block_exit_speed_sqr();
 // Called by main program during planner calculations and step segment buffer during initialization.
 float plan_compute_profile_nominal_speed(plan_block_t *block);
 
+#ifdef ENABLE_S_CURVE_ACCELERATION
+  // Returns the jerk limit of a block in (mm/min^3). Called by the step segment buffer.
+  float plan_get_block_jerk(plan_block_t *block);
+#endif
+
+#ifdef SHAPED_RAMPS
+  // Returns the distance of a shaped ramp of the block between two speeds, either way, in (mm).
+  float plan_get_ramp_distance(plan_block_t *block, float speed_0, float speed_1);
+
+  // Returns the speed a shaped ramp of the block reaches from speed within distance, in (mm/min).
+  // Accelerates to the highest, or decelerates to the lowest such speed.
+  float plan_get_ramp_speed(plan_block_t *block, float speed, float distance, uint8_t is_accelerating);
+#endif
+
 // Re-calculates buffered motions profile parameters upon a motion-based override change.
 void plan_update_velocity_profile_parameters();
 
@@ -140,6 +215,7 @@ uint8_t plan_get_block_buffer_count();
 // Returns the status of the block ring buffer. True, if buffer is full.
 uint8_t plan_check_full_buffer();
 
+// Returns the planner position in millimeters. Where the last buffered motion ends.
 void plan_get_planner_mpos(float *target);
 
 
@@ -29,9 +29,232 @@
 
 
 static char line[LINE_BUFFER_SIZE]; // Line to be executed. Zero-terminated.
+static uint8_t line_flags;
+static uint8_t char_counter;
 
 static void protocol_exec_rt_suspend();
 
+#ifdef TOKENIZE_GCODE_ON_RECEIVE
+  // Tokenizing state of the g-code word being received. See protocol_tokenize_char().
+  #define WORD_STATE_LETTER 0 // Expecting a word letter. Initial state of a line.
+  #define WORD_STATE_VALUE  1 // Receiving the number of a word.
+  #define WORD_STATE_TEXT   2 // Storing a '$' line as text.
+  #define WORD_STATE_ERROR  3 // Word error tokenized. Throws away the rest of the line.
+
+  #define WORD_FLAG_STARTED  bit(0) // Any character of the number received. No sign allowed after.
+  #define WORD_FLAG_NEGATIVE bit(1)
+  #define WORD_FLAG_DECIMAL  bit(2)
+
+  #define WORD_TOKEN_SIZE (1+sizeof(float)) // Letter and float value.
+
+  static uint8_t word_state;
+  static uint8_t word_flags;
+  static uint8_t word_ndigit;
+  static int8_t word_exp;
+  static uint32_t word_intval;
+#endif
+
+#ifdef ENABLE_BINARY_PROTOCOL
+  // Binary frame reception state of the main loop. The frame data still holds the escapes, which are
+  // removed here, so the frame length counts the unescaped payload and its trailing CRC-8.
+  #define FRAME_MODE_OFF    0 // Line protocol.
+  #define FRAME_MODE_IDLE   1 // Binary protocol, waiting for a frame start.
+  #define FRAME_MODE_LENGTH 2 // Frame started, waiting for its length.
+  #define FRAME_MODE_DATA   3 // Receiving the frame payload and CRC-8 into line[].
+  #define FRAME_MODE_ESCAPED bit(7) // Flag. The next byte is escaped.
+
+  // Frame payload types, given by the first payload byte.
+  #define FRAME_TYPE_BLOCK 0x01 // Tokenized g-code block. See gc_execute_block().
+  #define FRAME_TYPE_LINE  0x02 // Formatted g-code line or '$' command, as passed to the parsers.
+
+  static uint8_t frame_mode;
+  static uint8_t frame_length; // Frame payload and CRC-8 bytes.
+  static uint8_t frame_count;  // Frame bytes received in line[].
+#endif
+
+
+// Executes one tokenized, non-empty g-code block and returns its status.
+#if defined(ENABLE_BINARY_PROTOCOL) || defined(TOKENIZE_GCODE_ON_RECEIVE)
+  static uint8_t protocol_execute_block(char *block, uint8_t length)
+  {
+    // Block if in alarm or jog mode.
+    if (sys.state & (STATE_ALARM | STATE_JOG)) { return(STATUS_SYSTEM_GC_LOCK); }
+    return(gc_execute_block(block,length));
+  }
+#endif
+
+
+// Directs and executes one formatted, non-empty line and returns its status.
+static uint8_t protocol_execute_line(char *line)
+{
+  if (line[0] == '$') {
+    // Grbl '$' system command. These may move the machine or depend on its planned position.
+    #ifdef ENABLE_PATH_BLENDING
+      mc_flush_blending();
+    #endif
+    return(system_execute_line(line));
+  }
+  // Everything else is gcode. Block if in alarm or jog mode.
+  if (sys.state & (STATE_ALARM | STATE_JOG)) { return(STATUS_SYSTEM_GC_LOCK); }
+  // Parse and execute g-code block.
+  return(gc_execute_line(line));
+}
+
+
+#ifdef ENABLE_BINARY_PROTOCOL
+  // Checks and executes a complete binary frame in line[] and acks it with its status.
+  static void protocol_execute_frame()
+  {
+    uint8_t status = STATUS_FRAME_ERROR;
+    if (frame_length >= 2) { // Payload type and CRC-8 at least.
+      uint8_t length = frame_length-1; // Payload without CRC-8
+      uint8_t crc = 0;
+      uint8_t idx;
+      for (idx=0; idx<length; idx++) { crc = crc8_update(crc,line[idx]); }
+      if (crc == (uint8_t)line[length]) {
+        protocol_execute_realtime(); // Runtime command check point.
+        if (sys.abort) { return; } // Bail to main loop upon system abort
+
+        line[length] = 0; // Set string termination character for line frames.
+        if (line[0] == FRAME_TYPE_BLOCK) {
+          status = protocol_execute_block(line+1,length-1);
+        } else if (line[0] == FRAME_TYPE_LINE) {
+          if (line[1] == 0) { status = STATUS_OK; } // Empty line. For syncing purposes.
+          else { status = protocol_execute_line(line+1); }
+        }
+      }
+    }
+    report_frame_ack(status);
+    #ifdef ENABLE_PARSE_AHEAD_QUEUE
+      mc_plan_queued_lines(); // Refill the planner from the motions parsed ahead.
+    #endif
+  }
+
+
+  // Assembles binary frames from the serial read data, byte by byte, and executes them.
+  static void protocol_read_frame(uint8_t c)
+  {
+    if (frame_mode >= FRAME_MODE_LENGTH) {
+      if (c == SERIAL_FRAME_START) {
+        // Frame starts are escaped in frame data. A bare one means the frame was cut short, maybe
+        // by lost bytes. Ack it as broken and resync on the new frame.
+        frame_length = 0;
+        frame_mode = FRAME_MODE_LENGTH;
+        protocol_execute_frame(); // Acks an error.
+        return;
+      }
+      if (c == SERIAL_FRAME_ESCAPE) {
+        frame_mode |= FRAME_MODE_ESCAPED;
+        return;
+      }
+      if (frame_mode & FRAME_MODE_ESCAPED) {
+        c ^= 0x20;
+        frame_mode &= ~FRAME_MODE_ESCAPED;
+      }
+    }
+    switch (frame_mode) {
+      case FRAME_MODE_IDLE:
+        // The RX interrupt passes on nothing else between frames.
+        if (c == SERIAL_FRAME_START) { frame_mode = FRAME_MODE_LENGTH; }
+        else if (c == CMD_BINARY_MODE_EXIT) { frame_mode = FRAME_MODE_OFF; }
+        break;
+      case FRAME_MODE_LENGTH:
+        frame_length = c;
+        frame_count = 0;
+        if (frame_length == 0) {
+          frame_mode = FRAME_MODE_IDLE;
+          protocol_execute_frame(); // Acks an error.
+        } else {
+          frame_mode = FRAME_MODE_DATA;
+        }
+        break;
+      default: // FRAME_MODE_DATA
+        // NOTE: line[] always fits a frame, since the frame length is a byte. Checked in grbl.h.
+        line[frame_count++] = c;
+        if (frame_count == frame_length) {
+          frame_mode = FRAME_MODE_IDLE;
+          protocol_execute_frame();
+        }
+    }
+  }
+#endif
+
+
+#ifdef TOKENIZE_GCODE_ON_RECEIVE
+  // Ends the word being received, storing its float value after its letter in line[]. A word
+  // without digits gets the GC_TOKEN_BAD_NUMBER letter instead and ends the line.
+  static void protocol_tokenize_value()
+  {
+    if (word_ndigit) {
+      float value = decimal_to_float(word_intval, word_exp, word_flags & WORD_FLAG_NEGATIVE);
+      memcpy(line+char_counter, &value, sizeof(float));
+      char_counter += sizeof(float);
+      word_state = WORD_STATE_LETTER;
+    } else {
+      line[char_counter-1] = GC_TOKEN_BAD_NUMBER;
+      word_state = WORD_STATE_ERROR;
+    }
+  }
+
+
+  // Tokenizes one formatted line character into line[], i.e. g-code words into their letter and
+  // float value, as read_float() would convert them, or a '$' line into text. Word errors are
+  // tokenized for the g-code parser to report in order with all other errors of the block.
+  static void protocol_tokenize_char(uint8_t c)
+  {
+    if (word_state == WORD_STATE_VALUE) {
+      c -= '0';
+      if (c <= 9) {
+        word_flags |= WORD_FLAG_STARTED;
+        word_ndigit++;
+        if (word_ndigit <= MAX_INT_DIGITS) {
+          if (word_flags & WORD_FLAG_DECIMAL) { word_exp--; }
+          word_intval = (((word_intval << 2) + word_intval) << 1) + c; // intval*10 + c
+        } else {
+          if (!(word_flags & WORD_FLAG_DECIMAL)) { word_exp++; }  // Drop overflow digits
+        }
+        return;
+      }
+      c += '0';
+      if ((c == '.') && !(word_flags & WORD_FLAG_DECIMAL)) {
+        word_flags |= (WORD_FLAG_STARTED | WORD_FLAG_DECIMAL);
+        return;
+      }
+      if (((c == '-') || (c == '+')) && !(word_flags & WORD_FLAG_STARTED)) {
+        if (c == '-') { word_flags |= WORD_FLAG_NEGATIVE; }
+        word_flags |= WORD_FLAG_STARTED;
+        return;
+      }
+      // Any other character ends the number and starts the next word.
+      protocol_tokenize_value();
+    }
+
+    if (word_state == WORD_STATE_LETTER) {
+      if ((char_counter == 0) && (c == '$')) {
+        word_state = WORD_STATE_TEXT;
+      } else if (char_counter > (LINE_BUFFER_SIZE-1)-WORD_TOKEN_SIZE) {
+        line_flags |= LINE_FLAG_OVERFLOW; // Line buffer can't fit another word.
+        return;
+      } else if ((c >= 'A') && (c <= 'Z')) {
+        word_state = WORD_STATE_VALUE;
+        word_flags = 0;
+        word_ndigit = 0;
+        word_exp = 0;
+        word_intval = 0;
+      } else {
+        word_state = WORD_STATE_ERROR; // Stored as letter. Parser reports the expected letter.
+      }
+      line[char_counter++] = c;
+    } else if (word_state == WORD_STATE_TEXT) {
+      if (char_counter >= (LINE_BUFFER_SIZE-1)) {
+        line_flags |= LINE_FLAG_OVERFLOW;
+      } else {
+        line[char_counter++] = c;
+      }
+    }
+  }
+#endif
+
 
 /*
   GRBL PRIMARY LOOP:
@@ -69,16 +292,42 @@ void protocol_main_loop()
   // This is also where Grbl idles while waiting for something to do.
   // ---------------------------------------------------------------------------------
 
-  uint8_t line_flags = 0;
-  uint8_t char_counter = 0;
   uint8_t c;
   uint8_t crlf_flag = 0;
+  #ifdef REPORT_FIELD_STARVATION_COUNTERS
+    uint8_t serial_starved = false;
+  #endif
+  line_flags = 0;
+  char_counter = 0;
+  #ifdef TOKENIZE_GCODE_ON_RECEIVE
+    word_state = WORD_STATE_LETTER;
+  #endif
+  #ifdef ENABLE_BINARY_PROTOCOL
+    frame_mode = FRAME_MODE_OFF;
+  #endif
   
   for (;;) {
 
     // Process one line of incoming serial data, as the data becomes available. Performs an
     // initial filtering by removing spaces and comments and capitalizing all letters.
     while((c = serial_read()) != SERIAL_NO_DATA) {
+      #ifdef ENABLE_BINARY_PROTOCOL
+        if (frame_mode != FRAME_MODE_OFF) {
+          protocol_read_frame(c);
+          if (sys.abort) { return; } // Bail to calling function upon system abort
+          continue;
+        }
+        if (c == CMD_BINARY_MODE_ENTER) {
+          // Switch to binary frames. Any partial line received so far is dropped.
+          frame_mode = FRAME_MODE_IDLE;
+          line_flags = 0;
+          char_counter = 0;
+          #ifdef TOKENIZE_GCODE_ON_RECEIVE
+            word_state = WORD_STATE_LETTER;
+          #endif
+          continue;
+        }
+      #endif
       if ((c == '\n') || (c == '\r')) { // End of line reached
 
         if (c == '\r') {
@@ -92,6 +341,9 @@ void protocol_main_loop()
         protocol_execute_realtime(); // Runtime command check point.
         if (sys.abort) { return; } // Bail to calling function upon system abort
 
+        #ifdef TOKENIZE_GCODE_ON_RECEIVE
+          if (word_state == WORD_STATE_VALUE) { protocol_tokenize_value(); } // End last word.
+        #endif
         line[char_counter] = 0; // Set string termination character.
         #ifdef REPORT_ECHO_LINE_RECEIVED
           report_echo_line_received(line);
@@ -101,27 +353,31 @@ void protocol_main_loop()
         if (line_flags & LINE_FLAG_OVERFLOW) {
           // Report line overflow error.
           report_status_message(STATUS_OVERFLOW);
-        } else if (line[0] == 0) {
+        } else if (char_counter == 0) {
           // Dont send 2 OK when character is LF just after a CR
           // Send the OK reply when CR is received or if LF is received without CR just before.
           if ((c == '\r') || ((c == '\n') && (crlf_flag != 1))) {
             // Empty or comment line. For syncing purposes.
             report_status_message(STATUS_OK);
           }
-        } else if (line[0] == '$') {
-          // Grbl '$' system command
-          report_status_message(system_execute_line(line));
-        } else if (sys.state & (STATE_ALARM | STATE_JOG)) {
-          // Everything else is gcode. Block if in alarm or jog mode.
-          report_status_message(STATUS_SYSTEM_GC_LOCK);
+        #ifdef TOKENIZE_GCODE_ON_RECEIVE
+        } else if (word_state != WORD_STATE_TEXT) {
+          report_status_message(protocol_execute_block(line,char_counter));
+        #endif
         } else {
-          // Parse and execute g-code block.
-          report_status_message(gc_execute_line(line));
+          report_status_message(protocol_execute_line(line));
         }
 
         // Reset tracking data for next line.
         line_flags = 0;
         char_counter = 0;
+        #ifdef TOKENIZE_GCODE_ON_RECEIVE
+          word_state = WORD_STATE_LETTER;
+        #endif
+        #ifdef ENABLE_PARSE_AHEAD_QUEUE
+          mc_plan_queued_lines(); // Refill the planner from the motions parsed ahead.
+          if (sys.abort) { return; } // Bail to calling function upon system abort
+        #endif
 
       } else {
 
@@ -153,6 +409,11 @@ void protocol_main_loop()
             // where, during a program, the system auto-cycle start will continue to execute
             // everything until the next '%' sign. This will help fix resuming issues with certain
             // functions that empty the planner buffer to execute its task on-time.
+          #ifdef TOKENIZE_GCODE_ON_RECEIVE
+          } else {
+            if (c >= 'a' && c <= 'z') { c -= 'a'-'A'; } // Upcase lowercase
+            protocol_tokenize_char(c); // Detects line buffer overflow and sets flag.
+          #else
           } else if (char_counter >= (LINE_BUFFER_SIZE-1)) {
             // Detect line buffer overflow and set flag.
             line_flags |= LINE_FLAG_OVERFLOW;
@@ -160,15 +421,39 @@ void protocol_main_loop()
             line[char_counter++] = c-'a'+'A';
           } else {
             line[char_counter++] = c;
+          #endif
           }
         }
 
       }
     }
 
+    #ifdef REPORT_FIELD_STARVATION_COUNTERS
+      // Count each time the serial read buffer runs empty while the planner could take more
+      // blocks during a cycle. The event ends once the planner fills up or the cycle ends.
+      if ((sys.state == STATE_CYCLE) && plan_get_block_buffer_available()) {
+        if (!serial_starved) {
+          sys_starvation.serial++;
+          serial_starved = true;
+        }
+      } else {
+        serial_starved = false;
+      }
+    #endif
+
     // If there are no more characters in the serial read buffer to be processed and executed,
     // this indicates that g-code streaming has either filled the planner buffer or has
-    // completed. In either case, auto-cycle start, if enabled, any queued moves.
+    // completed. In either case, auto-cycle start, if enabled, any queued moves. A line motion
+    // held back for path blending is planned once the planner runs low on motions.
+    #ifdef ENABLE_PARSE_AHEAD_QUEUE
+      mc_plan_queued_lines();
+      if (sys.abort) { return; } // Bail to main() program loop to reset system.
+    #endif
+    #ifdef ENABLE_PATH_BLENDING
+      if (plan_get_block_buffer_available() > (BLOCK_BUFFER_SIZE-1)-PATH_BLENDING_FLUSH_BLOCKS) {
+        mc_flush_blending();
+      }
+    #endif
     protocol_auto_cycle_start();
 
     protocol_execute_realtime();  // Runtime command check point.
@@ -189,6 +474,13 @@ void protocol_main_loop()
 void protocol_buffer_synchronize()
 {
   // If system is queued, ensure cycle resumes if the auto start flag is present.
+  #ifdef ENABLE_PATH_BLENDING
+    mc_flush_blending();
+  #endif
+  #ifdef ENABLE_PARSE_AHEAD_QUEUE
+    mc_flush_line_queue();
+    if (sys.abort) { return; } // Check for system abort
+  #endif
   protocol_auto_cycle_start();
   do {
     protocol_execute_realtime();   // Check and execute run-time commands
@@ -408,6 +700,9 @@ void protocol_exec_rt_system()
         // NOTE: Motion and jog cancel both immediately return to idle after the hold completes.
         if (sys.suspend & SUSPEND_JOG_CANCEL) {   // For jog cancel, flush buffers and sync positions.
           sys.step_control = STEP_CONTROL_NORMAL_OP;
+          #ifdef ENABLE_PARSE_AHEAD_QUEUE
+            mc_reset_line_queue();
+          #endif
           plan_reset();
           st_reset();
           gc_sync_position();
@@ -420,6 +715,10 @@ void protocol_exec_rt_system()
         } else {
           sys.suspend = SUSPEND_DISABLE;
           sys.state = STATE_IDLE;
+          #ifdef ENABLE_INLINE_OUTPUT_CHANGES
+            // Set the output changes programmed after the last planner block.
+            if (plan_get_current_block() == NULL) { gc_sync_outputs(); }
+          #endif
         }
       }
       system_clear_exec_state_flag(EXEC_CYCLE_STOP);
@@ -486,7 +785,9 @@ void protocol_exec_rt_system()
     }
 
     // NOTE: Since coolant state always performs a planner sync whenever it changes, the current
-    // run state can be determined by checking the parser state.
+    // run state can be determined by checking the parser state. With inline output changes, the
+    // parser state may be ahead of the outputs, which queued blocks then still change as programmed.
+    // A suspend restores the outputs of the executing block instead. See protocol_exec_rt_suspend().
     // NOTE: Coolant overrides only operate during IDLE, CYCLE, HOLD, and JOG states. Ignored otherwise.																										
     if (rt_exec & (EXEC_COOLANT_FLOOD_OVR_TOGGLE | EXEC_COOLANT_MIST_OVR_TOGGLE)) {
       if ((sys.state == STATE_IDLE) || (sys.state & (STATE_CYCLE | STATE_HOLD | STATE_JOG))) {
@@ -505,6 +806,26 @@ void protocol_exec_rt_system()
     }
   }
 
+  #ifdef STEPPER_ISR_PROFILER
+    if (sys_rt_exec_debug & EXEC_ISR_PROFILE_REPORT) {
+      report_isr_profile();
+      uint8_t sreg = SREG;
+      cli();
+      bit_false(sys_rt_exec_debug,EXEC_ISR_PROFILE_REPORT);
+      SREG = sreg;
+    }
+  #endif
+
+  #ifdef REPORT_FIELD_STARVATION_COUNTERS
+    if (sys_rt_exec_debug & EXEC_STARVATION_RESET) {
+      uint8_t sreg = SREG;
+      cli();
+      memset(&sys_starvation, 0, sizeof(starvation_t));
+      bit_false(sys_rt_exec_debug,EXEC_STARVATION_RESET);
+      SREG = sreg;
+    }
+  #endif
+
   // Reload step segment buffer
   if (sys.state & (STATE_CYCLE | STATE_HOLD | STATE_SAFETY_DOOR | STATE_HOMING | STATE_SLEEP| STATE_JOG)) {
     st_prep_buffer();
@@ -542,6 +863,11 @@ static void protocol_exec_rt_suspend()
     restore_condition = (block->condition & PL_COND_SPINDLE_MASK) | coolant_get_state();
     restore_spindle_speed = block->spindle_speed;
   }
+  #ifdef ENABLE_INLINE_OUTPUT_CHANGES
+    // The parser state may be ahead of the executing block, whose outputs are the ones to restore.
+    uint8_t restore_spindle = restore_condition & PL_COND_SPINDLE_MASK;
+    uint8_t restore_coolant = restore_condition & (PL_COND_FLAG_COOLANT_FLOOD | PL_COND_FLAG_COOLANT_MIST);
+  #endif
   #ifdef DISABLE_LASER_DURING_HOLD
     if (bit_istrue(settings.flags,BITFLAG_LASER_MODE)) {
       system_set_exec_accessory_override_flag(EXEC_SPINDLE_OVR_STOP);
@@ -674,7 +1000,11 @@ static void protocol_exec_rt_suspend()
             #endif
 
             // Delayed Tasks: Restart spindle and coolant, delay to power-up, then resume cycle.
+            #ifdef ENABLE_INLINE_OUTPUT_CHANGES
+            if (restore_spindle != SPINDLE_DISABLE) {
+            #else
             if (gc_state.modal.spindle != SPINDLE_DISABLE) {
+            #endif
               // Block if safety door re-opened during prior restore actions.
               if (bit_isfalse(sys.suspend,SUSPEND_RESTART_RETRACT)) {
                 if (bit_istrue(settings.flags,BITFLAG_LASER_MODE)) {
@@ -686,7 +1016,11 @@ static void protocol_exec_rt_suspend()
                 }
               }
             }
+            #ifdef ENABLE_INLINE_OUTPUT_CHANGES
+            if (restore_coolant != COOLANT_DISABLE) {
+            #else
             if (gc_state.modal.coolant != COOLANT_DISABLE) {
+            #endif
               // Block if safety door re-opened during prior restore actions.
               if (bit_isfalse(sys.suspend,SUSPEND_RESTART_RETRACT)) {
                 // NOTE: Laser mode will honor this delay. An exhaust system is often controlled by this pin.
@@ -732,7 +1066,11 @@ static void protocol_exec_rt_suspend()
         if (sys.spindle_stop_ovr) {
           // Handles beginning of spindle stop
           if (sys.spindle_stop_ovr & SPINDLE_STOP_OVR_INITIATE) {
+            #ifdef ENABLE_INLINE_OUTPUT_CHANGES
+            if (restore_spindle != SPINDLE_DISABLE) {
+            #else
             if (gc_state.modal.spindle != SPINDLE_DISABLE) {
+            #endif
               spindle_set_state(SPINDLE_DISABLE,0.0); // De-energize
               sys.spindle_stop_ovr = SPINDLE_STOP_OVR_ENABLED; // Set stop override state to enabled, if de-energized.
             } else {
@@ -740,7 +1078,11 @@ static void protocol_exec_rt_suspend()
             }
           // Handles restoring of spindle state
           } else if (sys.spindle_stop_ovr & (SPINDLE_STOP_OVR_RESTORE | SPINDLE_STOP_OVR_RESTORE_CYCLE)) {
+            #ifdef ENABLE_INLINE_OUTPUT_CHANGES
+            if (restore_spindle != SPINDLE_DISABLE) {
+            #else
             if (gc_state.modal.spindle != SPINDLE_DISABLE) {
+            #endif
               report_feedback_message(MESSAGE_SPINDLE_RESTORE);
               if (bit_istrue(settings.flags,BITFLAG_LASER_MODE)) {
                 // When in laser mode, ignore spindle spin-up delay. Set to turn on laser when cycle starts.
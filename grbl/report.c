@@ -159,6 +159,9 @@ static void report_util_setting_string(uint8_t n) {
         case 1: printPgmString(PSTR(":mm/min")); break;
         case 2: printPgmString(PSTR(":mm/s^2")); break;
         case 3: printPgmString(PSTR(":mm max")); break;
+        #ifdef ENABLE_S_CURVE_ACCELERATION
+          case 4: printPgmString(PSTR(":mm/s^3")); break;
+        #endif
       }
       break;
   }
@@ -196,6 +199,26 @@ void report_status_message(uint8_t status_code)
   }
 }
 
+#ifdef ENABLE_BINARY_PROTOCOL
+  // Sends the ack of a binary frame, in place of the 'ok' or 'error:' response message. It holds
+  // the status code, the free planner blocks and the free serial RX bytes, and their CRC-8.
+  void report_frame_ack(uint8_t status_code)
+  {
+    uint8_t ack[3];
+    ack[0] = status_code;
+    ack[1] = plan_get_block_buffer_available();
+    ack[2] = serial_get_rx_buffer_available();
+    uint8_t crc = 0;
+    uint8_t idx;
+    serial_write(SERIAL_FRAME_ACK);
+    for (idx=0; idx<3; idx++) {
+      serial_write(ack[idx]);
+      crc = crc8_update(crc,ack[idx]);
+    }
+    serial_write(crc);
+  }
+#endif
+
 // Prints alarm messages.
 void report_alarm_message(uint8_t alarm_code)
 {
@@ -236,6 +259,8 @@ void report_feedback_message(uint8_t message_code)
       printPgmString(PSTR("Restoring spindle")); break;
     case MESSAGE_SLEEP_MODE:
       printPgmString(PSTR("Sleeping")); break;
+    case MESSAGE_BAUD_RATE_SWITCH:
+      printPgmString(PSTR("Switching baud rate")); break;
   }
   report_util_feedback_line_feed();
 }
@@ -249,7 +274,7 @@ void report_init_message()
 
 // Grbl help message
 void report_grbl_help() {
-  printPgmString(PSTR("[HLP:$$ $# $D $G $I $N $x=val $Nx=line $J=line $SLP $C $X $H ~ ! ? ctrl-x]\r\n"));
+  printPgmString(PSTR("[HLP:$$ $# $D $G $I $N $x=val $Nx=line $J=line $SLP $C $X $H $B=baud ~ ! ? ctrl-x]\r\n"));
 }
 
 
@@ -288,6 +313,12 @@ void report_grbl_settings() {
     report_util_float_setting(35,settings.volts_max, N_DECIMAL_SETTINGVALUE);
     report_util_float_setting(36,settings.volts_min, N_DECIMAL_SETTINGVALUE);
   #endif
+  report_util_setting_prefix(40); print_uint32_base10(settings.baud_rate); report_util_line_feed();
+  #ifdef ENABLE_INPUT_SHAPING
+    report_util_uint8_setting(41,settings.input_shaper_type);
+    report_util_float_setting(42,settings.input_shaper_frequency,N_DECIMAL_SETTINGVALUE);
+    report_util_float_setting(43,settings.input_shaper_damping,N_DECIMAL_SETTINGVALUE);
+  #endif
   // Print axis settings
   uint8_t idx, set_idx;
   uint8_t val = AXIS_SETTINGS_START_VAL;
@@ -298,6 +329,9 @@ void report_grbl_settings() {
         case 1: report_util_float_setting(val+idx,settings.max_rate[idx],N_DECIMAL_SETTINGVALUE); break;
         case 2: report_util_float_setting(val+idx,settings.acceleration[idx]/(60*60),N_DECIMAL_SETTINGVALUE); break;
         case 3: report_util_float_setting(val+idx,-settings.max_travel[idx],N_DECIMAL_SETTINGVALUE); break;
+        #ifdef ENABLE_S_CURVE_ACCELERATION
+          case 4: report_util_float_setting(val+idx,settings.jerk[idx]/(60*60*60),N_DECIMAL_SETTINGVALUE); break;
+        #endif
         case 5: report_util_float_setting(val + idx, settings.endstop_adj[idx], N_DECIMAL_SETTINGVALUE); break;
       }
     }
@@ -364,6 +398,8 @@ void report_gcode_modes()
   if (gc_state.modal.motion >= MOTION_MODE_PROBE_TOWARD) {
     printPgmString(PSTR("38."));
     print_uint8_base10(gc_state.modal.motion - (MOTION_MODE_PROBE_TOWARD-2));
+  } else if (gc_state.modal.motion == MOTION_MODE_QUADRATIC_SPLINE) {
+    printPgmString(PSTR("5.1"));
   } else {
     print_uint8_base10(gc_state.modal.motion);
   }
@@ -383,6 +419,13 @@ void report_gcode_modes()
   report_util_gcode_modes_G();
   print_uint8_base10(94-gc_state.modal.feed_rate);
 
+  #ifdef ENABLE_PATH_BLENDING
+    if (gc_state.modal.control == CONTROL_MODE_CONTINUOUS) {
+      report_util_gcode_modes_G();
+      print_uint8_base10(64);
+    }
+  #endif
+
   if (gc_state.modal.program_flow) {
     report_util_gcode_modes_M();
     switch (gc_state.modal.program_flow) {
@@ -526,7 +569,7 @@ void report_build_info(char *line)
   printPgmString(PSTR("[OPT:")); // Generate compile-time build option list
   //--------------------------------------------------------------------
   // ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789*$# => Option letter
-  // ! !!! !!!  !!! !!! ! !!  !!         !!! => ! = Used
+  // !!!!! !!!  !!! !!! ! !!  !!         !!! => ! = Used
   //--------------------------------------------------------------------
   
   serial_write('V'); // Variable spindle, standard.
@@ -560,6 +603,9 @@ void report_build_info(char *line)
   #ifdef ALLOW_FEED_OVERRIDE_DURING_PROBE_CYCLES
     serial_write('A');
   #endif
+  #ifdef ENABLE_BINARY_PROTOCOL
+    serial_write('B');
+  #endif
   #ifdef SPINDLE_ENABLE_OFF_WITH_ZERO_SPEED
     serial_write('0');
   #endif
@@ -617,7 +663,7 @@ void report_realtime_status()
 {
   uint8_t idx;
   int32_t current_position[N_AXIS]; // Copy current state of the system position variable
-  memcpy(current_position,sys_position,sizeof(sys_position));
+  st_get_position(current_position);
   float print_position[N_AXIS];
   system_convert_array_steps_to_mpos(print_position,current_position);
 
@@ -737,6 +783,19 @@ void report_realtime_status()
     }
   #endif
 
+  #ifdef REPORT_FIELD_STARVATION_COUNTERS
+    printPgmString(PSTR("|St:"));
+    uint8_t sreg = SREG;
+    cli();
+    starvation_t starvation = sys_starvation; // Segment counter updated by the stepper ISR.
+    SREG = sreg;
+    print_uint32_base10(starvation.serial);
+    serial_write(',');
+    print_uint32_base10(starvation.planner);
+    serial_write(',');
+    print_uint32_base10(starvation.segment);
+  #endif
+
   #ifdef DEBUG
     printPgmString(PSTR("|Dbg:"));
     // Other debugs here...
@@ -841,6 +900,59 @@ void printDgState(uint8_t dg_state)
 }
 
 
+#ifdef STEPPER_ISR_PROFILER
+
+// Prints the stepper ISR profile for each AMASS level, with all times in CPU cycles, as
+// [ISR:L<level>|N:<ticks>|Cyc:<min>,<mean>,<max>|Lat:<max latency>|Ovr:<overruns>|H:<histogram bins>]
+// Levels without any ISR tick since the last report only print their tick count. Followed by the
+// main loop time to prepare each step segment, as [PREP:N:<segments>|Cyc:<min>,<mean>,<max>]
+void report_isr_profile()
+{
+  st_isr_profile_t profile[ISR_PROFILE_LEVELS];
+  uint8_t level, idx;
+  st_isr_profile_fetch(profile);
+  for (level = 0; level < ISR_PROFILE_LEVELS; level++) {
+    printPgmString(PSTR("[ISR:L"));
+    print_uint8_base10(level);
+    printPgmString(PSTR("|N:"));
+    print_uint32_base10(profile[level].count);
+    if (profile[level].count) {
+      printPgmString(PSTR("|Cyc:"));
+      print_uint16_base10(profile[level].min);
+      serial_write(',');
+      print_uint16_base10(profile[level].sum/profile[level].count);
+      serial_write(',');
+      print_uint16_base10(profile[level].max);
+      printPgmString(PSTR("|Lat:"));
+      print_uint16_base10(profile[level].latency_max);
+      printPgmString(PSTR("|Ovr:"));
+      print_uint16_base10(profile[level].overruns);
+      printPgmString(PSTR("|H:"));
+      for (idx = 0; idx < ISR_PROFILE_BINS; idx++) {
+        if (idx) { serial_write(','); }
+        print_uint16_base10(profile[level].histogram[idx]);
+      }
+    }
+    report_util_feedback_line_feed();
+  }
+
+  st_prep_profile_t prep_profile;
+  st_prep_profile_fetch(&prep_profile);
+  printPgmString(PSTR("[PREP:N:"));
+  print_uint32_base10(prep_profile.count);
+  if (prep_profile.count) {
+    printPgmString(PSTR("|Cyc:"));
+    print_uint32_base10(prep_profile.min);
+    serial_write(',');
+    print_uint32_base10(prep_profile.sum/prep_profile.count);
+    serial_write(',');
+    print_uint32_base10(prep_profile.max);
+  }
+  report_util_feedback_line_feed();
+}
+
+#endif // STEPPER_ISR_PROFILER
+
 #ifdef DEBUG
 
 // Report debug string on serial
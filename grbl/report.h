@@ -40,6 +40,8 @@
 #define STATUS_TRAVEL_EXCEEDED 15
 #define STATUS_INVALID_JOG_COMMAND 16
 #define STATUS_SETTING_DISABLED_LASER 17
+#define STATUS_FRAME_ERROR 18
+#define STATUS_BAUD_RATE_ERROR 19
 
 #define STATUS_GCODE_UNSUPPORTED_COMMAND 20
 #define STATUS_GCODE_MODAL_GROUP_VIOLATION 21
@@ -84,10 +86,16 @@
 #define MESSAGE_RESTORE_DEFAULTS 9
 #define MESSAGE_SPINDLE_RESTORE 10
 #define MESSAGE_SLEEP_MODE 11
+#define MESSAGE_BAUD_RATE_SWITCH 12
 
 // Prints system status messages.
 void report_status_message(uint8_t status_code);
 
+#ifdef ENABLE_BINARY_PROTOCOL
+  // Sends a binary frame ack with the status code, in place of the status message.
+  void report_frame_ack(uint8_t status_code);
+#endif
+
 // Prints system alarm messages.
 void report_alarm_message(uint8_t alarm_code);
 
@@ -130,6 +138,11 @@ void report_build_info(char *line);
 void report_digital_status(uint8_t dg_state);
 void printDgState(uint8_t dg_state);
 
+#ifdef STEPPER_ISR_PROFILER
+  // Prints and clears the stepper ISR profile.
+  void report_isr_profile();
+#endif
+
 #ifdef DEBUG
   void report_debug_string(char *line);
   void report_debug_int_8(uint8_t val, ...);
@@ -29,10 +29,24 @@ volatile uint8_t serial_rx_buffer[RX_RING_BUFFER];
 volatile uint8_t serial_rx_buffer_head = 0;
 volatile uint8_t serial_rx_buffer_tail = 0;
 
+static uint32_t serial_baud_rate;
+
 uint8_t serial_tx_buffer[TX_RING_BUFFER];
 uint8_t serial_tx_buffer_head = 0;
 volatile uint8_t serial_tx_buffer_tail = 0;
 
+#ifdef ENABLE_BINARY_PROTOCOL
+  // Binary frame reception state of the RX interrupt. Frame data is stored as received, escapes
+  // included. The main loop removes the escapes.
+  #define SERIAL_FRAME_OFF    0 // Line protocol.
+  #define SERIAL_FRAME_IDLE   1 // Binary protocol, between frames.
+  #define SERIAL_FRAME_LENGTH 2 // Frame started, expecting its length.
+  #define SERIAL_FRAME_DATA   3 // Receiving frame data.
+  #define SERIAL_FRAME_ESCAPED bit(7) // Flag. The next byte is escaped.
+  static volatile uint8_t serial_rx_frame_state = SERIAL_FRAME_OFF;
+  static uint8_t serial_rx_frame_remaining; // Frame data bytes left to receive.
+#endif
+
 
 // Returns the number of bytes available in the RX serial buffer.
 uint8_t serial_get_rx_buffer_available()
@@ -75,6 +89,7 @@ void serial_init()
   #endif
   UBRR0H = UBRR0_value >> 8;
   UBRR0L = UBRR0_value;
+  serial_baud_rate = BAUD_RATE;
 
   // enable rx, tx, and interrupt on complete reception of a byte
   UCSR0B |= (1<<RXEN0 | 1<<TXEN0 | 1<<RXCIE0);
@@ -83,6 +98,44 @@ void serial_init()
 }
 
 
+// Returns the USART clock divider (UBRR0+1) for a baud rate with the baud doubler on, which samples
+// 8 times per bit, or zero if it's off by more than SERIAL_BAUD_MAX_ERROR.
+static uint16_t serial_get_baud_divider(uint32_t baud_rate)
+{
+  if ((baud_rate == 0) || (baud_rate > F_CPU/8)) { return(0); }
+  uint32_t divider = (F_CPU + 4*baud_rate)/(8*baud_rate); // Rounded
+  if (divider > 4096) { return(0); } // UBRR0 is 12-bit.
+  uint32_t actual_rate = F_CPU/(8*divider);
+  uint32_t error = (actual_rate > baud_rate) ? (actual_rate-baud_rate) : (baud_rate-actual_rate);
+  if (1000*error > SERIAL_BAUD_MAX_ERROR*baud_rate) { return(0); }
+  return(divider);
+}
+
+
+uint8_t serial_check_baud_rate(uint32_t baud_rate)
+{
+  return(serial_get_baud_divider(baud_rate) != 0);
+}
+
+
+uint8_t serial_set_baud_rate(uint32_t baud_rate)
+{
+  uint16_t divider = serial_get_baud_divider(baud_rate);
+  if (divider == 0) { return(false); }
+  UCSR0A |= (1 << U2X0);
+  UBRR0H = (divider-1) >> 8;
+  UBRR0L = (divider-1);
+  serial_baud_rate = baud_rate;
+  return(true);
+}
+
+
+uint32_t serial_get_baud_rate()
+{
+  return(serial_baud_rate);
+}
+
+
 // Writes one byte to the TX serial buffer. Called by main program.
 void serial_write(uint8_t data) {
   // Calculate next head
@@ -141,15 +194,67 @@ uint8_t serial_read()
 }
 
 
+// Writes a received byte to the RX serial buffer. Called only by the RX interrupt.
+static void serial_rx_write(uint8_t data)
+{
+  uint8_t next_head = serial_rx_buffer_head + 1;
+  if (next_head == RX_RING_BUFFER) { next_head = 0; }
+
+  // Write data to buffer unless it is full.
+  if (next_head != serial_rx_buffer_tail) {
+    serial_rx_buffer[serial_rx_buffer_head] = data;
+    serial_rx_buffer_head = next_head;
+  } else {
+    // Indicate serial buffer overflow critical event.
+    system_set_exec_alarm(EXEC_ALARM_SERIAL_RX_OVERFLOW);
+  }
+}
+
+
 ISR(SERIAL_RX)
 {
   uint8_t data = UDR0;
-  uint8_t next_head;
+
+  #ifdef ENABLE_BINARY_PROTOCOL
+    // Inside a binary frame, every byte is data. Only a soft-reset is still picked off, which the
+    // host escapes in frame data, so that a reset always gets through, even from a broken frame.
+    // The host escapes frame starts too, so a bare one restarts the frame count for a new frame.
+    uint8_t frame_state = serial_rx_frame_state;
+    if ((frame_state & ~SERIAL_FRAME_ESCAPED) >= SERIAL_FRAME_LENGTH) {
+      if (data == CMD_RESET) {
+        mc_reset();
+        serial_rx_frame_state = SERIAL_FRAME_OFF;
+        return;
+      }
+      if (data == SERIAL_FRAME_START) {
+        frame_state = SERIAL_FRAME_LENGTH;
+      } else if (data == SERIAL_FRAME_ESCAPE) {
+        frame_state |= SERIAL_FRAME_ESCAPED;
+      } else {
+        if ((frame_state & ~SERIAL_FRAME_ESCAPED) == SERIAL_FRAME_LENGTH) {
+          serial_rx_frame_remaining = data;
+          if (frame_state & SERIAL_FRAME_ESCAPED) { serial_rx_frame_remaining ^= 0x20; }
+        } else {
+          serial_rx_frame_remaining--;
+        }
+        frame_state = SERIAL_FRAME_DATA;
+        if (serial_rx_frame_remaining == 0) { frame_state = SERIAL_FRAME_IDLE; }
+      }
+      serial_rx_frame_state = frame_state;
+      serial_rx_write(data);
+      return;
+    }
+  #endif
 
   // Pick off realtime command characters directly from the serial stream. These characters are
   // not passed into the main buffer, but these set system state flag bits for realtime execution.
   switch (data) {
-    case CMD_RESET:         mc_reset(); break;     // Call motion control reset routine (soft reset).
+    case CMD_RESET:
+      mc_reset(); // Call motion control reset routine (soft reset).
+      #ifdef ENABLE_BINARY_PROTOCOL
+        serial_rx_frame_state = SERIAL_FRAME_OFF;
+      #endif
+      break;
     case CMD_STATUS_REPORT: system_set_exec_state_flag(EXEC_STATUS_REPORT); break; // Set as true
     case CMD_CYCLE_START:   system_set_exec_state_flag(EXEC_CYCLE_START); break; // Set as true
     case CMD_FEED_HOLD:     system_set_exec_state_flag(EXEC_FEED_HOLD); break; // Set as true
@@ -166,6 +271,28 @@ ISR(SERIAL_RX)
           #ifdef DEBUG
             case CMD_DEBUG_REPORT: {uint8_t sreg = SREG; cli(); bit_true(sys_rt_exec_debug,EXEC_DEBUG_REPORT); SREG = sreg;} break;
           #endif
+          #ifdef STEPPER_ISR_PROFILER
+            case CMD_ISR_PROFILE_REPORT: {uint8_t sreg = SREG; cli(); bit_true(sys_rt_exec_debug,EXEC_ISR_PROFILE_REPORT); SREG = sreg;} break;
+          #endif
+          #ifdef REPORT_FIELD_STARVATION_COUNTERS
+            case CMD_STARVATION_RESET: {uint8_t sreg = SREG; cli(); bit_true(sys_rt_exec_debug,EXEC_STARVATION_RESET); SREG = sreg;} break;
+          #endif
+          #ifdef ENABLE_BINARY_PROTOCOL
+            // The mode change is also passed to the serial buffer, so the main program switches
+            // protocols exactly at this point of the stream.
+            case CMD_BINARY_MODE_ENTER:
+              if (frame_state == SERIAL_FRAME_OFF) {
+                serial_rx_frame_state = SERIAL_FRAME_IDLE;
+                serial_rx_write(data);
+              }
+              break;
+            case CMD_BINARY_MODE_EXIT:
+              if (frame_state == SERIAL_FRAME_IDLE) {
+                serial_rx_frame_state = SERIAL_FRAME_OFF;
+                serial_rx_write(data);
+              }
+              break;
+          #endif
           case CMD_FEED_OVR_RESET: system_set_exec_motion_override_flag(EXEC_FEED_OVR_RESET); break;
           case CMD_FEED_OVR_COARSE_PLUS: system_set_exec_motion_override_flag(EXEC_FEED_OVR_COARSE_PLUS); break;
           case CMD_FEED_OVR_COARSE_MINUS: system_set_exec_motion_override_flag(EXEC_FEED_OVR_COARSE_MINUS); break;
@@ -184,18 +311,18 @@ ISR(SERIAL_RX)
           case CMD_COOLANT_MIST_OVR_TOGGLE: system_set_exec_accessory_override_flag(EXEC_COOLANT_MIST_OVR_TOGGLE); break;
         }
         // Throw away any unfound extended-ASCII character by not passing it to the serial buffer.
-      } else { // Write character to buffer
-        next_head = serial_rx_buffer_head + 1;
-        if (next_head == RX_RING_BUFFER) { next_head = 0; }
-
-        // Write data to buffer unless it is full.
-        if (next_head != serial_rx_buffer_tail) {
-          serial_rx_buffer[serial_rx_buffer_head] = data;
-          serial_rx_buffer_head = next_head;
-        } else {
-          // Indicate serial buffer overflow critical event.
-          system_set_exec_alarm(EXEC_ALARM_SERIAL_RX_OVERFLOW);
-        }
+      } else {
+        #ifdef ENABLE_BINARY_PROTOCOL
+          if (frame_state == SERIAL_FRAME_IDLE) {
+            // Between binary frames, only a frame start is passed on. Anything else is thrown away.
+            if (data == SERIAL_FRAME_START) {
+              serial_rx_frame_state = SERIAL_FRAME_LENGTH;
+              serial_rx_write(data);
+            }
+            break;
+          }
+        #endif
+        serial_rx_write(data); // Write character to buffer
       }
   }
 }
@@ -207,6 +334,14 @@ void serial_reset_read_buffer()
 }
 
 
+#ifdef ENABLE_BINARY_PROTOCOL
+  void serial_reset_frame_mode()
+  {
+    serial_rx_frame_state = SERIAL_FRAME_OFF;
+  }
+#endif
+
+
 void serial_putstring(char* StringPtr)
 {
   int i;
@@ -33,9 +33,40 @@
 
 #define SERIAL_NO_DATA 0xff
 
+// Largest error allowed for a baud rate, in 0.1%. The baud doubler is always on, which gives 250k,
+// 500k and 1M baud without error at 16MHz. The 115200 baud default is 2.1% off.
+#ifndef SERIAL_BAUD_MAX_ERROR
+  #define SERIAL_BAUD_MAX_ERROR 25
+#endif
+// Time given to the host to confirm a baud rate switch by $B=, before returning to the previous rate.
+#ifndef SERIAL_BAUD_CONFIRM_TIMEOUT
+  #define SERIAL_BAUD_CONFIRM_TIMEOUT 2000 // msec
+#endif
+
+#ifdef ENABLE_BINARY_PROTOCOL
+  // Binary streaming protocol framing bytes. A frame is the start byte, the frame length and that
+  // many data bytes, the last of which is the CRC-8 of the others. Inside a frame, a soft-reset,
+  // start, escape or 0xFF byte is sent as the escape byte followed by the original byte xor'ed with
+  // 0x20. A bare start byte thus always begins a new frame, even in the middle of a broken one, and
+  // the serial read buffer never holds a 0xFF frame byte that would read as SERIAL_NO_DATA.
+  #define SERIAL_FRAME_START  0x02 // ASCII STX. Starts a host frame.
+  #define SERIAL_FRAME_ESCAPE 0x7D
+  #define SERIAL_FRAME_ACK    0xA5 // Starts an ack frame sent to the host.
+#endif
+
 
 void serial_init();
 
+// Returns true if the USART can generate a baud rate within SERIAL_BAUD_MAX_ERROR.
+uint8_t serial_check_baud_rate(uint32_t baud_rate);
+
+// Switches the USART to a baud rate. Returns false, without a change, if the baud rate isn't
+// within SERIAL_BAUD_MAX_ERROR. NOTE: Doesn't wait for the TX buffer to be sent.
+uint8_t serial_set_baud_rate(uint32_t baud_rate);
+
+// Returns the current baud rate, as set by serial_init() or serial_set_baud_rate().
+uint32_t serial_get_baud_rate();
+
 // Writes one byte to the TX serial buffer. Called by main program.
 void serial_write(uint8_t data);
 
@@ -48,6 +79,11 @@ uint8_t serial_read();
 // Reset and empty data in read buffer. Used by e-stop and reset.
 void serial_reset_read_buffer();
 
+#ifdef ENABLE_BINARY_PROTOCOL
+  // Returns the RX serial interrupt to the line protocol. Called on reset.
+  void serial_reset_frame_mode();
+#endif
+
 // Returns the number of bytes available in the RX serial buffer.
 uint8_t serial_get_rx_buffer_available();
 
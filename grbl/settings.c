@@ -24,6 +24,11 @@
 
 settings_t settings;
 
+#ifdef CACHE_COORD_DATA_IN_RAM
+  static float coord_cache[SETTING_INDEX_NCOORD+1][N_AXIS]; // RAM copy of the EEPROM coordinate data
+  static uint16_t coord_read_fail; // Bit set, if the EEPROM data failed its checksum when loaded.
+#endif
+
 const __flash settings_t defaults = {
 	.pulse_microseconds = DEFAULT_STEP_PULSE_MICROSECONDS,
 	.stepper_idle_lock_time = DEFAULT_STEPPER_IDLE_LOCK_TIME,
@@ -47,6 +52,26 @@ const __flash settings_t defaults = {
 	.homing_seek_rate = DEFAULT_HOMING_SEEK_RATE,
 	.homing_debounce_delay = DEFAULT_HOMING_DEBOUNCE_DELAY,
 	.homing_pulloff = DEFAULT_HOMING_PULLOFF,
+	.baud_rate = DEFAULT_BAUD_RATE,
+#ifdef ENABLE_S_CURVE_ACCELERATION
+	.jerk[AXIS_1] = DEFAULT_AXIS_JERK,
+	.jerk[AXIS_2] = DEFAULT_AXIS_JERK,
+	.jerk[AXIS_3] = DEFAULT_AXIS_JERK,
+#if N_AXIS > 3
+	.jerk[AXIS_4] = DEFAULT_AXIS_JERK,
+#endif
+#if N_AXIS > 4
+	.jerk[AXIS_5] = DEFAULT_AXIS_JERK,
+#endif
+#if N_AXIS > 5
+	.jerk[AXIS_6] = DEFAULT_AXIS_JERK,
+#endif
+#endif
+#ifdef ENABLE_INPUT_SHAPING
+	.input_shaper_type = DEFAULT_INPUT_SHAPER_TYPE,
+	.input_shaper_frequency = DEFAULT_INPUT_SHAPER_FREQUENCY,
+	.input_shaper_damping = DEFAULT_INPUT_SHAPER_DAMPING,
+#endif
 	.flags = (DEFAULT_REPORT_INCHES << BIT_REPORT_INCHES) |
 			 (DEFAULT_LASER_MODE << BIT_LASER_MODE) |
 			 (DEFAULT_INVERT_ST_ENABLE << BIT_INVERT_ST_ENABLE) |
@@ -96,7 +121,7 @@ const __flash settings_t defaults = {
 // Method to store startup lines into EEPROM
 void settings_store_startup_line(uint8_t n, char* line)
 {
-#ifdef FORCE_BUFFER_SYNC_DURING_EEPROM_WRITE
+#if defined(FORCE_BUFFER_SYNC_DURING_EEPROM_WRITE) && !defined(USE_EEPROM_WRITE_QUEUE)
 	protocol_buffer_synchronize(); // A startup line may contain a motion and be executing.
 #endif
 	uint32_t addr = n * (LINE_BUFFER_SIZE + 1) + EEPROM_ADDR_STARTUP_BLOCK;
@@ -116,11 +141,15 @@ void settings_store_build_info(char* line)
 // Method to store coord data parameters into EEPROM
 void settings_write_coord_data(uint8_t coord_select, float* coord_data)
 {
-#ifdef FORCE_BUFFER_SYNC_DURING_EEPROM_WRITE
+#if defined(FORCE_BUFFER_SYNC_DURING_EEPROM_WRITE) && !defined(USE_EEPROM_WRITE_QUEUE)
 	protocol_buffer_synchronize();
 #endif
 	uint32_t addr = coord_select * (sizeof(float) * N_AXIS + 1) + EEPROM_ADDR_PARAMETERS;
 	memcpy_to_eeprom_with_checksum(addr, (char*)coord_data, sizeof(float) * N_AXIS);
+#ifdef CACHE_COORD_DATA_IN_RAM
+	memcpy(coord_cache[coord_select], coord_data, sizeof(float) * N_AXIS);
+	coord_read_fail &= ~bit(coord_select);
+#endif
 }
 
 
@@ -193,7 +222,11 @@ uint8_t settings_read_build_info(char* line)
 
 
 // Read selected coordinate data from EEPROM. Updates pointed coord_data value.
+#ifdef CACHE_COORD_DATA_IN_RAM
+static uint8_t settings_load_coord_data(uint8_t coord_select, float* coord_data)
+#else
 uint8_t settings_read_coord_data(uint8_t coord_select, float* coord_data)
+#endif
 {
 	uint32_t addr = coord_select * (sizeof(float) * N_AXIS + 1) + EEPROM_ADDR_PARAMETERS;
 	if (!(memcpy_from_eeprom_with_checksum((char*)coord_data, addr, sizeof(float) * N_AXIS))) {
@@ -206,6 +239,21 @@ uint8_t settings_read_coord_data(uint8_t coord_select, float* coord_data)
 }
 
 
+#ifdef CACHE_COORD_DATA_IN_RAM
+// Read selected coordinate data from the RAM copy. Updates pointed coord_data value. Fails once, if the
+// EEPROM data failed its checksum at startup and was reset to zero, as a read from EEPROM would have.
+uint8_t settings_read_coord_data(uint8_t coord_select, float* coord_data)
+{
+	memcpy(coord_data, coord_cache[coord_select], sizeof(float) * N_AXIS);
+	if (coord_read_fail & bit(coord_select)) {
+		coord_read_fail &= ~bit(coord_select);
+		return(false);
+	}
+	return(true);
+}
+#endif
+
+
 // Reads Grbl global settings struct from EEPROM.
 uint8_t read_global_settings() {
 	// Check version-byte of eeprom
@@ -249,6 +297,9 @@ uint8_t settings_store_global_setting(uint8_t parameter, float value) {
 					break;
 				case 2: settings.acceleration[parameter] = value * 60 * 60; break; // Convert to mm/min^2 for grbl internal use.
 				case 3: settings.max_travel[parameter] = -value; break;  // Store as negative for grbl internal use.
+#ifdef ENABLE_S_CURVE_ACCELERATION
+				case 4: settings.jerk[parameter] = value * 60 * 60 * 60; break; // Convert to mm/min^3 for grbl internal use.
+#endif
 				case 5: settings.endstop_adj[parameter] = value; break;
 				}
 				break; // Exit while-loop after setting has been configured and proceed to the EEPROM write call.
@@ -338,6 +389,27 @@ uint8_t settings_store_global_setting(uint8_t parameter, float value) {
 #ifdef USE_OUTPUT_PWM
 		case 35: settings.volts_max = value; output_pwm_init(); break;
 		case 36: settings.volts_min = value; output_pwm_init(); break;
+#endif
+		case 40: // Takes effect at power-up. Switch now with $B= instead.
+			if ((value > F_CPU/8) || !serial_check_baud_rate(value)) { return(STATUS_BAUD_RATE_ERROR); }
+			settings.baud_rate = value;
+			break;
+#ifdef ENABLE_INPUT_SHAPING
+		case 41:
+			if (int_value > INPUT_SHAPER_EI) { return(STATUS_INVALID_STATEMENT); }
+			settings.input_shaper_type = int_value;
+			st_generate_input_shaper();
+			break;
+		case 42:
+			if (value < 1.0) { return(STATUS_INVALID_STATEMENT); }
+			settings.input_shaper_frequency = value;
+			st_generate_input_shaper();
+			break;
+		case 43:
+			if (value >= 1.0) { return(STATUS_INVALID_STATEMENT); }
+			settings.input_shaper_damping = value;
+			st_generate_input_shaper();
+			break;
 #endif
 		default:
 			return(STATUS_INVALID_STATEMENT);
@@ -362,6 +434,14 @@ void settings_init() {
 		report_debug_string("settings_init() Ok.");
 	}
 #endif
+#ifdef CACHE_COORD_DATA_IN_RAM
+	uint8_t idx;
+	float coord_data[N_AXIS];
+	for (idx = 0; idx <= SETTING_INDEX_NCOORD; idx++) {
+		if (!settings_load_coord_data(idx, coord_data)) { coord_read_fail |= bit(idx); }
+		memcpy(coord_cache[idx], coord_data, sizeof(coord_data));
+	}
+#endif
 }
 
 
@@ -419,6 +499,7 @@ uint8_t get_min_limit_pin_mask(uint8_t axis_idx)
 	return((1 << MIN_LIMIT_BIT(AXIS_3)));
 }
 
+#ifdef MAX_LIMIT_BIT // Max limit pins are only mapped for the RAMPS board.
 uint8_t get_max_limit_pin_mask(uint8_t axis_idx)
 {
 	if (axis_idx == AXIS_1) { return((1 << MAX_LIMIT_BIT(AXIS_1))); }
@@ -434,4 +515,5 @@ uint8_t get_max_limit_pin_mask(uint8_t axis_idx)
 #endif
 	return((1 << MAX_LIMIT_BIT(AXIS_3)));
 }
+#endif
 
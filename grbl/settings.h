@@ -31,7 +31,7 @@
 
 // Version of the EEPROM data. Will be used to migrate existing data from older versions of Grbl
 // when firmware is upgraded. Always stored in byte 0 of eeprom
-#define SETTINGS_VERSION 10  // NOTE: Check settings_reset() when moving to next version.
+#define SETTINGS_VERSION 11  // NOTE: Check settings_reset() when moving to next version.
 
 // Define bit flag masks for the boolean settings in settings.flag.
 #define BIT_REPORT_INCHES      0
@@ -56,6 +56,12 @@
 #define BITFLAG_RT_STATUS_POSITION_TYPE     bit(0)
 #define BITFLAG_RT_STATUS_BUFFER_STATE      bit(1)
 
+// Define input shaper types of the settings.input_shaper_type setting.
+#define INPUT_SHAPER_NONE 0
+#define INPUT_SHAPER_ZV   1
+#define INPUT_SHAPER_ZVD  2
+#define INPUT_SHAPER_EI   3
+
 // Define settings restore bitflags.
 #define SETTINGS_RESTORE_DEFAULTS bit(0)
 #define SETTINGS_RESTORE_PARAMETERS bit(1)
@@ -120,6 +126,17 @@ typedef struct {
   float homing_seek_rate;
   uint16_t homing_debounce_delay;
   float homing_pulloff;
+
+  uint32_t baud_rate;
+
+  #ifdef ENABLE_S_CURVE_ACCELERATION
+    float jerk[N_AXIS]; // Axis jerk in (mm/min^3)
+  #endif
+  #ifdef ENABLE_INPUT_SHAPING
+    uint8_t input_shaper_type;
+    float input_shaper_frequency; // Resonance frequency in (Hz)
+    float input_shaper_damping;   // Resonance damping ratio
+  #endif
 } settings_t;
 extern settings_t settings;
 
@@ -30,7 +30,10 @@ volatile uint8_t sleep_counter;
 // Initialize sleep counters and enable timer.
 static void sleep_enable() { 
   sleep_counter = 0; // Reset sleep counter
+  // Timer3 also times the stepper idle lock. Keep its pending compare deadline the same distance ahead.
+  uint16_t idle_lock_ticks = OCR3B - TCNT3;
   TCNT3 = 0;  // Reset timer3 counter register
+  OCR3B = idle_lock_ticks;
   TIMSK3 |= (1<<TOIE3); // Enable timer3 overflow interrupt
 } 
 
@@ -96,6 +96,10 @@ uint8_t spindle_get_state()
 // Called by spindle_init(), spindle_set_speed(), spindle_set_state(), and mc_reset().
 void spindle_stop()
 {
+  #ifdef ENABLE_INLINE_OUTPUT_CHANGES
+    uint8_t sreg = SREG; // The stepper ISR writes these ports too. Keep read-modify-writes atomic.
+    cli();
+  #endif
   #ifdef SEPARATE_SPINDLE_LASER_PIN
     if (settings.flags & BITFLAG_LASER_MODE) {
       LASER_TCCRA_REGISTER &= ~(1<<LASER_COMB_BIT); // Disable PWM. Output voltage is zero.
@@ -110,6 +114,9 @@ void spindle_stop()
   #ifdef SEPARATE_SPINDLE_LASER_PIN
     }
   #endif
+  #ifdef ENABLE_INLINE_OUTPUT_CHANGES
+    SREG = sreg;
+  #endif
 }
 
 
@@ -117,6 +124,10 @@ void spindle_stop()
 // and stepper ISR. Keep routine small and efficient.
 void spindle_set_speed(uint16_t pwm_value)
 {
+  #ifdef ENABLE_INLINE_OUTPUT_CHANGES
+    uint8_t sreg = SREG;
+    cli();
+  #endif
   #ifdef SEPARATE_SPINDLE_LASER_PIN
     if (settings.flags & BITFLAG_LASER_MODE) {
       LASER_OCR_REGISTER = pwm_value; // Set PWM output level.
@@ -157,6 +168,9 @@ void spindle_set_speed(uint16_t pwm_value)
   #ifdef SEPARATE_SPINDLE_LASER_PIN
     }
   #endif
+  #ifdef ENABLE_INLINE_OUTPUT_CHANGES
+    SREG = sreg;
+  #endif
 }
 
 
@@ -277,11 +291,18 @@ void spindle_set_state(uint8_t state, float rpm)
   
   } else {
   
+    #ifdef ENABLE_INLINE_OUTPUT_CHANGES
+      uint8_t sreg = SREG;
+      cli();
+    #endif
     if (state == SPINDLE_ENABLE_CW) {
       SPINDLE_DIRECTION_PORT &= ~(1<<SPINDLE_DIRECTION_BIT);
     } else {
       SPINDLE_DIRECTION_PORT |= (1<<SPINDLE_DIRECTION_BIT);
     }
+    #ifdef ENABLE_INLINE_OUTPUT_CHANGES
+      SREG = sreg;
+    #endif
 
     // NOTE: Assumes all calls to this function is when Grbl is not moving or must remain off.
     if (settings.flags & BITFLAG_LASER_MODE) { 
@@ -290,11 +311,18 @@ void spindle_set_state(uint8_t state, float rpm)
     spindle_set_speed(spindle_compute_pwm_value(rpm));
 
     #ifndef SPINDLE_ENABLE_OFF_WITH_ZERO_SPEED
+      #ifdef ENABLE_INLINE_OUTPUT_CHANGES
+        sreg = SREG;
+        cli();
+      #endif
       #ifdef INVERT_SPINDLE_ENABLE_PIN
         SPINDLE_ENABLE_PORT &= ~(1<<SPINDLE_ENABLE_BIT);
       #else
         SPINDLE_ENABLE_PORT |= (1<<SPINDLE_ENABLE_BIT);
       #endif   
+      #ifdef ENABLE_INLINE_OUTPUT_CHANGES
+        SREG = sreg;
+      #endif
     #endif
   
   }
@@ -303,6 +331,32 @@ void spindle_set_state(uint8_t state, float rpm)
 }
 
 
+#ifdef ENABLE_INLINE_OUTPUT_CHANGES
+  // Sets the spindle direction and enable pins, when the stepper ISR starts a planner block that
+  // changed the spindle state. The PWM output follows the step segments. Keep routine small.
+  void spindle_set_block_state(uint8_t state)
+  {
+    if (state == SPINDLE_DISABLE) {
+      spindle_stop();
+    } else {
+      if (state == SPINDLE_ENABLE_CW) {
+        SPINDLE_DIRECTION_PORT &= ~(1<<SPINDLE_DIRECTION_BIT);
+      } else {
+        SPINDLE_DIRECTION_PORT |= (1<<SPINDLE_DIRECTION_BIT);
+      }
+      #ifndef SPINDLE_ENABLE_OFF_WITH_ZERO_SPEED
+        #ifdef INVERT_SPINDLE_ENABLE_PIN
+          SPINDLE_ENABLE_PORT &= ~(1<<SPINDLE_ENABLE_BIT);
+        #else
+          SPINDLE_ENABLE_PORT |= (1<<SPINDLE_ENABLE_BIT);
+        #endif
+      #endif
+    }
+    sys.report_ovr_counter = 0; // Set to report change immediately
+  }
+#endif
+
+
 // G-code parser entry-point for setting spindle state. Forces a planner buffer sync and bails 
 // if an abort or check-mode is active.
 void spindle_sync(uint8_t state, float rpm)
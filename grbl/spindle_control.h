@@ -51,6 +51,11 @@ void spindle_set_state(uint8_t state, float rpm);
 // NOTE: Mega2560 PWM register is 16-bit.
 void spindle_set_speed(uint16_t pwm_value);
 
+#ifdef ENABLE_INLINE_OUTPUT_CHANGES
+  // Sets spindle direction and enable pins for the stepper ISR at a planner block start.
+  void spindle_set_block_state(uint8_t state);
+#endif
+
 // Computes Mega2560-specific PWM register value for the given RPM for quick updating.
 uint16_t spindle_compute_pwm_value(float rpm);
   
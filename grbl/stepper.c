@@ -25,6 +25,11 @@
 
 // Some useful constants.
 #define DT_SEGMENT (1.0/(ACCELERATION_TICKS_PER_SECOND*60.0)) // min/segment
+#if defined(ENABLE_INPUT_SHAPING) && (ACCELERATION_TICKS_PER_SECOND < 200)
+  #define DT_SHAPED_SEGMENT (1.0/(200*60.0)) // min/segment. At most 5ms, to follow the shaper impulses.
+#else
+  #define DT_SHAPED_SEGMENT DT_SEGMENT
+#endif
 #define REQ_MM_INCREMENT_SCALAR 1.25
 #define RAMP_ACCEL 0
 #define RAMP_CRUISE 1
@@ -36,6 +41,12 @@
 #define PREP_FLAG_PARKING bit(2)
 #define PREP_FLAG_DECEL_OVERRIDE bit(3)
 
+#ifdef USE_FIXED_POINT_MOTION
+  #define FP_SEGMENT_TIME 65536L // DT_SEGMENT in Q16.16 segments
+  #define FP_CYCLES_PER_SEGMENT (F_CPU/ACCELERATION_TICKS_PER_SECOND)
+  #define FP_REQ_STEP_INCREMENT ((int64_t)(REQ_MM_INCREMENT_SCALAR*4294967296.0)) // Q32.32 steps
+#endif
+
 // Define Adaptive Multi-Axis Step-Smoothing(AMASS) levels and cutoff frequencies. The highest level
 // frequency bin starts at 0Hz and ends at its cutoff frequency. The next lower level frequency bin
 // starts at the next higher cutoff frequency, and so on. The cutoff frequencies for each level must
@@ -51,6 +62,16 @@
 #define AMASS_LEVEL2 (F_CPU/4000) // Over-drives ISR (x4)
 #define AMASS_LEVEL3 (F_CPU/2000) // Over-drives ISR (x8)
 
+// Largest step count of an extended cruise segment, such that the segment step count still fits in
+// 16 bits after the AMASS step multiplication.
+#if SEGMENT_CRUISE_TICKS > 1
+  #ifdef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
+    #define SEGMENT_CRUISE_STEP_LIMIT (0xFFFF >> MAX_AMASS_LEVEL)
+  #else
+    #define SEGMENT_CRUISE_STEP_LIMIT 0xFFFF
+  #endif
+#endif
+
 
 // Stores the planner block Bresenham algorithm execution data for the segments in the segment
 // buffer. Normally, this buffer is partially in-use, but, for the worst case scenario, it will
@@ -61,8 +82,15 @@
 typedef struct {
   uint32_t steps[N_AXIS];
   uint32_t step_event_count;
-  uint8_t direction_bits[N_AXIS];
+  uint8_t direction_bits[N_AXIS]; // Direction pins per direction port group
+  uint8_t axis_direction_bits;    // Planner direction bitmask. Set bits move the axis negative.
   uint8_t is_pwm_rate_adjusted; // Tracks motions that require constant laser power/rate
+  #ifdef ENABLE_INLINE_OUTPUT_CHANGES
+    uint8_t output_condition; // Spindle and coolant condition bits of the planner block
+    uint8_t output_changes;   // Condition bits changed from the previous block. Set as the block starts.
+    uint8_t digital_state;    // Digital output state of the planner block
+    uint8_t digital_changes;  // Digital outputs changed from the previous block
+  #endif
 } st_block_t;
 
 static st_block_t st_block_buffer[SEGMENT_BUFFER_SIZE-1];
@@ -81,6 +109,9 @@ typedef struct {
     uint8_t prescaler;      // Without AMASS, a prescaler is required to adjust for slow timing.
   #endif
   uint16_t spindle_pwm;
+  #if SEGMENT_CRUISE_TICKS > 1
+    uint8_t n_tick;         // Acceleration ticks of an extended cruise segment. Otherwise one.
+  #endif
 } segment_t;
 static segment_t segment_buffer[SEGMENT_BUFFER_SIZE];
 
@@ -110,13 +141,18 @@ typedef struct {
 
   uint8_t execute_step;         // Flags step execution for each interrupt.
   uint8_t step_pulse_time;      // Step pulse reset time after step rise
-  uint8_t step_outbits[N_AXIS]; // The next stepping-bits to be output
-  uint8_t dir_outbits[N_AXIS];
+  uint8_t step_outbits[N_AXIS]; // The next stepping-bits to be output, per step port group
+  #ifdef STEP_PULSE_OUTPUT_COMPARE
+    uint8_t step_oc_outbits;    // Timer5 compare output modes of the next output compare step pulses
+    uint16_t step_oc_start;     // Timer5 count that starts the one-shot step pulse
+  #endif
+  uint8_t dir_outbits[N_AXIS];  // Direction bits to be output, per direction port group
   #ifdef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
     uint32_t steps[N_AXIS];
   #endif
 
   uint16_t step_count;       // Steps remaining in line segment motion
+  uint16_t segment_steps[N_AXIS]; // Steps of each axis in the executing segment, not yet in sys_position
   uint8_t exec_block_index; // Tracks the current st_block index. Change indicates new block.
   st_block_t *exec_block;   // Pointer to the block data for the segment being executed
   segment_t *exec_segment;  // Pointer to the segment being executed
@@ -128,34 +164,183 @@ static volatile uint8_t segment_buffer_tail;
 static uint8_t segment_buffer_head;
 static uint8_t segment_next_head;
 
-// Step and direction port invert masks.
+#if SEGMENT_CRUISE_TICKS > 1
+  // Returns the execution time queued in the segment buffer, in acceleration ticks.
+  static uint16_t st_segment_buffer_ticks()
+  {
+    uint16_t ticks = 0;
+    uint8_t idx = segment_buffer_tail;
+    while (idx != segment_buffer_head) {
+      ticks += segment_buffer[idx].n_tick;
+      if (++idx == SEGMENT_BUFFER_SIZE) { idx = 0; }
+    }
+    return(ticks);
+  }
+#endif
+
+// Axes with the step pin on a Timer5 output compare pin, pulsed by the timer instead of the ports.
+#ifdef STEP_PULSE_OUTPUT_COMPARE
+  #ifdef STEP_OC5A_AXIS
+    #define STEP_OC5A_MASK bit(STEP_OC5A_AXIS)
+  #else
+    #define STEP_OC5A_MASK 0
+  #endif
+  #ifdef STEP_OC5B_AXIS
+    #define STEP_OC5B_MASK bit(STEP_OC5B_AXIS)
+  #else
+    #define STEP_OC5B_MASK 0
+  #endif
+  #ifdef STEP_OC5C_AXIS
+    #define STEP_OC5C_MASK bit(STEP_OC5C_AXIS)
+  #else
+    #define STEP_OC5C_MASK 0
+  #endif
+  #define STEP_OC_AXES_MASK (STEP_OC5A_MASK | STEP_OC5B_MASK | STEP_OC5C_MASK)
+#else
+  #define STEP_OC_AXES_MASK 0
+#endif
+#define STEP_ON_OC(i) (STEP_OC_AXES_MASK & bit(i))
+
+// The Timer0 step pulse reset interrupt ends the pulses of the step pins driven by the ports.
+#if STEP_OC_AXES_MASK != (bit(N_AXIS)-1)
+  #define STEP_PULSE_RESET_INTERRUPT
+#endif
+
+// Axes sharing a physical step or direction port are grouped, so that the stepper ISR writes
+// each port only once per tick. A port group is indexed by the lowest axis on its port. The port
+// addresses are constants, so the groups and their pin masks resolve at compile time.
+#define STEP_PORT_SAME(i,j) (&STEP_PORT(i) == &STEP_PORT(j))
+#define DIRECTION_PORT_SAME(i,j) (&DIRECTION_PORT(i) == &DIRECTION_PORT(j))
+#if N_AXIS > 5
+  #define PORT_GROUP(same,i) (same(i,0) ? 0 : same(i,1) ? 1 : same(i,2) ? 2 : same(i,3) ? 3 : same(i,4) ? 4 : 5)
+  #define PORT_GROUP_MASK(pin,g) (pin(g,0) | pin(g,1) | pin(g,2) | pin(g,3) | pin(g,4) | pin(g,5))
+#elif N_AXIS > 4
+  #define PORT_GROUP(same,i) (same(i,0) ? 0 : same(i,1) ? 1 : same(i,2) ? 2 : same(i,3) ? 3 : 4)
+  #define PORT_GROUP_MASK(pin,g) (pin(g,0) | pin(g,1) | pin(g,2) | pin(g,3) | pin(g,4))
+#elif N_AXIS > 3
+  #define PORT_GROUP(same,i) (same(i,0) ? 0 : same(i,1) ? 1 : same(i,2) ? 2 : 3)
+  #define PORT_GROUP_MASK(pin,g) (pin(g,0) | pin(g,1) | pin(g,2) | pin(g,3))
+#else
+  #define PORT_GROUP(same,i) (same(i,0) ? 0 : same(i,1) ? 1 : 2)
+  #define PORT_GROUP_MASK(pin,g) (pin(g,0) | pin(g,1) | pin(g,2))
+#endif
+#define STEP_PORT_GROUP(i) PORT_GROUP(STEP_PORT_SAME,i)
+#define DIRECTION_PORT_GROUP(i) PORT_GROUP(DIRECTION_PORT_SAME,i)
+#define STEP_GROUP_PIN(g,i) (((STEP_PORT_GROUP(i) == (g)) && !STEP_ON_OC(i)) ? (1<<STEP_BIT(i)) : 0)
+#define DIRECTION_GROUP_PIN(g,i) ((DIRECTION_PORT_GROUP(i) == (g)) ? (1<<DIRECTION_BIT(i)) : 0)
+#define STEP_PORT_GROUP_MASK(g) PORT_GROUP_MASK(STEP_GROUP_PIN,g)
+#define DIRECTION_PORT_GROUP_MASK(g) PORT_GROUP_MASK(DIRECTION_GROUP_PIN,g)
+
+// Writes the bits of a port group through the port of its lowest axis. Does nothing for the
+// other axes of the group.
+#define STEP_PORT_WRITE(g,bits) if ((STEP_PORT_GROUP(g) == (g)) && STEP_PORT_GROUP_MASK(g)) { STEP_PORT(g) = (STEP_PORT(g) & ~STEP_PORT_GROUP_MASK(g)) | (bits); }
+#define DIRECTION_PORT_WRITE(g,bits) if (DIRECTION_PORT_GROUP(g) == (g)) { DIRECTION_PORT(g) = (DIRECTION_PORT(g) & ~DIRECTION_PORT_GROUP_MASK(g)) | (bits); }
+
+// Port group of each axis, for the loops over all axes.
+static const uint8_t step_port_group[N_AXIS] = {
+  STEP_PORT_GROUP(0), STEP_PORT_GROUP(1), STEP_PORT_GROUP(2),
+  #if N_AXIS > 3
+    STEP_PORT_GROUP(3),
+  #endif
+  #if N_AXIS > 4
+    STEP_PORT_GROUP(4),
+  #endif
+  #if N_AXIS > 5
+    STEP_PORT_GROUP(5),
+  #endif
+};
+static const uint8_t direction_port_group[N_AXIS] = {
+  DIRECTION_PORT_GROUP(0), DIRECTION_PORT_GROUP(1), DIRECTION_PORT_GROUP(2),
+  #if N_AXIS > 3
+    DIRECTION_PORT_GROUP(3),
+  #endif
+  #if N_AXIS > 4
+    DIRECTION_PORT_GROUP(4),
+  #endif
+  #if N_AXIS > 5
+    DIRECTION_PORT_GROUP(5),
+  #endif
+};
+
+// Step and direction port invert masks, per port group.
 static uint8_t step_port_invert_mask[N_AXIS];
 static uint8_t dir_port_invert_mask[N_AXIS];
 
+#ifdef STEP_PULSE_OUTPUT_COMPARE
+  // Timer5 compare output mode of the one-shot step pulse of each output compare step pin. Zero
+  // for the other axes.
+  static uint8_t step_oc_com[N_AXIS];
+
+  // Sets the step bit of an axis, in its port group or as its compare output mode.
+  #define STEP_OUTBITS_SET(i) if (STEP_ON_OC(i)) { st.step_oc_outbits |= step_oc_com[i]; } \
+                              else { st.step_outbits[STEP_PORT_GROUP(i)] |= (1<<STEP_BIT(i)); }
+#else
+  #define STEP_OUTBITS_SET(i) st.step_outbits[STEP_PORT_GROUP(i)] |= (1<<STEP_BIT(i))
+#endif
+
 // Used to avoid ISR nesting of the "Stepper Driver Interrupt". Should never occur though.
 static volatile uint8_t busy;
 
+#ifdef STEPPER_ISR_PROFILER
+  // Stepper ISR duration statistics per AMASS level. Written by the stepper ISR only.
+  static st_isr_profile_t isr_profile[ISR_PROFILE_LEVELS];
+  // Step segment preparation time statistics. Written by the main program only.
+  static st_prep_profile_t prep_profile;
+#endif
+
 // Pointers for the step segment being prepped from the planner buffer. Accessed only by the
 // main program. Pointers may be planning segments or planner blocks ahead of what being executed.
 static plan_block_t *pl_block;     // Pointer to the planner block being prepped
+#ifdef REPORT_FIELD_STARVATION_COUNTERS
+  static uint8_t prep_planner_starved; // Planner found empty during the cycle, and counted.
+#endif
 static st_block_t *st_prep_block;  // Pointer to the stepper block data being prepped
 
+#ifdef ENABLE_NATIVE_ARCS
+  // Chord tracing data of the arc block being prepped. Each chord is loaded into its own stepper block,
+  // and the segments end on the chord ends. See st_prep_arc_chord().
+  typedef struct {
+    uint16_t chord;         // Index of the prepped chord end. Counts up to the block arc_chords.
+    float chord_mm;         // Length of a chord along the arc (mm)
+    float chord_end;        // End of the prepped chord measured from end of block (mm). Zero for line blocks.
+    int32_t steps[N_AXIS];  // Axis positions at the end of the prepped chord, relative to the arc start (steps)
+  } st_prep_arc_t;
+#endif
+
 // Segment preparation data struct. Contains all the necessary information to compute new segments
 // based on the current executing planner block.
 typedef struct {
   uint8_t st_block_index;  // Index of stepper common data block being prepped
   uint8_t recalculate_flag;
 
-  float dt_remainder;
-  float steps_remaining;
+  #ifdef USE_FIXED_POINT_MOTION
+    uint32_t dt_remainder;    // Partial step execute time carried to the next segment (CPU cycles)
+    uint32_t steps_remaining; // Whole steps remaining after the prepped segments (steps)
+    int64_t dist_remaining;   // Exact distance remaining in the block (Q32.32 steps)
+  #else
+    float dt_remainder;
+    float steps_remaining;
+  #endif
   float step_per_mm;
   float req_mm_increment;
 
   #ifdef PARKING_ENABLE
     uint8_t last_st_block_index;
-    float last_steps_remaining;
+    #ifdef USE_FIXED_POINT_MOTION
+      uint32_t last_steps_remaining;
+      uint32_t last_dt_remainder;
+      int64_t last_dist_remaining;
+    #else
+      float last_steps_remaining;
+      float last_dt_remainder;
+    #endif
     float last_step_per_mm;
-    float last_dt_remainder;
+    #ifdef ENABLE_NATIVE_ARCS
+      st_prep_arc_t last_arc;
+    #endif
+  #endif
+  #ifdef ENABLE_NATIVE_ARCS
+    st_prep_arc_t arc;
   #endif
 
   uint8_t ramp_type;      // Current segment ramp state
@@ -167,8 +352,44 @@ typedef struct {
   float accelerate_until; // Acceleration ramp end measured from end of block (mm)
   float decelerate_after; // Deceleration ramp start measured from end of block (mm)
 
+  #ifdef SHAPED_RAMPS
+    // Shape of the current acceleration or deceleration ramp. See st_prep_ramp().
+    float ramp_mm;          // Ramp start measured from end of block (mm)
+    float ramp_time;        // Time elapsed in the ramp (min)
+    float ramp_duration;    // Time of the whole ramp (min)
+    float ramp_speed;       // Ramp entry speed (mm/min)
+    float ramp_delta_speed; // Speed change over the ramp, negative when decelerating (mm/min)
+    #ifdef ENABLE_S_CURVE_ACCELERATION
+      float ramp_jerk_time;   // Time of each jerk phase, as a fraction of the ramp time. At most 0.5.
+    #else
+      float ramp_accel_time;  // Time of the unshaped acceleration, convolved with the shaper (min)
+      float ramp_delay;       // Time the shaped acceleration starts after the ramp start (min)
+      uint8_t ramp_shaped;    // False, if the ramp is too short for the shaper and runs unshaped.
+    #endif
+  #endif
+
+  #ifdef USE_FIXED_POINT_MOTION
+    // Fixed-point copies of the velocity profile above, used by the segment ramp computations. Speeds
+    // are in Q16.16 steps per segment, the acceleration in Q16.16 steps per segment squared, and
+    // distances in Q32.32 steps from the end of the block.
+    float fp_speed_scale; // Converts mm/min to Q16.16 steps per segment.
+    float fp_mm_scale;    // Converts Q32.32 steps to mm.
+    int32_t fp_acceleration;
+    int32_t fp_current_speed;
+    int32_t fp_maximum_speed;
+    int32_t fp_exit_speed;
+    int64_t fp_mm_complete;
+    int64_t fp_accelerate_until;
+    int64_t fp_decelerate_after;
+  #endif
+
   float inv_rate;    // Used by PWM laser mode to speed up segment calculations.
   uint16_t current_spindle_pwm;
+
+  #ifdef ENABLE_INLINE_OUTPUT_CHANGES
+    uint8_t output_condition; // Spindle and coolant condition bits of the last prepped planner block
+    uint8_t digital_state;    // Digital output state of the last prepped planner block
+  #endif
 } st_prep_t;
 static st_prep_t prep;
 
@@ -212,17 +433,15 @@ static st_prep_t prep;
 */
 
 
-// Stepper state initialization. Cycle should only start if the st.cycle_start flag is
-// enabled. Startup init and limits call this function but shouldn't start the cycle.
+// Timer3 ticks per millisecond for the stepper idle lock. Timer3 free-runs with the 1/64 prescaler
+// set in sleep_init().
+#define IDLE_LOCK_TICKS_PER_MS (F_CPU/64000)
 
-int idx; // GBGB ???
-
-void st_wake_up()
+// Sets the stepper driver enable pins, with the enable invert setting applied.
+static void st_set_drivers_disabled(uint8_t pin_state)
 {
-  int idx;
-
-  // Enable stepper drivers.
-  if (bit_istrue(settings.flags,BITFLAG_INVERT_ST_ENABLE)) {
+  if (bit_istrue(settings.flags,BITFLAG_INVERT_ST_ENABLE)) { pin_state = !pin_state; } // Apply pin invert.
+  if (pin_state) {
     STEPPER_DISABLE_PORT(0) |= (1 << STEPPER_DISABLE_BIT(0));
     STEPPER_DISABLE_PORT(1) |= (1 << STEPPER_DISABLE_BIT(1));
     STEPPER_DISABLE_PORT(2) |= (1 << STEPPER_DISABLE_BIT(2));
@@ -249,20 +468,61 @@ void st_wake_up()
       STEPPER_DISABLE_PORT(5) &= ~(1 << STEPPER_DISABLE_BIT(5));
     #endif
   }
+}
+
+
+// Stepper idle lock timeout. Disables the stepper drivers once the lock time set by st_go_idle()
+// has passed without new motion. One-shot.
+ISR(TIMER3_COMPB_vect)
+{
+  TIMSK3 &= ~(1<<OCIE3B);
+  st_set_drivers_disabled(true);
+}
+
+
+// Stepper state initialization. Cycle should only start if the st.cycle_start flag is
+// enabled. Startup init and limits call this function but shouldn't start the cycle.
+
+int idx; // GBGB ???
+
+void st_wake_up()
+{
+  int idx;
+
+  // Enable stepper drivers. Cancels a pending idle lock disable first.
+  TIMSK3 &= ~(1<<OCIE3B);
+  st_set_drivers_disabled(false);
   // Initialize stepper output bits to ensure first ISR call does not step.
   for (idx = 0; idx < N_AXIS; idx++) {
     st.step_outbits[idx] = step_port_invert_mask[idx];
   }
+  #ifdef STEP_PULSE_OUTPUT_COMPARE
+    st.step_oc_outbits = 0;
+  #endif
 
   // Initialize step pulse timing from settings. Here to ensure updating after re-writing.
-  #ifdef STEP_PULSE_DELAY
-    // Set total step pulse time after direction pin set. Ad hoc computation from oscilloscope.
-    st.step_pulse_time = -(((settings.pulse_microseconds+STEP_PULSE_DELAY-2)*TICKS_PER_MICROSECOND) >> 3);
-    // Set delay between direction pin write and step command.
-    OCR0A = -(((settings.pulse_microseconds)*TICKS_PER_MICROSECOND) >> 3);
-  #else // Normal operation
-    // Set step pulse time. Ad hoc computation from oscilloscope. Uses two's complement.
-    st.step_pulse_time = -(((settings.pulse_microseconds-2)*TICKS_PER_MICROSECOND) >> 3);
+  #ifdef STEP_PULSE_RESET_INTERRUPT
+    #ifdef STEP_PULSE_DELAY
+      // Set total step pulse time after direction pin set. Ad hoc computation from oscilloscope.
+      st.step_pulse_time = -(((settings.pulse_microseconds+STEP_PULSE_DELAY-2)*TICKS_PER_MICROSECOND) >> 3);
+      // Set delay between direction pin write and step command.
+      OCR0A = -(((settings.pulse_microseconds)*TICKS_PER_MICROSECOND) >> 3);
+    #else // Normal operation
+      // Set step pulse time. Ad hoc computation from oscilloscope. Uses two's complement.
+      st.step_pulse_time = -(((settings.pulse_microseconds-2)*TICKS_PER_MICROSECOND) >> 3);
+    #endif
+  #endif
+  #ifdef STEP_PULSE_OUTPUT_COMPARE
+    // The one-shot pulse starts at the compare match and ends when Timer5 wraps to zero. The
+    // counter is started before the match by the step pulse delay, or by one count, as the match
+    // is blocked in the count written.
+    uint16_t compare = -(settings.pulse_microseconds*TICKS_PER_MICROSECOND);
+    OCR5A = OCR5B = OCR5C = compare;
+    #ifdef STEP_PULSE_DELAY
+      st.step_oc_start = compare-(STEP_PULSE_DELAY*TICKS_PER_MICROSECOND);
+    #else
+      st.step_oc_start = compare-1;
+    #endif
   #endif
 
   // Enable Stepper Driver Interrupt
@@ -279,40 +539,20 @@ void st_go_idle()
   busy = false;
 
   // Set stepper driver idle state, disabled or enabled, depending on settings and circumstances.
-  bool pin_state = false; // Keep enabled.
+  TIMSK3 &= ~(1<<OCIE3B); // Cancel any pending idle lock disable.
   if (((settings.stepper_idle_lock_time != 0xff) || sys_rt_exec_alarm || sys.state == STATE_SLEEP) && sys.state != STATE_HOMING) {
     // Force stepper dwell to lock axes for a defined amount of time to ensure the axes come to a complete
-    // stop and not drift from residual inertial forces at the end of the last movement.
-    delay_ms(settings.stepper_idle_lock_time);
-    pin_state = true; // Override. Disable steppers.
-  }
-  if (bit_istrue(settings.flags,BITFLAG_INVERT_ST_ENABLE)) { pin_state = !pin_state; } // Apply pin invert.
-  if (pin_state) {
-    STEPPER_DISABLE_PORT(0) |= (1 << STEPPER_DISABLE_BIT(0));
-    STEPPER_DISABLE_PORT(1) |= (1 << STEPPER_DISABLE_BIT(1));
-    STEPPER_DISABLE_PORT(2) |= (1 << STEPPER_DISABLE_BIT(2));
-    #if N_AXIS > 3
-      STEPPER_DISABLE_PORT(3) |= (1 << STEPPER_DISABLE_BIT(3));
-    #endif
-    #if N_AXIS > 4
-      STEPPER_DISABLE_PORT(4) |= (1 << STEPPER_DISABLE_BIT(4));
-    #endif
-    #if N_AXIS > 5
-      STEPPER_DISABLE_PORT(5) |= (1 << STEPPER_DISABLE_BIT(5));
-    #endif
+    // stop and not drift from residual inertial forces at the end of the last movement. The drivers stay
+    // enabled and the Timer3 compare interrupt disables them, so this returns at once, even in an ISR.
+    if (settings.stepper_idle_lock_time) {
+      OCR3B = TCNT3 + settings.stepper_idle_lock_time*IDLE_LOCK_TICKS_PER_MS;
+      TIFR3 = (1<<OCF3B); // Clear any stale compare match.
+      TIMSK3 |= (1<<OCIE3B);
+    } else {
+      st_set_drivers_disabled(true);
+    }
   } else {
-    STEPPER_DISABLE_PORT(0) &= ~(1 << STEPPER_DISABLE_BIT(0));
-    STEPPER_DISABLE_PORT(1) &= ~(1 << STEPPER_DISABLE_BIT(1));
-    STEPPER_DISABLE_PORT(2) &= ~(1 << STEPPER_DISABLE_BIT(2));
-    #if N_AXIS > 3
-      STEPPER_DISABLE_PORT(3) &= ~(1 << STEPPER_DISABLE_BIT(3));
-    #endif
-    #if N_AXIS > 4
-      STEPPER_DISABLE_PORT(4) &= ~(1 << STEPPER_DISABLE_BIT(4));
-    #endif
-    #if N_AXIS > 5
-      STEPPER_DISABLE_PORT(5) &= ~(1 << STEPPER_DISABLE_BIT(5));
-    #endif
+    st_set_drivers_disabled(false); // Keep enabled.
   }
 }
 
@@ -362,12 +602,89 @@ void st_go_idle()
    ISR is 5usec typical and 25usec maximum, well below requirement.
    NOTE: This ISR expects at least one step to be executed per segment.
 */
-// TODO: Replace direct updating of the int32 position counters in the ISR somehow. Perhaps use smaller
-// int8 variables and update position counters only when a segment completes. This can get complicated
-// with probing and homing cycles that require true real-time positions.
+#ifdef STEPPER_ISR_PROFILER
+  // Records one stepper ISR tick. Timer1 runs unprescaled in CTC mode, so TCNT1 counts CPU cycles
+  // since the last compare match. An exit count below the entry count means the counter has already
+  // wrapped at the next compare match, i.e. the ISR overran its period and the next tick is late.
+  static inline void st_isr_profile_update(uint8_t amass_level, uint16_t entry_count)
+  {
+    uint16_t exit_count = TCNT1;
+    st_isr_profile_t *profile = &isr_profile[amass_level];
+    uint16_t cycles;
+    if (exit_count >= entry_count) { cycles = exit_count - entry_count; }
+    else {
+      cycles = exit_count + OCR1A + 1 - entry_count;
+      profile->overruns++;
+    }
+    if (profile->sum < 0xFFFF0000) { // Stop accumulating before the sum overflows. Keeps the mean valid.
+      profile->sum += cycles;
+      profile->count++;
+    }
+    if ((cycles < profile->min) || (profile->min == 0)) { profile->min = cycles; }
+    if (cycles > profile->max) { profile->max = cycles; }
+    if (entry_count > profile->latency_max) { profile->latency_max = entry_count; }
+    uint8_t bin = min(cycles/ISR_PROFILE_BIN_CYCLES, ISR_PROFILE_BINS-1);
+    if (profile->histogram[bin] != 0xFFFF) { profile->histogram[bin]++; }
+  }
+
+  // Records the time taken to prepare one step segment, from the Timer5 count at its start.
+  static void st_prep_profile_update(uint16_t start_count)
+  {
+    uint32_t cycles = (uint32_t)((uint16_t)(TCNT5 - start_count)) << 3; // Timer5 ticks are 8 cycles.
+    if (prep_profile.sum < 0xFFF00000) { // Stop accumulating before the sum overflows.
+      prep_profile.sum += cycles;
+      prep_profile.count++;
+    }
+    if ((cycles < prep_profile.min) || (prep_profile.min == 0)) { prep_profile.min = cycles; }
+    if (cycles > prep_profile.max) { prep_profile.max = cycles; }
+  }
+#endif
+
+
+// Adds the steps of the executing segment to the machine position and clears them. The direction
+// does not change within a planner block, so the ISR only counts the steps and sys_position is
+// updated once per segment, rather than with a 32-bit increment or decrement per step.
+static void st_update_position()
+{
+  uint8_t idx;
+  for (idx=0; idx<N_AXIS; idx++) {
+    if (st.exec_block->axis_direction_bits & bit(idx)) { sys_position[idx] -= st.segment_steps[idx]; }
+    else { sys_position[idx] += st.segment_steps[idx]; }
+    st.segment_steps[idx] = 0;
+  }
+}
+
+
+#ifdef ENABLE_INLINE_OUTPUT_CHANGES
+  // Sets the spindle, coolant, and digital outputs changed by the starting block. Only the changed
+  // outputs are set, so overrides and M64/M65 changes of the others remain.
+  static void st_set_block_outputs()
+  {
+    uint8_t changes = st.exec_block->output_changes;
+    if (changes & PL_COND_SPINDLE_MASK) {
+      spindle_set_block_state(st.exec_block->output_condition & PL_COND_SPINDLE_MASK);
+    }
+    changes &= (PL_COND_FLAG_COOLANT_FLOOD | PL_COND_FLAG_COOLANT_MIST);
+    if (changes) {
+      coolant_set_state((coolant_get_state() & ~changes) | (st.exec_block->output_condition & changes));
+    }
+    changes = st.exec_block->digital_changes;
+    if (changes) {
+      digital_set_state((digital_get_state() & ~changes) | (st.exec_block->digital_state & changes));
+    }
+  }
+#endif
+
+
+// NOTE: The position counters are updated by st_update_position() when a segment completes. Use
+// st_get_position() for the true real-time position, such as for probing.
 ISR(TIMER1_COMPA_vect)
 {
   int i;
+  #ifdef STEPPER_ISR_PROFILER
+    uint16_t isr_entry_count = TCNT1; // Read first. Also measures the interrupt latency.
+    uint8_t isr_amass_level;
+  #endif
 
   if (busy) { return; } // The busy-flag is used to avoid reentering this interrupt
 
@@ -380,52 +697,60 @@ ISR(TIMER1_COMPA_vect)
   #endif
 
   // Set the direction pins a couple of nanoseconds before we step the steppers
-  DIRECTION_PORT(0) = (DIRECTION_PORT(0) & ~(1 << DIRECTION_BIT(0))) | st.dir_outbits[0];
-  DIRECTION_PORT(1) = (DIRECTION_PORT(1) & ~(1 << DIRECTION_BIT(1))) | st.dir_outbits[1];
-  DIRECTION_PORT(2) = (DIRECTION_PORT(2) & ~(1 << DIRECTION_BIT(2))) | st.dir_outbits[2];
+  DIRECTION_PORT_WRITE(0, st.dir_outbits[0]);
+  DIRECTION_PORT_WRITE(1, st.dir_outbits[1]);
+  DIRECTION_PORT_WRITE(2, st.dir_outbits[2]);
   #if N_AXIS > 3
-  DIRECTION_PORT(3) = (DIRECTION_PORT(3) & ~(1 << DIRECTION_BIT(3))) | st.dir_outbits[3];
+  DIRECTION_PORT_WRITE(3, st.dir_outbits[3]);
   #endif
   #if N_AXIS > 4
-  DIRECTION_PORT(4) = (DIRECTION_PORT(4) & ~(1 << DIRECTION_BIT(4))) | st.dir_outbits[4];
+  DIRECTION_PORT_WRITE(4, st.dir_outbits[4]);
   #endif
   #if N_AXIS > 5
-  DIRECTION_PORT(5) = (DIRECTION_PORT(5) & ~(1 << DIRECTION_BIT(5))) | st.dir_outbits[5];
+  DIRECTION_PORT_WRITE(5, st.dir_outbits[5]);
   #endif
 
   // Then pulse the stepping pins
-  #ifdef STEP_PULSE_DELAY
-    st.step_bits[0] = (STEP_PORT(0) & ~(1 << STEP_BIT(0))) | st.step_outbits[0]; // Store out_bits to prevent overwriting.
-    st.step_bits[1] = (STEP_PORT(1) & ~(1 << STEP_BIT(1))) | st.step_outbits[1]; // Store out_bits to prevent overwriting.
-    st.step_bits[2] = (STEP_PORT(2) & ~(1 << STEP_BIT(2))) | st.step_outbits[2]; // Store out_bits to prevent overwriting.
+  #if defined(STEP_PULSE_DELAY) && defined(STEP_PULSE_RESET_INTERRUPT)
+    st.step_bits[0] = (STEP_PORT(0) & ~STEP_PORT_GROUP_MASK(0)) | st.step_outbits[0]; // Store out_bits to prevent overwriting.
+    if (STEP_PORT_GROUP(1) == 1) { st.step_bits[1] = (STEP_PORT(1) & ~STEP_PORT_GROUP_MASK(1)) | st.step_outbits[1]; }
+    if (STEP_PORT_GROUP(2) == 2) { st.step_bits[2] = (STEP_PORT(2) & ~STEP_PORT_GROUP_MASK(2)) | st.step_outbits[2]; }
     #if N_AXIS > 3
-      st.step_bits[3] = (STEP_PORT(3) & ~(1 << STEP_BIT(3))) | st.step_outbits[3]; // Store out_bits to prevent overwriting.
+      if (STEP_PORT_GROUP(3) == 3) { st.step_bits[3] = (STEP_PORT(3) & ~STEP_PORT_GROUP_MASK(3)) | st.step_outbits[3]; }
     #endif
     #if N_AXIS > 4
-      st.step_bits[4] = (STEP_PORT(4) & ~(1 << STEP_BIT(4))) | st.step_outbits[4]; // Store out_bits to prevent overwriting.
+      if (STEP_PORT_GROUP(4) == 4) { st.step_bits[4] = (STEP_PORT(4) & ~STEP_PORT_GROUP_MASK(4)) | st.step_outbits[4]; }
     #endif
     #if N_AXIS > 5
-      st.step_bits[5] = (STEP_PORT(5) & ~(1 << STEP_BIT(5))) | st.step_outbits[5]; // Store out_bits to prevent overwriting.
+      if (STEP_PORT_GROUP(5) == 5) { st.step_bits[5] = (STEP_PORT(5) & ~STEP_PORT_GROUP_MASK(5)) | st.step_outbits[5]; }
     #endif
   #else
-    STEP_PORT(0) = (STEP_PORT(0) & ~(1 << STEP_BIT(0))) | st.step_outbits[0];
-    STEP_PORT(1) = (STEP_PORT(1) & ~(1 << STEP_BIT(1))) | st.step_outbits[1];
-    STEP_PORT(2) = (STEP_PORT(2) & ~(1 << STEP_BIT(2))) | st.step_outbits[2];
+    STEP_PORT_WRITE(0, st.step_outbits[0]);
+    STEP_PORT_WRITE(1, st.step_outbits[1]);
+    STEP_PORT_WRITE(2, st.step_outbits[2]);
     #if N_AXIS > 3
-      STEP_PORT(3) = (STEP_PORT(3) & ~(1 << STEP_BIT(3))) | st.step_outbits[3];
+      STEP_PORT_WRITE(3, st.step_outbits[3]);
     #endif
     #if N_AXIS > 4
-      STEP_PORT(4) = (STEP_PORT(4) & ~(1 << STEP_BIT(4))) | st.step_outbits[4];
+      STEP_PORT_WRITE(4, st.step_outbits[4]);
     #endif
     #if N_AXIS > 5
-      STEP_PORT(5) = (STEP_PORT(5) & ~(1 << STEP_BIT(5))) | st.step_outbits[5];
+      STEP_PORT_WRITE(5, st.step_outbits[5]);
     #endif
   #endif
 
-  // Enable step pulse reset timer so that The Stepper Port Reset Interrupt can reset the signal after
-  // exactly settings.pulse_microseconds microseconds, independent of the main Timer1 prescaler.
-  TCNT0 = st.step_pulse_time; // Reload Timer0 counter
-  TCCR0B = (1<<CS01); // Begin Timer0. Full speed, 1/8 prescaler
+  #ifdef STEP_PULSE_OUTPUT_COMPARE
+    // Connect the output compare step pins that step and start their Timer5 one-shot pulse.
+    TCCR5A = st.step_oc_outbits | (1<<WGM51);
+    TCNT5 = st.step_oc_start;
+  #endif
+
+  #ifdef STEP_PULSE_RESET_INTERRUPT
+    // Enable step pulse reset timer so that The Stepper Port Reset Interrupt can reset the signal after
+    // exactly settings.pulse_microseconds microseconds, independent of the main Timer1 prescaler.
+    TCNT0 = st.step_pulse_time; // Reload Timer0 counter
+    TCCR0B = (1<<CS01); // Begin Timer0. Full speed, 1/8 prescaler
+  #endif
 
   busy = true;
   sei(); // Re-enable interrupts to allow Stepper Port Reset Interrupt to fire on-time.
@@ -462,6 +787,10 @@ ISR(TIMER1_COMPA_vect)
         #else
           st.counter_x = st.counter_y = st.counter_z = (st.exec_block->step_event_count >> 1);
         #endif
+
+        #ifdef ENABLE_INLINE_OUTPUT_CHANGES
+          if (st.exec_block->output_changes | st.exec_block->digital_changes) { st_set_block_outputs(); }
+        #endif
       }
       for (i = 0; i < N_AXIS; i++)
         st.dir_outbits[i] = st.exec_block->direction_bits[i] ^ dir_port_invert_mask[i];
@@ -487,6 +816,12 @@ ISR(TIMER1_COMPA_vect)
 
     } else {
       // Segment buffer empty. Shutdown.
+      #ifdef REPORT_FIELD_STARVATION_COUNTERS
+        // Underrun, unless the motion ends here or is held.
+        if (!(sys.step_control & STEP_CONTROL_END_MOTION) && (plan_get_current_block() != NULL)) {
+          sys_starvation.segment++;
+        }
+      #endif
       st_go_idle();
       // Ensure pwm is set properly upon completion of rate-controlled motion.
       if (st.exec_block->is_pwm_rate_adjusted) { spindle_set_speed(SPINDLE_PWM_OFF_VALUE); }
@@ -494,6 +829,9 @@ ISR(TIMER1_COMPA_vect)
       return; // Nothing to do but exit.
     }
   }
+  #ifdef STEPPER_ISR_PROFILER
+    isr_amass_level = st.exec_segment->amass_level; // Segment may be discarded before the ISR ends.
+  #endif
 
 
   // Check probing state.
@@ -502,6 +840,9 @@ ISR(TIMER1_COMPA_vect)
   // Reset step out bits.
   for (i = 0; i < N_AXIS; i++)
     st.step_outbits[i] = 0;
+  #ifdef STEP_PULSE_OUTPUT_COMPARE
+    st.step_oc_outbits = 0;
+  #endif
 
   // Execute step displacement profile by Bresenham line algorithm
   #ifdef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
@@ -510,10 +851,9 @@ ISR(TIMER1_COMPA_vect)
     st.counter_x += st.exec_block->steps[AXIS_1];
   #endif
   if (st.counter_x > st.exec_block->step_event_count) {
-    st.step_outbits[AXIS_1] |= (1<<STEP_BIT(AXIS_1));
+    STEP_OUTBITS_SET(AXIS_1);
     st.counter_x -= st.exec_block->step_event_count;
-    if (st.exec_block->direction_bits[AXIS_1] & (1<<DIRECTION_BIT(AXIS_1))) { sys_position[AXIS_1]--; }
-    else { sys_position[AXIS_1]++; }
+    st.segment_steps[AXIS_1]++;
   }
 
   #ifdef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
@@ -522,10 +862,9 @@ ISR(TIMER1_COMPA_vect)
     st.counter_y += st.exec_block->steps[AXIS_2];
   #endif
   if (st.counter_y > st.exec_block->step_event_count) {
-    st.step_outbits[AXIS_2] |= (1<<STEP_BIT(AXIS_2));
+    STEP_OUTBITS_SET(AXIS_2);
     st.counter_y -= st.exec_block->step_event_count;
-    if (st.exec_block->direction_bits[AXIS_2] & (1<<DIRECTION_BIT(AXIS_2))) { sys_position[AXIS_2]--; }
-    else { sys_position[AXIS_2]++; }
+    st.segment_steps[AXIS_2]++;
   }
   #ifdef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
     st.counter_z += st.steps[AXIS_3];
@@ -533,10 +872,9 @@ ISR(TIMER1_COMPA_vect)
     st.counter_z += st.exec_block->steps[AXIS_3];
   #endif
   if (st.counter_z > st.exec_block->step_event_count) {
-    st.step_outbits[AXIS_3] |= (1<<STEP_BIT(AXIS_3));
+    STEP_OUTBITS_SET(AXIS_3);
     st.counter_z -= st.exec_block->step_event_count;
-    if (st.exec_block->direction_bits[AXIS_3] & (1<<DIRECTION_BIT(AXIS_3))) { sys_position[AXIS_3]--; }
-    else { sys_position[AXIS_3]++; }
+    st.segment_steps[AXIS_3]++;
   }
   #if N_AXIS > 3
     #ifdef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
@@ -545,10 +883,9 @@ ISR(TIMER1_COMPA_vect)
       st.counter_4 += st.exec_block->steps[AXIS_4];
     #endif
     if (st.counter_4 > st.exec_block->step_event_count) {
-      st.step_outbits[AXIS_4] |= (1<<STEP_BIT(AXIS_4));
+      STEP_OUTBITS_SET(AXIS_4);
       st.counter_4 -= st.exec_block->step_event_count;
-      if (st.exec_block->direction_bits[AXIS_4] & (1<<DIRECTION_BIT(AXIS_4))) { sys_position[AXIS_4]--; }
-      else { sys_position[AXIS_4]++; }
+      st.segment_steps[AXIS_4]++;
     }
   #endif // N_AXIS > 3
   #if N_AXIS > 4
@@ -558,10 +895,9 @@ ISR(TIMER1_COMPA_vect)
       st.counter_5 += st.exec_block->steps[AXIS_5];
     #endif
     if (st.counter_5 > st.exec_block->step_event_count) {
-      st.step_outbits[AXIS_5] |= (1<<STEP_BIT(AXIS_5));
+      STEP_OUTBITS_SET(AXIS_5);
       st.counter_5 -= st.exec_block->step_event_count;
-      if (st.exec_block->direction_bits[AXIS_5] & (1<<DIRECTION_BIT(AXIS_5))) { sys_position[AXIS_5]--; }
-      else { sys_position[AXIS_5]++; }
+      st.segment_steps[AXIS_5]++;
     }
   #endif // N_AXIS > 4
   #if N_AXIS > 5
@@ -571,24 +907,33 @@ ISR(TIMER1_COMPA_vect)
       st.counter_6 += st.exec_block->steps[AXIS_6];
     #endif
     if (st.counter_6 > st.exec_block->step_event_count) {
-      st.step_outbits[AXIS_6] |= (1<<STEP_BIT(AXIS_6));
+      STEP_OUTBITS_SET(AXIS_6);
       st.counter_6 -= st.exec_block->step_event_count;
-      if (st.exec_block->direction_bits[AXIS_6] & (1<<DIRECTION_BIT(AXIS_6))) { sys_position[AXIS_6]--; }
-      else { sys_position[AXIS_6]++; }
+      st.segment_steps[AXIS_6]++;
     }
   #endif // N_AXIS > 5
 
   // During a homing cycle, lock out and prevent desired axes from moving.
-  for (i = 0; i < N_AXIS; i++)
-    if (sys.state == STATE_HOMING) { st.step_outbits[i] &= sys.homing_axis_lock[i]; }
+  if (sys.state == STATE_HOMING) {
+    for (i = 0; i < N_AXIS; i++) {
+      st.step_outbits[step_port_group[i]] &= (sys.homing_axis_lock[i] | ~get_step_pin_mask(i));
+      #ifdef STEP_PULSE_OUTPUT_COMPARE
+        if (!(sys.homing_axis_lock[i] & get_step_pin_mask(i))) { st.step_oc_outbits &= ~step_oc_com[i]; }
+      #endif
+    }
+  }
   st.step_count--; // Decrement step events count
   if (st.step_count == 0) {
     // Segment is complete. Discard current segment and advance segment indexing.
+    st_update_position();
     st.exec_segment = NULL;
     if ( ++segment_buffer_tail == SEGMENT_BUFFER_SIZE) { segment_buffer_tail = 0; }
   }
   for (i = 0; i < N_AXIS; i++)
     st.step_outbits[i] ^= step_port_invert_mask[i];  // Apply step port invert mask
+  #ifdef STEPPER_ISR_PROFILER
+    st_isr_profile_update(isr_amass_level, isr_entry_count);
+  #endif
   busy = false;
 }
 
@@ -604,20 +949,21 @@ ISR(TIMER1_COMPA_vect)
 // This interrupt is enabled by ISR_TIMER1_COMPAREA when it sets the motor port bits to execute
 // a step. This ISR resets the motor port after a short period (settings.pulse_microseconds)
 // completing one step cycle.
+#ifdef STEP_PULSE_RESET_INTERRUPT
 ISR(TIMER0_OVF_vect)
 {
   // Reset stepping pins (leave the direction pins)
-  STEP_PORT(0) = (STEP_PORT(0) & ~(1 << STEP_BIT(0))) | step_port_invert_mask[0];
-  STEP_PORT(1) = (STEP_PORT(1) & ~(1 << STEP_BIT(1))) | step_port_invert_mask[1];
-  STEP_PORT(2) = (STEP_PORT(2) & ~(1 << STEP_BIT(2))) | step_port_invert_mask[2];
+  STEP_PORT_WRITE(0, step_port_invert_mask[0]);
+  STEP_PORT_WRITE(1, step_port_invert_mask[1]);
+  STEP_PORT_WRITE(2, step_port_invert_mask[2]);
   #if N_AXIS > 3
-    STEP_PORT(3) = (STEP_PORT(3) & ~(1 << STEP_BIT(3))) | step_port_invert_mask[3];
+    STEP_PORT_WRITE(3, step_port_invert_mask[3]);
   #endif
   #if N_AXIS > 4
-    STEP_PORT(4) = (STEP_PORT(4) & ~(1 << STEP_BIT(4))) | step_port_invert_mask[4];
+    STEP_PORT_WRITE(4, step_port_invert_mask[4]);
   #endif
   #if N_AXIS > 5
-    STEP_PORT(5) = (STEP_PORT(5) & ~(1 << STEP_BIT(5))) | step_port_invert_mask[5];
+    STEP_PORT_WRITE(5, step_port_invert_mask[5]);
   #endif
   TCCR0B = 0; // Disable Timer0 to prevent re-entering this interrupt when it's not needed.
 }
@@ -630,32 +976,88 @@ ISR(TIMER0_OVF_vect)
   ISR(TIMER0_COMPA_vect)
   {
     STEP_PORT(0) = st.step_bits[0]; // Begin step pulse.
-    STEP_PORT(1) = st.step_bits[1]; // Begin step pulse.
-    STEP_PORT(2) = st.step_bits[2]; // Begin step pulse.
+    if (STEP_PORT_GROUP(1) == 1) { STEP_PORT(1) = st.step_bits[1]; }
+    if (STEP_PORT_GROUP(2) == 2) { STEP_PORT(2) = st.step_bits[2]; }
     #if N_AXIS > 3
-      STEP_PORT(3) = st.step_bits[3]; // Begin step pulse.
+      if (STEP_PORT_GROUP(3) == 3) { STEP_PORT(3) = st.step_bits[3]; }
     #endif
     #if N_AXIS > 4
-      STEP_PORT(4) = st.step_bits[4]; // Begin step pulse.
+      if (STEP_PORT_GROUP(4) == 4) { STEP_PORT(4) = st.step_bits[4]; }
     #endif
     #if N_AXIS > 5
-      STEP_PORT(5) = st.step_bits[5]; // Begin step pulse.
+      if (STEP_PORT_GROUP(5) == 5) { STEP_PORT(5) = st.step_bits[5]; }
+    #endif
+  }
+#endif
+#endif // STEP_PULSE_RESET_INTERRUPT
+
+
+#ifdef STEP_PULSE_OUTPUT_COMPARE
+  // Sets the compare output mode of an output compare step pin from its step invert bit. An
+  // inverted pin idles high and is cleared at the compare match, a normal pin idles low and is
+  // set at the match. Also sets the port to the idle level, for while the pin is disconnected.
+  static uint8_t st_oc_com(uint8_t axis, uint8_t com1, uint8_t pin)
+  {
+    if (bit_istrue(settings.step_invert_mask,bit(axis))) {
+      PORTL |= pin;
+      step_oc_com[axis] = com1;
+    } else {
+      PORTL &= ~pin;
+      step_oc_com[axis] = com1 | (com1 >> 1);
+    }
+    return(step_oc_com[axis]);
+  }
+
+
+  // Generates the compare output modes of the output compare step pins and forces the pins to
+  // their idle level. A one-shot pulse only changes the pins at its compare match and at BOTTOM,
+  // so their output compare latches must start out idle. Timer5 is idle between step pulses.
+  static void st_generate_oc_modes()
+  {
+    uint8_t com = 0;
+    uint8_t force = 0;
+    uint8_t com0 = 0;
+    #ifdef STEP_OC5A_AXIS
+      com |= st_oc_com(STEP_OC5A_AXIS, (1<<COM5A1), (1<<STEP_BIT(STEP_OC5A_AXIS)));
+      com0 |= (1<<COM5A0);
+      force |= (1<<FOC5A);
+    #endif
+    #ifdef STEP_OC5B_AXIS
+      com |= st_oc_com(STEP_OC5B_AXIS, (1<<COM5B1), (1<<STEP_BIT(STEP_OC5B_AXIS)));
+      com0 |= (1<<COM5B0);
+      force |= (1<<FOC5B);
     #endif
+    #ifdef STEP_OC5C_AXIS
+      com |= st_oc_com(STEP_OC5C_AXIS, (1<<COM5C1), (1<<STEP_BIT(STEP_OC5C_AXIS)));
+      com0 |= (1<<COM5C0);
+      force |= (1<<FOC5C);
+    #endif
+    // Forced compare matches only act in normal mode, where the inverse of the one-shot mode sets
+    // an inverted pin's latch and clears a normal one's.
+    uint8_t tccr5b = TCCR5B;
+    TCCR5B = 0;
+    TCCR5A = com ^ com0;
+    TCCR5C = force;
+    TCCR5A = (1<<WGM51);
+    TCCR5B = tccr5b;
   }
 #endif
 
 
-// Generates the step and direction port invert masks used in the Stepper Interrupt Driver.
+// Generates the step and direction port invert masks used in the Stepper Interrupt Driver. The
+// masks are combined per port group, so the ISR applies them with its single port writes.
 void st_generate_step_dir_invert_masks()
 {
   uint8_t idx;
+  memset(step_port_invert_mask, 0, sizeof(step_port_invert_mask));
+  memset(dir_port_invert_mask, 0, sizeof(dir_port_invert_mask));
   for (idx=0; idx<N_AXIS; idx++) {
-    if (bit_istrue(settings.step_invert_mask,bit(idx))) { step_port_invert_mask[idx] = get_step_pin_mask(idx); }
-    else { step_port_invert_mask[idx] = 0; }
-
-    if (bit_istrue(settings.dir_invert_mask,bit(idx))) { dir_port_invert_mask[idx] = get_direction_pin_mask(idx); }
-    else { dir_port_invert_mask[idx] = 0; }
+    if (bit_istrue(settings.step_invert_mask,bit(idx)) && !STEP_ON_OC(idx)) { step_port_invert_mask[step_port_group[idx]] |= get_step_pin_mask(idx); }
+    if (bit_istrue(settings.dir_invert_mask,bit(idx))) { dir_port_invert_mask[direction_port_group[idx]] |= get_direction_pin_mask(idx); }
   }
+  #ifdef STEP_PULSE_OUTPUT_COMPARE
+    st_generate_oc_modes();
+  #endif
 }
 
 
@@ -667,40 +1069,49 @@ void st_reset()
   // Initialize stepper driver idle state.
   st_go_idle();
 
+  // Keep the steps of a segment cut short.
+  if (st.exec_block != NULL) { st_update_position(); }
+
   // Initialize stepper algorithm variables.
   memset(&prep, 0, sizeof(st_prep_t));
   memset(&st, 0, sizeof(stepper_t));
   st.exec_segment = NULL;
   pl_block = NULL;  // Planner block pointer used by segment buffer
+  #ifdef REPORT_FIELD_STARVATION_COUNTERS
+    prep_planner_starved = false;
+  #endif
   segment_buffer_tail = 0;
   segment_buffer_head = 0; // empty = tail
   segment_next_head = 1;
   busy = false;
 
   st_generate_step_dir_invert_masks();
+  #ifdef ENABLE_INPUT_SHAPING
+    st_generate_input_shaper();
+  #endif
   for (idx=0; idx<N_AXIS; idx++) {
     st.dir_outbits[idx] = dir_port_invert_mask[idx]; // Initialize direction bits to default.
   }
 
-  STEP_PORT(0) = (STEP_PORT(0) & ~(1 << STEP_BIT(0))) | step_port_invert_mask[0];
-  DIRECTION_PORT(0) = (DIRECTION_PORT(0) & ~(1 << DIRECTION_BIT(0))) | dir_port_invert_mask[0];
+  STEP_PORT_WRITE(0, step_port_invert_mask[0]);
+  DIRECTION_PORT_WRITE(0, dir_port_invert_mask[0]);
 
-  STEP_PORT(1) = (STEP_PORT(1) & ~(1 << STEP_BIT(1))) | step_port_invert_mask[1];
-  DIRECTION_PORT(1) = (DIRECTION_PORT(1) & ~(1 << DIRECTION_BIT(1))) | dir_port_invert_mask[1];
+  STEP_PORT_WRITE(1, step_port_invert_mask[1]);
+  DIRECTION_PORT_WRITE(1, dir_port_invert_mask[1]);
 
-  STEP_PORT(2) = (STEP_PORT(2) & ~(1 << STEP_BIT(2))) | step_port_invert_mask[2];
-  DIRECTION_PORT(2) = (DIRECTION_PORT(2) & ~(1 << DIRECTION_BIT(2))) | dir_port_invert_mask[2];
+  STEP_PORT_WRITE(2, step_port_invert_mask[2]);
+  DIRECTION_PORT_WRITE(2, dir_port_invert_mask[2]);
   #if N_AXIS > 3
-    STEP_PORT(3) = (STEP_PORT(3) & ~(1 << STEP_BIT(3))) | step_port_invert_mask[3];
-    DIRECTION_PORT(3) = (DIRECTION_PORT(3) & ~(1 << DIRECTION_BIT(3))) | dir_port_invert_mask[3];
+    STEP_PORT_WRITE(3, step_port_invert_mask[3]);
+    DIRECTION_PORT_WRITE(3, dir_port_invert_mask[3]);
   #endif
   #if N_AXIS > 4
-    STEP_PORT(4) = (STEP_PORT(4) & ~(1 << STEP_BIT(4))) | step_port_invert_mask[4];
-    DIRECTION_PORT(4) = (DIRECTION_PORT(4) & ~(1 << DIRECTION_BIT(4))) | dir_port_invert_mask[4];
+    STEP_PORT_WRITE(4, step_port_invert_mask[4]);
+    DIRECTION_PORT_WRITE(4, dir_port_invert_mask[4]);
   #endif
   #if N_AXIS > 5
-    STEP_PORT(5) = (STEP_PORT(5) & ~(1 << STEP_BIT(5))) | step_port_invert_mask[5];
-    DIRECTION_PORT(5) = (DIRECTION_PORT(5) & ~(1 << DIRECTION_BIT(5))) | dir_port_invert_mask[5];
+    STEP_PORT_WRITE(5, step_port_invert_mask[5]);
+    DIRECTION_PORT_WRITE(5, dir_port_invert_mask[5]);
   #endif
 }
 
@@ -760,24 +1171,378 @@ void stepper_init()
   TIMSK0 &= ~((1<<OCIE0B) | (1<<OCIE0A) | (1<<TOIE0)); // Disconnect OC0 outputs and OVF interrupt.
   TCCR0A = 0; // Normal operation
   TCCR0B = 0; // Disable Timer0 until needed
-  TIMSK0 |= (1<<TOIE0); // Enable Timer0 overflow interrupt
-  #ifdef STEP_PULSE_DELAY
-    TIMSK0 |= (1<<OCIE0A); // Enable Timer0 Compare Match A interrupt
+  #ifdef STEP_PULSE_RESET_INTERRUPT
+    TIMSK0 |= (1<<TOIE0); // Enable Timer0 overflow interrupt
+    #ifdef STEP_PULSE_DELAY
+      TIMSK0 |= (1<<OCIE0A); // Enable Timer0 Compare Match A interrupt
+    #endif
+  #endif
+
+  #ifdef STEP_PULSE_OUTPUT_COMPARE
+    // Configure Timer 5: One-shot step pulses. In fast PWM mode with TOP at ICR5 = 0, the counter
+    // rests at zero. Once the stepper ISR loads a count, it runs up to the wrap to zero and stops
+    // there again. Each connected output compare pin switches to its active level at the compare
+    // match and back to idle at BOTTOM, so no interrupt is needed. The compare output modes and
+    // the idle levels are set with the invert masks.
+    TIMSK5 = 0; // No interrupts.
+    ICR5 = 0;
+    TCCR5A = (1<<WGM51); // Outputs disconnected until stepping.
+    TCCR5B = (1<<WGM53) | (1<<WGM52) | (1<<CS50); // Full speed, no prescaler.
+  #endif
+
+  #ifdef STEPPER_ISR_PROFILER
+    // Configure Timer 5: Free-running counter for the segment preparation profile. With the 1/8
+    // prescaler, it wraps after 524288 cycles (32.8ms at 16MHz), longer than any segment takes.
+    TIMSK5 = 0; // No interrupts.
+    TCCR5A = 0; // Normal operation. Outputs disconnected.
+    TCCR5B = (1<<CS51); // 1/8 prescaler.
   #endif
 }
 
 
+#ifdef USE_FIXED_POINT_MOTION
+  // Sets the unit conversions of the fixed-point segment generator from the steps/mm of the block.
+  static void st_fp_set_scale()
+  {
+    prep.fp_speed_scale = (65536.0*DT_SEGMENT)*prep.step_per_mm;
+    prep.fp_mm_scale = 1.0/(4294967296.0*prep.step_per_mm);
+  }
+
+
+  // Returns the current speed of the fixed-point segment generator in mm/min.
+  static float st_fp_current_speed()
+  {
+    if (prep.fp_current_speed == 0) { return(0.0); } // Also before any block has set the scale.
+    return(prep.fp_current_speed/prep.fp_speed_scale);
+  }
+
+
+  // Converts a velocity profile distance from the end of the block to Q32.32 steps. Clamped to the
+  // exact distance remaining, which the float value may exceed by its round-off.
+  static int64_t st_fp_dist_from_mm(float mm)
+  {
+    if (mm <= 0.0) { return(0); }
+    int64_t dist = mm/prep.fp_mm_scale;
+    if (dist > prep.dist_remaining) { return(prep.dist_remaining); }
+    return(dist);
+  }
+
+
+  // Loads the float velocity profile computed by st_prep_buffer() into the fixed-point copies.
+  static void st_fp_load_profile()
+  {
+    prep.fp_acceleration = (pl_block->acceleration*DT_SEGMENT)*prep.fp_speed_scale;
+    prep.fp_maximum_speed = prep.maximum_speed*prep.fp_speed_scale;
+    prep.fp_exit_speed = prep.exit_speed*prep.fp_speed_scale;
+    prep.fp_mm_complete = st_fp_dist_from_mm(prep.mm_complete);
+    prep.fp_accelerate_until = st_fp_dist_from_mm(prep.accelerate_until);
+    prep.fp_decelerate_after = st_fp_dist_from_mm(prep.decelerate_after);
+  }
+
+
+  // Speed change over time_var (Q16.16 segments) at the block acceleration. Full segments, the
+  // common case, need no multiplication.
+  static inline int32_t st_fp_speed_delta(int32_t time_var)
+  {
+    if (time_var == FP_SEGMENT_TIME) { return(prep.fp_acceleration); }
+    return(((int64_t)prep.fp_acceleration*time_var) >> 16);
+  }
+
+
+  // Distance (Q32.32 steps) traveled over time_var (Q16.16 segments) at speed (Q16.16 steps/segment).
+  static inline int64_t st_fp_dist(int32_t speed, int32_t time_var)
+  {
+    if (time_var == FP_SEGMENT_TIME) { return((int64_t)speed << 16); }
+    return((int64_t)speed*time_var);
+  }
+
+
+  // Time (Q16.16 segments) to travel dist (Q32.32 steps) at the mean of two speeds, given as their
+  // sum. Only used at ramp junctions and at the end of the profile.
+  static int32_t st_fp_time(int64_t dist, int32_t speed_sum)
+  {
+    if (speed_sum <= 0) { return(FP_SEGMENT_TIME); } // Stalled. Should not occur.
+    int64_t time_var = (dist << 1)/speed_sum;
+    if (time_var > (1L << 30)) { return(1L << 30); } // Far slower than the slowest step rate.
+    return(time_var);
+  }
+#endif
+
+
+#ifdef ENABLE_INPUT_SHAPING
+  // Impulses of the input shaper. A shaped ramp accelerates with the sum of copies of a constant
+  // acceleration, each delayed by an impulse time and scaled by its amplitude. Computed from the
+  // shaper settings by st_generate_input_shaper().
+  static struct {
+    uint8_t n_impulse;      // Number of impulses. Zero when shaping is disabled.
+    float amplitude[3];     // Impulse amplitudes, summing to one.
+    float time[3];          // Impulse times (min)
+    float delay;            // Start of the shaped acceleration that centers it in a ramp (min)
+  } st_shaper;
+
+
+  // Computes the impulses of the ZV, ZVD or EI input shaper for the resonance frequency and damping
+  // ratio settings, as given in the input shaping literature. The constant acceleration of a shaped
+  // ramp lasts T-Ts-delay of the ramp time T, where Ts is the time of the last impulse. The planner
+  // adds Ts+delay to the time of each ramp, so this is the time of the planned acceleration. The
+  // delay centers the shaped acceleration in the ramp, since the impulses of a damped shaper are not
+  // symmetric. Then the ramp covers T times the mean of its entry and exit speeds.
+  void st_generate_input_shaper()
+  {
+    st_shaper.n_impulse = 0;
+    if (settings.input_shaper_type == INPUT_SHAPER_NONE) { return; }
+    float damping = sqrt(1.0-settings.input_shaper_damping*settings.input_shaper_damping);
+    float k = exp(-settings.input_shaper_damping*M_PI/damping);
+    float half_period = 0.5/(60.0*settings.input_shaper_frequency*damping); // Damped half period (min)
+    st_shaper.time[0] = 0.0;
+    st_shaper.time[1] = half_period;
+    st_shaper.time[2] = 2.0*half_period;
+    if (settings.input_shaper_type == INPUT_SHAPER_ZV) {
+      st_shaper.n_impulse = 2;
+      st_shaper.amplitude[0] = 1.0;
+      st_shaper.amplitude[1] = k;
+    } else {
+      st_shaper.n_impulse = 3;
+      if (settings.input_shaper_type == INPUT_SHAPER_ZVD) {
+        st_shaper.amplitude[0] = 1.0;
+        st_shaper.amplitude[1] = 2.0*k;
+      } else { // INPUT_SHAPER_EI, with 5% residual vibration at the frequency setting.
+        st_shaper.amplitude[0] = 0.25*(1.0+0.05);
+        st_shaper.amplitude[1] = 0.5*(1.0-0.05)*k;
+      }
+      st_shaper.amplitude[2] = st_shaper.amplitude[0]*k*k;
+    }
+    float sum = 0.0;
+    float mean_time = 0.0;
+    uint8_t idx;
+    for (idx=0; idx<st_shaper.n_impulse; idx++) { sum += st_shaper.amplitude[idx]; }
+    for (idx=0; idx<st_shaper.n_impulse; idx++) {
+      st_shaper.amplitude[idx] /= sum;
+      mean_time += st_shaper.amplitude[idx]*st_shaper.time[idx];
+    }
+    float shaper_time = st_shaper.time[st_shaper.n_impulse-1];
+    st_shaper.delay = shaper_time-2.0*mean_time;
+  }
+
+
+  float st_get_input_shaper_time()
+  {
+    if (st_shaper.n_impulse == 0) { return(0.0); }
+    return(st_shaper.time[st_shaper.n_impulse-1]+st_shaper.delay);
+  }
+
+
+  // Adds the speed fraction of one impulse of a shaped ramp, started time t ago, to speed and its
+  // distance, as a fraction of the ramp speed change times time, to distance.
+  static void st_prep_ramp_impulse(float t, float amplitude, float *speed, float *distance)
+  {
+    if (t <= 0.0) { return; }
+    if (t < prep.ramp_accel_time) {
+      float fraction = t/prep.ramp_accel_time;
+      *speed += amplitude*fraction;
+      *distance += amplitude*0.5*fraction*t;
+    } else {
+      *speed += amplitude;
+      *distance += amplitude*(t-0.5*prep.ramp_accel_time);
+    }
+  }
+#endif
+
+
+#ifdef SHAPED_RAMPS
+  // Sets up the shaped ramp from the current speed at mm_start to exit_speed at mm_end, both
+  // measured from the end of the block. The shaped ramp covers the ramp distance at an average speed
+  // of the mean of its entry and exit speed, which gives its time.
+  // With S-curves, the acceleration ramps up at constant jerk, holds and ramps down. Since the
+  // S-curve is symmetric, it keeps the average speed. The jerk phases take the shortest time the
+  // block jerk limit allows, which needs the jerk phase fraction p of the ramp time T to satisfy
+  // p*(1-p) = |dv|/(jerk*T^2). The ramps are planned with the time of a jerk-limited ramp, see
+  // plan_get_ramp_distance(), so this gives a peak acceleration |dv|/(T*(1-p)) of at most the block
+  // acceleration, and p = 0.5 for ramps that don't reach it. A ramp only gets too short for the jerk
+  // limit, with the acceleration ramping up and down at a higher jerk, when an override or feed hold
+  // re-plans the block midway. Or by float round-off.
+  // With input shaping, the constant acceleration of the ramp is convolved with the shaper
+  // impulses. See st_generate_input_shaper(). Ramps planned too short for the shaper time run
+  // unshaped, as the planner then planned them with the trapezoidal ramp time. The check allows
+  // for float round-off, so a shaped ramp may peak slightly above the block acceleration.
+  static void st_prep_ramp(float mm_start, float mm_end, float exit_speed)
+  {
+    prep.ramp_mm = mm_start;
+    prep.ramp_time = 0.0;
+    prep.ramp_speed = prep.current_speed;
+    prep.ramp_delta_speed = exit_speed-prep.current_speed;
+    float speed_sum = prep.current_speed+exit_speed;
+    if (speed_sum > 0.0) { prep.ramp_duration = 2.0*(mm_start-mm_end)/speed_sum; }
+    else { prep.ramp_duration = 0.0; }
+    #ifdef ENABLE_S_CURVE_ACCELERATION
+      float jerk_term = plan_get_block_jerk(pl_block)*prep.ramp_duration*prep.ramp_duration;
+      float delta_term = 4.0*fabs(prep.ramp_delta_speed);
+      if (jerk_term > delta_term) { prep.ramp_jerk_time = 0.5*(1.0-sqrt(1.0-delta_term/jerk_term)); }
+      else { prep.ramp_jerk_time = 0.5; } // Too short. See above.
+    #else
+      prep.ramp_accel_time = prep.ramp_duration-st_get_input_shaper_time();
+      if (st_shaper.n_impulse && (prep.ramp_accel_time > 0.0) &&
+          (prep.ramp_accel_time*pl_block->acceleration >= 0.999*fabs(prep.ramp_delta_speed))) {
+        prep.ramp_shaped = true;
+        prep.ramp_delay = st_shaper.delay;
+      } else {
+        prep.ramp_shaped = false;
+        prep.ramp_delay = 0.0;
+        prep.ramp_accel_time = prep.ramp_duration;
+      }
+    #endif
+  }
+
+
+  // Advances the shaped ramp by time_var and updates the current speed and mm_remaining. Returns
+  // true when this reaches the end of the ramp at mm_end, with time_var cut to the ramp time left.
+  static uint8_t st_prep_ramp_step(float *mm_remaining, float *time_var, float mm_end)
+  {
+    float time = prep.ramp_time+(*time_var);
+    if (time < prep.ramp_duration) {
+      float speed, distance;
+      #ifdef ENABLE_S_CURVE_ACCELERATION
+        // Speed and distance fractions of the ramp at the normalized ramp time u. The acceleration
+        // a*(1-p) is normalized to a unit speed change in unit time. The distance is normalized to T.
+        float u = time/prep.ramp_duration;
+        float p = prep.ramp_jerk_time;
+        float a = 1.0/(1.0-p);
+        if (u < p) { // Jerk up
+          speed = a*u*u/(2.0*p);
+          distance = speed*u/3.0;
+        } else if (u <= 1.0-p) { // Constant acceleration
+          speed = a*(u-0.5*p);
+          distance = a*(0.5*u*(u-p)+p*p/6.0);
+        } else { // Jerk down. Mirrors the jerk up phase.
+          float w = 1.0-u;
+          float mirror_speed = a*w*w/(2.0*p);
+          speed = 1.0-mirror_speed;
+          distance = 0.5-w+mirror_speed*w/3.0;
+        }
+      #else
+        // Speed and distance fractions of the ramp, summed over the shaper impulses.
+        speed = 0.0;
+        distance = 0.0;
+        if (prep.ramp_shaped) {
+          uint8_t idx;
+          for (idx=0; idx<st_shaper.n_impulse; idx++) {
+            st_prep_ramp_impulse(time-prep.ramp_delay-st_shaper.time[idx], st_shaper.amplitude[idx], &speed, &distance);
+          }
+        } else {
+          st_prep_ramp_impulse(time, 1.0, &speed, &distance);
+        }
+        distance /= prep.ramp_duration;
+      #endif
+      float mm_var = prep.ramp_mm - (time*prep.ramp_speed + prep.ramp_duration*prep.ramp_delta_speed*distance);
+      if (mm_var > mm_end) {
+        *mm_remaining = mm_var;
+        prep.current_speed = prep.ramp_speed + prep.ramp_delta_speed*speed;
+        prep.ramp_time = time;
+        return(false);
+      }
+    }
+    *time_var = prep.ramp_duration-prep.ramp_time; // End of ramp.
+    prep.ramp_time = prep.ramp_duration;
+    return(true);
+  }
+#endif
+
+
+#ifdef SHAPED_RAMPS
+  // Computes the velocity profile of the prepped block from its entry, nominal and exit speeds, like
+  // st_prep_buffer() does for trapezoidal ramps, but with the distances of shaped ramps. These have
+  // no closed form for the peak speed of a triangle profile, so it is found by bisection. Rounding it
+  // down leaves a short cruise at the peak.
+  static void st_prep_shaped_profile()
+  {
+    float entry_speed = sqrt(pl_block->entry_speed_sqr);
+    if (sys.step_control & STEP_CONTROL_EXECUTE_HOLD) { // [Forced Deceleration to Zero Velocity]
+      prep.ramp_type = RAMP_DECEL;
+      float decel_dist = pl_block->millimeters - plan_get_ramp_distance(pl_block, entry_speed, 0.0);
+      if (decel_dist < 0.0) {
+        // Deceleration through entire planner block. End of feed hold is not in this block.
+        prep.exit_speed = plan_get_ramp_speed(pl_block, entry_speed, pl_block->millimeters, false);
+      } else {
+        prep.mm_complete = decel_dist; // End of feed hold.
+        prep.exit_speed = 0.0;
+      }
+      return;
+    }
+
+    // [Normal Operation]
+    prep.ramp_type = RAMP_ACCEL; // Initialize as acceleration ramp.
+    prep.accelerate_until = pl_block->millimeters;
+    if (sys.step_control & STEP_CONTROL_EXECUTE_SYS_MOTION) { prep.exit_speed = 0.0; }
+    else { prep.exit_speed = sqrt(plan_get_exec_block_exit_speed_sqr()); }
+    float nominal_speed = plan_compute_profile_nominal_speed(pl_block);
+
+    if (entry_speed > nominal_speed) { // Only occurs during override reductions.
+      prep.accelerate_until -= plan_get_ramp_distance(pl_block, entry_speed, nominal_speed);
+      if (prep.accelerate_until <= 0.0) { // Deceleration-only.
+        prep.ramp_type = RAMP_DECEL;
+        prep.exit_speed = plan_get_ramp_speed(pl_block, entry_speed, pl_block->millimeters, false);
+        prep.recalculate_flag |= PREP_FLAG_DECEL_OVERRIDE; // Flag to load next block as deceleration override.
+      } else { // Decelerate to cruise or cruise-decelerate types.
+        prep.decelerate_after = plan_get_ramp_distance(pl_block, nominal_speed, prep.exit_speed);
+        if (prep.decelerate_after > prep.accelerate_until) { prep.decelerate_after = prep.accelerate_until; }
+        prep.maximum_speed = nominal_speed;
+        prep.ramp_type = RAMP_DECEL_OVERRIDE;
+      }
+      return;
+    }
+
+    float accel_dist = plan_get_ramp_distance(pl_block, entry_speed, nominal_speed);
+    prep.decelerate_after = plan_get_ramp_distance(pl_block, nominal_speed, prep.exit_speed);
+    if (accel_dist+prep.decelerate_after <= pl_block->millimeters) { // Trapezoid type
+      prep.maximum_speed = nominal_speed;
+      if (entry_speed == nominal_speed) { prep.ramp_type = RAMP_CRUISE; } // Cruise-deceleration or cruise-only type.
+      else { prep.accelerate_until -= accel_dist; } // Full-trapezoid or acceleration-cruise types
+    } else if (plan_get_ramp_distance(pl_block, entry_speed, prep.exit_speed) >= pl_block->millimeters) {
+      if (entry_speed > prep.exit_speed) { prep.ramp_type = RAMP_DECEL; } // Deceleration-only type
+      else { // Acceleration-only type
+        prep.accelerate_until = 0.0;
+        prep.maximum_speed = prep.exit_speed;
+      }
+    } else { // Triangle type
+      float low_speed = max(entry_speed, prep.exit_speed);
+      float high_speed = nominal_speed;
+      uint8_t idx;
+      for (idx=0; idx<8; idx++) {
+        float peak_speed = 0.5*(low_speed+high_speed);
+        if (plan_get_ramp_distance(pl_block, entry_speed, peak_speed)+plan_get_ramp_distance(pl_block, peak_speed, prep.exit_speed)
+              <= pl_block->millimeters) { low_speed = peak_speed; }
+        else { high_speed = peak_speed; }
+      }
+      prep.maximum_speed = low_speed;
+      prep.accelerate_until -= plan_get_ramp_distance(pl_block, entry_speed, low_speed);
+      prep.decelerate_after = plan_get_ramp_distance(pl_block, low_speed, prep.exit_speed);
+    }
+  }
+#endif
+
+
 // Called by planner_recalculate() when the executing block is updated by the new plan.
 void st_update_plan_block_parameters()
 {
   if (pl_block != NULL) { // Ignore if at start of a new block.
     prep.recalculate_flag |= PREP_FLAG_RECALCULATE;
+    #ifdef USE_FIXED_POINT_MOTION
+      prep.current_speed = st_fp_current_speed();
+    #endif
     pl_block->entry_speed_sqr = prep.current_speed*prep.current_speed; // Update entry speed.
     pl_block = NULL; // Flag st_prep_segment() to load and check active velocity profile.
   }
 }
 
 
+#ifdef SHAPED_RAMPS
+  uint8_t st_is_block_in_progress()
+  {
+    return(pl_block != NULL);
+  }
+#endif
+
+
 // Increments the step segment buffer block data ring buffer.
 static uint8_t st_next_block_index(uint8_t block_index)
 {
@@ -797,6 +1562,12 @@ static uint8_t st_next_block_index(uint8_t block_index)
       prep.last_steps_remaining = prep.steps_remaining;
       prep.last_dt_remainder = prep.dt_remainder;
       prep.last_step_per_mm = prep.step_per_mm;
+      #ifdef USE_FIXED_POINT_MOTION
+        prep.last_dist_remaining = prep.dist_remaining;
+      #endif
+      #ifdef ENABLE_NATIVE_ARCS
+        memcpy(&prep.last_arc, &prep.arc, sizeof(st_prep_arc_t));
+      #endif
     }
     // Set flags to execute a parking motion
     prep.recalculate_flag |= PREP_FLAG_PARKING;
@@ -816,7 +1587,15 @@ static uint8_t st_next_block_index(uint8_t block_index)
       prep.dt_remainder = prep.last_dt_remainder;
       prep.step_per_mm = prep.last_step_per_mm;
       prep.recalculate_flag = (PREP_FLAG_HOLD_PARTIAL_BLOCK | PREP_FLAG_RECALCULATE);
-      prep.req_mm_increment = REQ_MM_INCREMENT_SCALAR/prep.step_per_mm; // Recompute this value.
+      #ifdef ENABLE_NATIVE_ARCS
+        memcpy(&prep.arc, &prep.last_arc, sizeof(st_prep_arc_t));
+      #endif
+      #ifdef USE_FIXED_POINT_MOTION
+        prep.dist_remaining = prep.last_dist_remaining;
+        st_fp_set_scale(); // Recompute these values.
+      #else
+        prep.req_mm_increment = REQ_MM_INCREMENT_SCALAR/prep.step_per_mm; // Recompute this value.
+      #endif
     } else {
       prep.recalculate_flag = false;
     }
@@ -825,6 +1604,90 @@ static uint8_t st_next_block_index(uint8_t block_index)
 #endif
 
 
+#ifdef ENABLE_NATIVE_ARCS
+  // Loads the next chord of the prepped arc block into a new stepper block. The chord end points are
+  // rounded to steps on the arc, relative to the arc start, and the last chord ends on the block step
+  // counts. Chords without any steps are joined with the next one. The segments then trace the chord
+  // from the end of the last one to prep.arc.chord_end, just like a line block.
+  static void st_prep_arc_chord()
+  {
+    uint32_t block_steps[N_AXIS];
+    int32_t chord_steps[N_AXIS];
+    float chord_start = prep.arc.chord_end;
+    float cos_t, sin_t, fraction;
+    uint8_t idx, has_steps, is_last;
+    plan_get_block_steps(pl_block, block_steps);
+    for (idx=0; idx<N_AXIS; idx++) {
+      if (pl_block->direction_bits & bit(idx)) { block_steps[idx] = -block_steps[idx]; } // Signed, as int32.
+    }
+
+    do {
+      prep.arc.chord++;
+      is_last = true;
+      has_steps = false;
+      if (prep.arc.chord < pl_block->arc_chords) {
+        fraction = (float)prep.arc.chord/pl_block->arc_chords;
+        sin_cos_f(fraction*pl_block->arc_travel, &sin_t, &cos_t);
+        for (idx=0; idx<N_AXIS; idx++) {
+          if (pl_block->arc_axis_0_mask & bit(idx)) {
+            chord_steps[idx] = lround(settings.steps_per_mm[idx]*
+              (pl_block->arc_start[0]*(cos_t-1.0) - pl_block->arc_start[1]*sin_t));
+          } else if (pl_block->arc_axis_1_mask & bit(idx)) {
+            chord_steps[idx] = lround(settings.steps_per_mm[idx]*
+              (pl_block->arc_start[0]*sin_t + pl_block->arc_start[1]*(cos_t-1.0)));
+          } else {
+            chord_steps[idx] = lround(fraction*(int32_t)block_steps[idx]);
+          }
+          if (chord_steps[idx] != (int32_t)block_steps[idx]) { is_last = false; }
+          if (chord_steps[idx] != prep.arc.steps[idx]) { has_steps = true; }
+        }
+      }
+    } while (!is_last && !has_steps);
+
+    if (is_last) {
+      // Remaining chords have no steps, other than to the block end. Trace them as one.
+      prep.arc.chord = pl_block->arc_chords;
+      prep.arc.chord_end = 0.0;
+      memcpy(chord_steps, block_steps, sizeof(chord_steps));
+    } else {
+      prep.arc.chord_end = (pl_block->arc_chords-prep.arc.chord)*prep.arc.chord_mm;
+    }
+
+    prep.st_block_index = st_next_block_index(prep.st_block_index);
+    st_prep_block = &st_block_buffer[prep.st_block_index];
+    memset(st_prep_block->direction_bits, 0, sizeof(st_prep_block->direction_bits));
+    st_prep_block->axis_direction_bits = 0;
+    uint32_t step_event_count = 0;
+    int32_t delta_steps;
+    for (idx=0; idx<N_AXIS; idx++) {
+      delta_steps = chord_steps[idx]-prep.arc.steps[idx];
+      if (delta_steps < 0) {
+        delta_steps = -delta_steps;
+        st_prep_block->axis_direction_bits |= bit(idx);
+        st_prep_block->direction_bits[direction_port_group[idx]] |= get_direction_pin_mask(idx);
+      }
+      if ((uint32_t)delta_steps > step_event_count) { step_event_count = delta_steps; }
+      #ifndef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
+        st_prep_block->steps[idx] = (uint32_t)delta_steps << 1;
+      #else
+        st_prep_block->steps[idx] = (uint32_t)delta_steps << MAX_AMASS_LEVEL;
+      #endif
+    }
+    memcpy(prep.arc.steps, chord_steps, sizeof(chord_steps));
+    #ifndef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
+      st_prep_block->step_event_count = step_event_count << 1;
+    #else
+      st_prep_block->step_event_count = step_event_count << MAX_AMASS_LEVEL;
+    #endif
+
+    prep.steps_remaining = (float)step_event_count;
+    prep.step_per_mm = prep.steps_remaining/(chord_start-prep.arc.chord_end);
+    prep.req_mm_increment = REQ_MM_INCREMENT_SCALAR/prep.step_per_mm;
+    prep.dt_remainder = 0.0; // Chord ends coincide with a step.
+  }
+#endif
+
+
 /* Prepares step segment buffer. Continuously called from main program.
 
    The segment buffer is an intermediary buffer interface between the execution of steps
@@ -844,6 +1707,13 @@ void st_prep_buffer()
   if (bit_istrue(sys.step_control,STEP_CONTROL_END_MOTION)) { return; }
 
   while (segment_buffer_tail != segment_next_head) { // Check if we need to fill the buffer.
+    #if SEGMENT_CRUISE_TICKS > 1
+      // Extended cruise segments hold more time each. Fill by time to keep the hold latency.
+      if (st_segment_buffer_ticks() >= SEGMENT_BUFFER_SIZE-1) { return; }
+    #endif
+    #ifdef STEPPER_ISR_PROFILER
+      uint16_t prep_start_count = TCNT5;
+    #endif
 
     // Determine if we need to load a new planner block or if the block needs to be recomputed.
     if (pl_block == NULL) {
@@ -851,7 +1721,19 @@ void st_prep_buffer()
       // Query planner for a queued block
       if (sys.step_control & STEP_CONTROL_EXECUTE_SYS_MOTION) { pl_block = plan_get_system_motion_block(); }
       else { pl_block = plan_get_current_block(); }
-      if (pl_block == NULL) { return; } // No planner blocks. Exit.
+      #ifdef REPORT_FIELD_STARVATION_COUNTERS
+        // Count once per time the planner runs empty during a cycle.
+        if (pl_block == NULL) {
+          if (!prep_planner_starved && (sys.state == STATE_CYCLE)) {
+            prep_planner_starved = true;
+            sys_starvation.planner++;
+          }
+          return;
+        }
+        prep_planner_starved = false;
+      #else
+        if (pl_block == NULL) { return; } // No planner blocks. Exit.
+      #endif
 
       // Check if we need to only recompute the velocity profile or load a new block.
       if (prep.recalculate_flag & PREP_FLAG_RECALCULATE) {
@@ -865,34 +1747,59 @@ void st_prep_buffer()
 
       } else {
 
-        // Load the Bresenham stepping data for the block.
-        prep.st_block_index = st_next_block_index(prep.st_block_index);
-
-        // Prepare and copy Bresenham algorithm segment data from the new planner block, so that
-        // when the segment buffer completes the planner block, it may be discarded when the
-        // segment buffer finishes the prepped block, but the stepper ISR is still executing it.
-        st_prep_block = &st_block_buffer[prep.st_block_index];
-        uint8_t idx;
-        for (idx=0; idx<N_AXIS; idx++) {
-          st_prep_block->direction_bits[idx] = pl_block->direction_bits[idx];
-        }
-
-        #ifndef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
-          for (idx=0; idx<N_AXIS; idx++) { st_prep_block->steps[idx] = (pl_block->steps[idx] << 1); }
-          st_prep_block->step_event_count = (pl_block->step_event_count << 1);
-        #else
-          // With AMASS enabled, simply bit-shift multiply all Bresenham data by the max AMASS
-          // level, such that we never divide beyond the original data anywhere in the algorithm.
-          // If the original data is divided, we can lose a step from integer roundoff.
-          for (idx=0; idx<N_AXIS; idx++) { st_prep_block->steps[idx] = pl_block->steps[idx] << MAX_AMASS_LEVEL; }
-          st_prep_block->step_event_count = pl_block->step_event_count << MAX_AMASS_LEVEL;
+        #ifdef ENABLE_NATIVE_ARCS
+          prep.arc.chord_end = 0.0; // Line blocks trace the block to its end.
+          if (pl_block->arc_axis_0_mask) {
+            // Arc blocks load the Bresenham data of their first chord. See st_prep_arc_chord().
+            prep.arc.chord = 0;
+            prep.arc.chord_mm = pl_block->millimeters/pl_block->arc_chords;
+            prep.arc.chord_end = pl_block->millimeters;
+            memset(prep.arc.steps, 0, sizeof(prep.arc.steps));
+            st_prep_arc_chord();
+          } else
         #endif
+        {
+          // Load the Bresenham stepping data for the block.
+          prep.st_block_index = st_next_block_index(prep.st_block_index);
+
+          // Prepare and copy Bresenham algorithm segment data from the new planner block, so that
+          // when the segment buffer completes the planner block, it may be discarded when the
+          // segment buffer finishes the prepped block, but the stepper ISR is still executing it.
+          st_prep_block = &st_block_buffer[prep.st_block_index];
+          plan_get_block_steps(pl_block, st_prep_block->steps);
+          uint8_t idx;
+          memset(st_prep_block->direction_bits, 0, sizeof(st_prep_block->direction_bits));
+          st_prep_block->axis_direction_bits = pl_block->direction_bits;
+          for (idx=0; idx<N_AXIS; idx++) {
+            // Planner blocks only keep a direction bitmask. Expand it to the direction pins of each port group.
+            if (pl_block->direction_bits & bit(idx)) { st_prep_block->direction_bits[direction_port_group[idx]] |= get_direction_pin_mask(idx); }
+          }
 
-        // Initialize segment buffer data for generating the segments.
-        prep.steps_remaining = (float)pl_block->step_event_count;
-        prep.step_per_mm = prep.steps_remaining/pl_block->millimeters;
-        prep.req_mm_increment = REQ_MM_INCREMENT_SCALAR/prep.step_per_mm;
-        prep.dt_remainder = 0.0; // Reset for new segment block
+          #ifndef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
+            for (idx=0; idx<N_AXIS; idx++) { st_prep_block->steps[idx] <<= 1; }
+            st_prep_block->step_event_count = (pl_block->step_event_count << 1);
+          #else
+            // With AMASS enabled, simply bit-shift multiply all Bresenham data by the max AMASS
+            // level, such that we never divide beyond the original data anywhere in the algorithm.
+            // If the original data is divided, we can lose a step from integer roundoff.
+            for (idx=0; idx<N_AXIS; idx++) { st_prep_block->steps[idx] <<= MAX_AMASS_LEVEL; }
+            st_prep_block->step_event_count = pl_block->step_event_count << MAX_AMASS_LEVEL;
+          #endif
+
+          // Initialize segment buffer data for generating the segments.
+          #ifdef USE_FIXED_POINT_MOTION
+            prep.steps_remaining = pl_block->step_event_count;
+            prep.dist_remaining = (int64_t)pl_block->step_event_count << 32;
+            prep.step_per_mm = pl_block->step_event_count/pl_block->millimeters;
+            st_fp_set_scale();
+            prep.dt_remainder = 0; // Reset for new segment block
+          #else
+            prep.steps_remaining = (float)pl_block->step_event_count;
+            prep.step_per_mm = prep.steps_remaining/pl_block->millimeters;
+            prep.req_mm_increment = REQ_MM_INCREMENT_SCALAR/prep.step_per_mm;
+            prep.dt_remainder = 0.0; // Reset for new segment block
+          #endif
+        }
 
         if ((sys.step_control & STEP_CONTROL_EXECUTE_HOLD) || (prep.recalculate_flag & PREP_FLAG_DECEL_OVERRIDE)) {
           // New block loaded mid-hold. Override planner block entry speed to enforce deceleration.
@@ -902,6 +1809,9 @@ void st_prep_buffer()
         } else {
           prep.current_speed = sqrt(pl_block->entry_speed_sqr);
         }
+        #ifdef USE_FIXED_POINT_MOTION
+          prep.fp_current_speed = prep.current_speed*prep.fp_speed_scale;
+        #endif
 
         // Setup laser mode variables. PWM rate adjusted motions will always complete a motion with the
         // spindle off.
@@ -909,10 +1819,30 @@ void st_prep_buffer()
         if (settings.flags & BITFLAG_LASER_MODE) {
           if (pl_block->condition & PL_COND_FLAG_SPINDLE_CCW) {
             // Pre-compute inverse programmed rate to speed up PWM updating per step segment.
-            prep.inv_rate = 1.0/pl_block->programmed_rate;
+            #ifdef USE_FIXED_POINT_MOTION
+              prep.inv_rate = 1.0/(pl_block->programmed_rate*prep.fp_speed_scale);
+            #else
+              prep.inv_rate = 1.0/pl_block->programmed_rate;
+            #endif
             st_prep_block->is_pwm_rate_adjusted = true;
           }
         }
+
+        #ifdef ENABLE_INLINE_OUTPUT_CHANGES
+          // Compare the spindle, coolant, and digital output states of the new block with the last one.
+          // The stepper ISR sets the changed ones, just prior to the first step of the block. System
+          // motions, like homing and parking, do not alter the outputs.
+          st_prep_block->output_changes = 0;
+          st_prep_block->digital_changes = 0;
+          if (bit_isfalse(pl_block->condition, PL_COND_FLAG_SYSTEM_MOTION)) {
+            st_prep_block->output_condition = pl_block->condition & PL_COND_ACCESSORY_MASK;
+            st_prep_block->output_changes = st_prep_block->output_condition ^ prep.output_condition;
+            prep.output_condition = st_prep_block->output_condition;
+            st_prep_block->digital_state = pl_block->digital_state;
+            st_prep_block->digital_changes = pl_block->digital_state ^ prep.digital_state;
+            prep.digital_state = pl_block->digital_state;
+          }
+        #endif
       }
 
       /* ---------------------------------------------------------------------------------
@@ -922,6 +1852,9 @@ void st_prep_buffer()
        hold, override the planner velocities and decelerate to the target exit speed.
       */
       prep.mm_complete = 0.0; // Default velocity profile complete at 0.0mm from end of block.
+      #ifdef SHAPED_RAMPS
+        st_prep_shaped_profile();
+      #else
       float inv_2_accel = 0.5/pl_block->acceleration;
       if (sys.step_control & STEP_CONTROL_EXECUTE_HOLD) { // [Forced Deceleration to Zero Velocity]
         // Compute velocity profile parameters for a feed hold in-progress. This profile overrides
@@ -1005,10 +1938,35 @@ void st_prep_buffer()
           prep.maximum_speed = prep.exit_speed;
         }
       }
+      #endif
+
+      #ifdef USE_FIXED_POINT_MOTION
+        st_fp_load_profile();
+      #endif
+      #ifdef SHAPED_RAMPS
+        if ((prep.ramp_type == RAMP_ACCEL) || (prep.ramp_type == RAMP_DECEL_OVERRIDE)) {
+          st_prep_ramp(pl_block->millimeters, prep.accelerate_until, prep.maximum_speed);
+        } else if (prep.ramp_type == RAMP_DECEL) {
+          st_prep_ramp(pl_block->millimeters, prep.mm_complete, prep.exit_speed);
+        }
+      #endif
 
       bit_true(sys.step_control, STEP_CONTROL_UPDATE_SPINDLE_PWM); // Force update whenever updating block.
     }
 
+    #ifdef ENABLE_NATIVE_ARCS
+      // Load the next chord of an arc block, once the prepped segments reached the end of the last one.
+      if ((prep.arc.chord_end > 0.0) && (pl_block->millimeters == prep.arc.chord_end)) {
+        uint8_t is_pwm_rate_adjusted = st_prep_block->is_pwm_rate_adjusted;
+        st_prep_arc_chord();
+        st_prep_block->is_pwm_rate_adjusted = is_pwm_rate_adjusted;
+        #ifdef ENABLE_INLINE_OUTPUT_CHANGES
+          st_prep_block->output_changes = 0; // Set by the first chord of the arc block only.
+          st_prep_block->digital_changes = 0;
+        #endif
+      }
+    #endif
+
     // Initialize new segment
     segment_t *prep_segment = &segment_buffer[segment_buffer_head];
 
@@ -1029,89 +1987,260 @@ void st_prep_buffer()
       the end of planner block (typical) or mid-block at the end of a forced deceleration,
       such as from a feed hold.
     */
-    float dt_max = DT_SEGMENT; // Maximum segment time
-    float dt = 0.0; // Initialize segment time
-    float time_var = dt_max; // Time worker variable
-    float mm_var; // mm-Distance worker variable
-    float speed_var; // Speed worker variable
-    float mm_remaining = pl_block->millimeters; // New segment distance from end of block.
-    float minimum_mm = mm_remaining-prep.req_mm_increment; // Guarantee at least one step.
-    if (minimum_mm < 0.0) { minimum_mm = 0.0; }
-
-    do {
-      switch (prep.ramp_type) {
-        case RAMP_DECEL_OVERRIDE:
-          speed_var = pl_block->acceleration*time_var;
-          if (prep.current_speed-prep.maximum_speed <= speed_var) {
-            // Cruise or cruise-deceleration types only for deceleration override.
-            mm_remaining = prep.accelerate_until;
-            time_var = 2.0*(pl_block->millimeters-mm_remaining)/(prep.current_speed+prep.maximum_speed);
-            prep.ramp_type = RAMP_CRUISE;
-            prep.current_speed = prep.maximum_speed;
-          } else { // Mid-deceleration override ramp.
-            mm_remaining -= time_var*(prep.current_speed - 0.5*speed_var);
-            prep.current_speed -= speed_var;
+    #ifdef USE_FIXED_POINT_MOTION
+      // Same ramp sequence as the float computations below, in Q16.16 segment time, Q16.16 steps per
+      // segment speeds and Q32.32 step distances. Full segments integrate exactly with integer adds.
+      int32_t dt_max = FP_SEGMENT_TIME; // Maximum segment time
+      int32_t dt = 0; // Initialize segment time
+      int32_t time_var = dt_max; // Time worker variable
+      int64_t dist_var; // Distance worker variable
+      int32_t speed_var; // Speed worker variable
+      int64_t dist_remaining = prep.dist_remaining; // New segment distance from end of block.
+      int64_t minimum_dist = dist_remaining-FP_REQ_STEP_INCREMENT; // Guarantee at least one step.
+      if (minimum_dist < 0) { minimum_dist = 0; }
+      #if SEGMENT_CRUISE_TICKS > 1
+        // Extend a cruise segment by whole ticks, as long as it ends before the deceleration ramp.
+        // Slow cruises with less than a step per tick keep the regular segment time, since their
+        // step rate may already be clamped to the slowest timer rate.
+        uint8_t n_tick = 1;
+        dist_var = st_fp_dist(prep.fp_maximum_speed, FP_SEGMENT_TIME);
+        if ((prep.ramp_type == RAMP_CRUISE) && (dist_var >= (1LL << 32))) {
+          int64_t cruise_dist = dist_var;
+          while ((n_tick < SEGMENT_CRUISE_TICKS) && (dist_remaining-(cruise_dist+dist_var) >= prep.fp_decelerate_after) &&
+                 ((cruise_dist+dist_var) < ((int64_t)SEGMENT_CRUISE_STEP_LIMIT << 32))) {
+            cruise_dist += dist_var;
+            n_tick++;
           }
-          break;
-        case RAMP_ACCEL:
-          // NOTE: Acceleration ramp only computes during first do-while loop.
-          speed_var = pl_block->acceleration*time_var;
-          mm_remaining -= time_var*(prep.current_speed + 0.5*speed_var);
-          if (mm_remaining < prep.accelerate_until) { // End of acceleration ramp.
-            // Acceleration-cruise, acceleration-deceleration ramp junction, or end of block.
-            mm_remaining = prep.accelerate_until; // NOTE: 0.0 at EOB
-            time_var = 2.0*(pl_block->millimeters-mm_remaining)/(prep.current_speed+prep.maximum_speed);
-            if (mm_remaining == prep.decelerate_after) { prep.ramp_type = RAMP_DECEL; }
-            else { prep.ramp_type = RAMP_CRUISE; }
-            prep.current_speed = prep.maximum_speed;
-          } else { // Acceleration only.
-            prep.current_speed += speed_var;
+          dt_max = n_tick*FP_SEGMENT_TIME;
+          time_var = dt_max;
+        }
+      #endif
+
+      do {
+        switch (prep.ramp_type) {
+          case RAMP_DECEL_OVERRIDE:
+            speed_var = st_fp_speed_delta(time_var);
+            if (prep.fp_current_speed-prep.fp_maximum_speed <= speed_var) {
+              // Cruise or cruise-deceleration types only for deceleration override.
+              dist_remaining = prep.fp_accelerate_until;
+              time_var = st_fp_time(prep.dist_remaining-dist_remaining, prep.fp_current_speed+prep.fp_maximum_speed);
+              prep.ramp_type = RAMP_CRUISE;
+              prep.fp_current_speed = prep.fp_maximum_speed;
+            } else { // Mid-deceleration override ramp.
+              dist_remaining -= st_fp_dist(prep.fp_current_speed-(speed_var >> 1), time_var);
+              prep.fp_current_speed -= speed_var;
+            }
+            break;
+          case RAMP_ACCEL:
+            speed_var = st_fp_speed_delta(time_var);
+            dist_remaining -= st_fp_dist(prep.fp_current_speed+(speed_var >> 1), time_var);
+            if (dist_remaining < prep.fp_accelerate_until) { // End of acceleration ramp.
+              dist_remaining = prep.fp_accelerate_until;
+              time_var = st_fp_time(prep.dist_remaining-dist_remaining, prep.fp_current_speed+prep.fp_maximum_speed);
+              if (dist_remaining == prep.fp_decelerate_after) { prep.ramp_type = RAMP_DECEL; }
+              else { prep.ramp_type = RAMP_CRUISE; }
+              prep.fp_current_speed = prep.fp_maximum_speed;
+            } else { // Acceleration only.
+              prep.fp_current_speed += speed_var;
+            }
+            break;
+          case RAMP_CRUISE:
+            dist_var = dist_remaining - st_fp_dist(prep.fp_maximum_speed, time_var);
+            if (dist_var < prep.fp_decelerate_after) { // End of cruise.
+              time_var = st_fp_time(dist_remaining-prep.fp_decelerate_after, prep.fp_maximum_speed << 1);
+              dist_remaining = prep.fp_decelerate_after;
+              prep.ramp_type = RAMP_DECEL;
+            } else { // Cruising only.
+              dist_remaining = dist_var;
+            }
+            break;
+          default: // case RAMP_DECEL:
+            speed_var = st_fp_speed_delta(time_var);
+            if (prep.fp_current_speed > speed_var) { // Check if at or below zero speed.
+              dist_var = dist_remaining - st_fp_dist(prep.fp_current_speed-(speed_var >> 1), time_var);
+              if (dist_var > prep.fp_mm_complete) { // Typical case. In deceleration ramp.
+                dist_remaining = dist_var;
+                prep.fp_current_speed -= speed_var;
+                break;
+              }
+            }
+            // Otherwise, at end of block or end of forced-deceleration.
+            time_var = st_fp_time(dist_remaining-prep.fp_mm_complete, prep.fp_current_speed+prep.fp_exit_speed);
+            dist_remaining = prep.fp_mm_complete;
+            prep.fp_current_speed = prep.fp_exit_speed;
+        }
+        dt += time_var; // Add computed ramp time to total segment time.
+        if (dt < dt_max) { time_var = dt_max - dt; } // **Incomplete** At ramp junction.
+        else {
+          if (dist_remaining > minimum_dist) { // Check for very slow segments with zero steps.
+            dt_max += FP_SEGMENT_TIME;
+            time_var = dt_max - dt;
+          } else {
+            break; // **Complete** Exit loop. Segment execution time maxed.
           }
-          break;
-        case RAMP_CRUISE:
-          // NOTE: mm_var used to retain the last mm_remaining for incomplete segment time_var calculations.
-          // NOTE: If maximum_speed*time_var value is too low, round-off can cause mm_var to not change. To
-          //   prevent this, simply enforce a minimum speed threshold in the planner.
-          mm_var = mm_remaining - prep.maximum_speed*time_var;
-          if (mm_var < prep.decelerate_after) { // End of cruise.
-            // Cruise-deceleration junction or end of block.
-            time_var = (mm_remaining - prep.decelerate_after)/prep.maximum_speed;
-            mm_remaining = prep.decelerate_after; // NOTE: 0.0 at EOB
-            prep.ramp_type = RAMP_DECEL;
-          } else { // Cruising only.
-            mm_remaining = mm_var;
+        }
+      } while (dist_remaining > prep.fp_mm_complete); // **Complete** Exit loop. Profile complete.
+    #else
+      float dt_max = DT_SEGMENT; // Maximum segment time
+      float dt = 0.0; // Initialize segment time
+      float time_var = dt_max; // Time worker variable
+      float mm_var; // mm-Distance worker variable
+      #if !defined(SHAPED_RAMPS) || defined(ENABLE_NATIVE_ARCS)
+        float speed_var; // Speed worker variable
+      #endif
+      float mm_remaining = pl_block->millimeters; // New segment distance from end of block.
+      float minimum_mm = mm_remaining-prep.req_mm_increment; // Guarantee at least one step.
+      #ifdef ENABLE_NATIVE_ARCS
+        if (minimum_mm < prep.arc.chord_end) { minimum_mm = prep.arc.chord_end; }
+      #else
+        if (minimum_mm < 0.0) { minimum_mm = 0.0; }
+      #endif
+      #if SEGMENT_CRUISE_TICKS > 1
+        // Extend a cruise segment by whole ticks, as long as it ends before the deceleration ramp.
+        // Slow cruises with less than a step per tick keep the regular segment time, since their
+        // step rate may already be clamped to the slowest timer rate.
+        uint8_t n_tick = 1;
+        float cruise_end = prep.decelerate_after;
+        #ifdef ENABLE_NATIVE_ARCS
+          if (cruise_end < prep.arc.chord_end) { cruise_end = prep.arc.chord_end; } // Also ends on the chord end.
+        #endif
+        mm_var = prep.maximum_speed*DT_SEGMENT; // Cruise distance per tick
+        if ((prep.ramp_type == RAMP_CRUISE) && (prep.step_per_mm*mm_var >= 1.0)) {
+          float cruise_mm = mm_var;
+          while ((n_tick < SEGMENT_CRUISE_TICKS) && (mm_remaining-(cruise_mm+mm_var) >= cruise_end) &&
+                 (prep.step_per_mm*(cruise_mm+mm_var) < SEGMENT_CRUISE_STEP_LIMIT)) {
+            cruise_mm += mm_var;
+            n_tick++;
           }
-          break;
-        default: // case RAMP_DECEL:
-          // NOTE: mm_var used as a misc worker variable to prevent errors when near zero speed.
-          speed_var = pl_block->acceleration*time_var; // Used as delta speed (mm/min)
-          if (prep.current_speed > speed_var) { // Check if at or below zero speed.
-            // Compute distance from end of segment to end of block.
-            mm_var = mm_remaining - time_var*(prep.current_speed - 0.5*speed_var); // (mm)
-            if (mm_var > prep.mm_complete) { // Typical case. In deceleration ramp.
-              mm_remaining = mm_var;
+          dt_max = n_tick*DT_SEGMENT;
+          time_var = dt_max;
+        }
+      #endif
+      #ifdef ENABLE_INPUT_SHAPING
+        if (prep.ramp_shaped && (prep.ramp_type != RAMP_CRUISE)) {
+          dt_max = DT_SHAPED_SEGMENT; // Shorter segments within shaped ramps.
+          time_var = dt_max;
+        }
+      #endif
+
+      do {
+        #ifdef ENABLE_NATIVE_ARCS
+          float ramp_start_mm = mm_remaining;
+          float ramp_start_speed = prep.current_speed;
+          uint8_t ramp_start_type = prep.ramp_type;
+        #endif
+        switch (prep.ramp_type) {
+          case RAMP_DECEL_OVERRIDE:
+            #ifndef SHAPED_RAMPS
+            speed_var = pl_block->acceleration*time_var;
+            if (prep.current_speed-prep.maximum_speed <= speed_var) {
+              // Cruise or cruise-deceleration types only for deceleration override.
+              mm_remaining = prep.accelerate_until;
+              time_var = 2.0*(pl_block->millimeters-mm_remaining)/(prep.current_speed+prep.maximum_speed);
+              prep.ramp_type = RAMP_CRUISE;
+              prep.current_speed = prep.maximum_speed;
+            } else { // Mid-deceleration override ramp.
+              mm_remaining -= time_var*(prep.current_speed - 0.5*speed_var);
               prep.current_speed -= speed_var;
-              break; // Segment complete. Exit switch-case statement. Continue do-while loop.
             }
+            break;
+            #endif
+            // Shaped ramps decelerate to the override speed like acceleration ramps. Fall through.
+          case RAMP_ACCEL:
+            #ifdef SHAPED_RAMPS
+              if (st_prep_ramp_step(&mm_remaining, &time_var, prep.accelerate_until)) {
+                // Acceleration-cruise, acceleration-deceleration ramp junction, or end of block.
+                mm_remaining = prep.accelerate_until; // NOTE: 0.0 at EOB
+                prep.current_speed = prep.maximum_speed;
+                if (mm_remaining == prep.decelerate_after) {
+                  prep.ramp_type = RAMP_DECEL;
+                  st_prep_ramp(mm_remaining, prep.mm_complete, prep.exit_speed);
+                } else { prep.ramp_type = RAMP_CRUISE; }
+              }
+            #else
+            // NOTE: Acceleration ramp only computes during first do-while loop.
+            speed_var = pl_block->acceleration*time_var;
+            mm_remaining -= time_var*(prep.current_speed + 0.5*speed_var);
+            if (mm_remaining < prep.accelerate_until) { // End of acceleration ramp.
+              // Acceleration-cruise, acceleration-deceleration ramp junction, or end of block.
+              mm_remaining = prep.accelerate_until; // NOTE: 0.0 at EOB
+              time_var = 2.0*(pl_block->millimeters-mm_remaining)/(prep.current_speed+prep.maximum_speed);
+              if (mm_remaining == prep.decelerate_after) { prep.ramp_type = RAMP_DECEL; }
+              else { prep.ramp_type = RAMP_CRUISE; }
+              prep.current_speed = prep.maximum_speed;
+            } else { // Acceleration only.
+              prep.current_speed += speed_var;
+            }
+            #endif
+            break;
+          case RAMP_CRUISE:
+            // NOTE: mm_var used to retain the last mm_remaining for incomplete segment time_var calculations.
+            // NOTE: If maximum_speed*time_var value is too low, round-off can cause mm_var to not change. To
+            //   prevent this, simply enforce a minimum speed threshold in the planner.
+            mm_var = mm_remaining - prep.maximum_speed*time_var;
+            if (mm_var < prep.decelerate_after) { // End of cruise.
+              // Cruise-deceleration junction or end of block.
+              time_var = (mm_remaining - prep.decelerate_after)/prep.maximum_speed;
+              mm_remaining = prep.decelerate_after; // NOTE: 0.0 at EOB
+              prep.ramp_type = RAMP_DECEL;
+              #ifdef SHAPED_RAMPS
+                st_prep_ramp(mm_remaining, prep.mm_complete, prep.exit_speed);
+              #endif
+            } else { // Cruising only.
+              mm_remaining = mm_var;
+            }
+            break;
+          default: // case RAMP_DECEL:
+            #ifdef SHAPED_RAMPS
+              if (!st_prep_ramp_step(&mm_remaining, &time_var, prep.mm_complete)) { break; }
+            #else
+            // NOTE: mm_var used as a misc worker variable to prevent errors when near zero speed.
+            speed_var = pl_block->acceleration*time_var; // Used as delta speed (mm/min)
+            if (prep.current_speed > speed_var) { // Check if at or below zero speed.
+              // Compute distance from end of segment to end of block.
+              mm_var = mm_remaining - time_var*(prep.current_speed - 0.5*speed_var); // (mm)
+              if (mm_var > prep.mm_complete) { // Typical case. In deceleration ramp.
+                mm_remaining = mm_var;
+                prep.current_speed -= speed_var;
+                break; // Segment complete. Exit switch-case statement. Continue do-while loop.
+              }
+            }
+            time_var = 2.0*(mm_remaining-prep.mm_complete)/(prep.current_speed+prep.exit_speed);
+            #endif
+            // Otherwise, at end of block or end of forced-deceleration.
+            mm_remaining = prep.mm_complete;
+            prep.current_speed = prep.exit_speed;
+        }
+        #ifdef ENABLE_NATIVE_ARCS
+          if (mm_remaining < prep.arc.chord_end) {
+            // Passed the end of the arc chord, which the segment may not step beyond. End the segment on
+            // it instead, within the ramp it started from. Ramps have constant acceleration.
+            mm_var = ramp_start_mm-prep.arc.chord_end;
+            speed_var = ramp_start_speed*ramp_start_speed; // Used as speed squared at chord end
+            if (ramp_start_type == RAMP_ACCEL) { speed_var += 2.0*pl_block->acceleration*mm_var; }
+            else if (ramp_start_type != RAMP_CRUISE) { speed_var -= 2.0*pl_block->acceleration*mm_var; }
+            if (speed_var > 0.0) { prep.current_speed = sqrt(speed_var); }
+            else { prep.current_speed = 0.0; }
+            dt += 2.0*mm_var/(ramp_start_speed+prep.current_speed);
+            prep.ramp_type = ramp_start_type;
+            mm_remaining = prep.arc.chord_end;
+            break;
+          }
+        #endif
+        dt += time_var; // Add computed ramp time to total segment time.
+        if (dt < dt_max) { time_var = dt_max - dt; } // **Incomplete** At ramp junction.
+        else {
+          if (mm_remaining > minimum_mm) { // Check for very slow segments with zero steps.
+            // Increase segment time to ensure at least one step in segment. Override and loop
+            // through distance calculations until minimum_mm or mm_complete.
+            dt_max += DT_SEGMENT;
+            time_var = dt_max - dt;
+          } else {
+            break; // **Complete** Exit loop. Segment execution time maxed.
           }
-          // Otherwise, at end of block or end of forced-deceleration.
-          time_var = 2.0*(mm_remaining-prep.mm_complete)/(prep.current_speed+prep.exit_speed);
-          mm_remaining = prep.mm_complete;
-          prep.current_speed = prep.exit_speed;
-      }
-      dt += time_var; // Add computed ramp time to total segment time.
-      if (dt < dt_max) { time_var = dt_max - dt; } // **Incomplete** At ramp junction.
-      else {
-        if (mm_remaining > minimum_mm) { // Check for very slow segments with zero steps.
-          // Increase segment time to ensure at least one step in segment. Override and loop
-          // through distance calculations until minimum_mm or mm_complete.
-          dt_max += DT_SEGMENT;
-          time_var = dt_max - dt;
-        } else {
-          break; // **Complete** Exit loop. Segment execution time maxed.
         }
-      }
-    } while (mm_remaining > prep.mm_complete); // **Complete** Exit loop. Profile complete.
+      } while (mm_remaining > prep.mm_complete); // **Complete** Exit loop. Profile complete.
+    #endif
 
 
     /* -----------------------------------------------------------------------------------
@@ -1122,7 +2251,11 @@ void st_prep_buffer()
       if (pl_block->condition & (PL_COND_FLAG_SPINDLE_CW | PL_COND_FLAG_SPINDLE_CCW)) {
         float rpm = pl_block->spindle_speed;
         // NOTE: Feed and rapid overrides are independent of PWM value and do not alter laser power/rate.
-        if (st_prep_block->is_pwm_rate_adjusted) { rpm *= (prep.current_speed * prep.inv_rate); }
+        #ifdef USE_FIXED_POINT_MOTION
+          if (st_prep_block->is_pwm_rate_adjusted) { rpm *= (prep.fp_current_speed * prep.inv_rate); }
+        #else
+          if (st_prep_block->is_pwm_rate_adjusted) { rpm *= (prep.current_speed * prep.inv_rate); }
+        #endif
         // If current_speed is zero, then may need to be rpm_min*(100/MAX_SPINDLE_SPEED_OVERRIDE)
         // but this would be instantaneous only and during a motion. May not matter at all.
         prep.current_spindle_pwm = spindle_compute_pwm_value(rpm);
@@ -1133,6 +2266,9 @@ void st_prep_buffer()
       bit_false(sys.step_control,STEP_CONTROL_UPDATE_SPINDLE_PWM);
     }
     prep_segment->spindle_pwm = prep.current_spindle_pwm; // Reload segment PWM value
+    #if SEGMENT_CRUISE_TICKS > 1
+      prep_segment->n_tick = n_tick;
+    #endif
 
 
     /* -----------------------------------------------------------------------------------
@@ -1145,10 +2281,19 @@ void st_prep_buffer()
        Fortunately, this scenario is highly unlikely and unrealistic in CNC machines
        supported by Grbl (i.e. exceeding 10 meters axis travel at 200 step/mm).
     */
-    float step_dist_remaining = prep.step_per_mm*mm_remaining; // Convert mm_remaining to steps
-    float n_steps_remaining = ceil(step_dist_remaining); // Round-up current steps remaining
-    float last_n_steps_remaining = ceil(prep.steps_remaining); // Round-up last steps remaining
-    prep_segment->n_step = last_n_steps_remaining-n_steps_remaining; // Compute number of steps to execute.
+    #ifdef USE_FIXED_POINT_MOTION
+      uint32_t n_steps_remaining = (dist_remaining + 0xFFFFFFFF) >> 32; // Round-up current steps remaining
+      prep_segment->n_step = prep.steps_remaining-n_steps_remaining; // Compute number of steps to execute.
+    #else
+      #ifdef ENABLE_NATIVE_ARCS
+        float step_dist_remaining = prep.step_per_mm*(mm_remaining-prep.arc.chord_end); // Steps to chord end
+      #else
+        float step_dist_remaining = prep.step_per_mm*mm_remaining; // Convert mm_remaining to steps
+      #endif
+      float n_steps_remaining = ceil(step_dist_remaining); // Round-up current steps remaining
+      float last_n_steps_remaining = ceil(prep.steps_remaining); // Round-up last steps remaining
+      prep_segment->n_step = last_n_steps_remaining-n_steps_remaining; // Compute number of steps to execute.
+    #endif
 
     // Bail if we are at the end of a feed hold and don't have a step to execute.
     if (prep_segment->n_step == 0) {
@@ -1171,11 +2316,27 @@ void st_prep_buffer()
     // adjusts the whole segment rate to keep step output exact. These rate adjustments are
     // typically very small and do not adversely effect performance, but ensures that Grbl
     // outputs the exact acceleration and velocity profiles as computed by the planner.
-    dt += prep.dt_remainder; // Apply previous segment partial step execute time
-    float inv_rate = dt/(last_n_steps_remaining - step_dist_remaining); // Compute adjusted step rate inverse
+    #ifdef USE_FIXED_POINT_MOTION
+      // Same computation in CPU cycles. The one division is left in float, which costs no more than
+      // a 32-bit integer division on the AVR, but keeps the full precision of the Q16.16 distance to
+      // the last step. Rates beyond 2^24 cycles/step are far slower than the timers can step anyway.
+      uint32_t step_dist = (((int64_t)prep.steps_remaining << 32) - dist_remaining) >> 16; // (Q16.16 steps)
+      if (step_dist == 0) { step_dist = 1; }
+      uint32_t cycles = (((uint64_t)dt*FP_CYCLES_PER_SEGMENT) >> 16) + prep.dt_remainder; // (cycles)
+      float inv_rate = (65536.0*cycles)/step_dist; // (cycles/step)
+      if (inv_rate < (1UL << 24)) { cycles = ceil(inv_rate); }
+      else { cycles = (1UL << 24) - 1; }
+      // Execute time of the partial step left at the end of the segment. Rounded, since any bias
+      // here accumulates over the segments of the block.
+      uint32_t dt_remainder =
+        (uint32_t)((((int64_t)n_steps_remaining << 32) - dist_remaining) >> 16)*(cycles/65536.0) + 0.5;
+    #else
+      dt += prep.dt_remainder; // Apply previous segment partial step execute time
+      float inv_rate = dt/(last_n_steps_remaining - step_dist_remaining); // Compute adjusted step rate inverse
 
-    // Compute CPU cycles per step for the prepped segment.
-    uint32_t cycles = ceil( (TICKS_PER_MICROSECOND*1000000*60)*inv_rate ); // (cycles/step)
+      // Compute CPU cycles per step for the prepped segment.
+      uint32_t cycles = ceil( (TICKS_PER_MICROSECOND*1000000*60)*inv_rate ); // (cycles/step)
+    #endif
 
     #ifdef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
       // Compute step timing and multi-axis smoothing level.
@@ -1211,16 +2372,30 @@ void st_prep_buffer()
     // Segment complete! Increment segment buffer indices, so stepper ISR can immediately execute it.
     segment_buffer_head = segment_next_head;
     if ( ++segment_next_head == SEGMENT_BUFFER_SIZE ) { segment_next_head = 0; }
+    #ifdef STEPPER_ISR_PROFILER
+      st_prep_profile_update(prep_start_count);
+    #endif
 
     // Update the appropriate planner and segment data.
-    pl_block->millimeters = mm_remaining;
-    prep.steps_remaining = n_steps_remaining;
-    prep.dt_remainder = (n_steps_remaining - step_dist_remaining)*inv_rate;
+    #ifdef USE_FIXED_POINT_MOTION
+      pl_block->millimeters = dist_remaining*prep.fp_mm_scale;
+      prep.dist_remaining = dist_remaining;
+      prep.steps_remaining = n_steps_remaining;
+      prep.dt_remainder = dt_remainder;
+      uint8_t profile_complete = (dist_remaining == prep.fp_mm_complete);
+      uint8_t forced_termination = (dist_remaining > 0); // Only valid with profile_complete.
+    #else
+      pl_block->millimeters = mm_remaining;
+      prep.steps_remaining = n_steps_remaining;
+      prep.dt_remainder = (n_steps_remaining - step_dist_remaining)*inv_rate;
+      uint8_t profile_complete = (mm_remaining == prep.mm_complete);
+      uint8_t forced_termination = (mm_remaining > 0.0); // Only valid with profile_complete.
+    #endif
 
     // Check for exit conditions and flag to load next planner block.
-    if (mm_remaining == prep.mm_complete) {
+    if (profile_complete) {
       // End of planner block or forced-termination. No more distance to be executed.
-      if (mm_remaining > 0.0) { // At end of forced-termination.
+      if (forced_termination) { // At end of forced-termination.
         // Reset prep parameters for resuming and then bail. Allow the stepper ISR to complete
         // the segment queue, where realtime protocol will set new state upon receiving the
         // cycle stop flag from the ISR. Prep_segment is blocked until then.
@@ -1244,6 +2419,24 @@ void st_prep_buffer()
 }
 
 
+// Copies the real-time machine position in steps, including the steps of the executing segment
+// that the stepper ISR has not added to sys_position yet.
+void st_get_position(int32_t *position)
+{
+  uint8_t idx;
+  uint8_t sreg = SREG;
+  cli();
+  memcpy(position, sys_position, sizeof(sys_position));
+  if (st.exec_block != NULL) {
+    for (idx=0; idx<N_AXIS; idx++) {
+      if (st.exec_block->axis_direction_bits & bit(idx)) { position[idx] -= st.segment_steps[idx]; }
+      else { position[idx] += st.segment_steps[idx]; }
+    }
+  }
+  SREG = sreg;
+}
+
+
 // Called by realtime status reporting to fetch the current speed being executed. This value
 // however is not exactly the current speed, but the speed computed in the last step segment
 // in the segment buffer. It will always be behind by up to the number of segment blocks (-1)
@@ -1251,7 +2444,33 @@ void st_prep_buffer()
 float st_get_realtime_rate()
 {
   if (sys.state & (STATE_CYCLE | STATE_HOMING | STATE_HOLD | STATE_JOG | STATE_SAFETY_DOOR)){
-    return prep.current_speed;
+    #ifdef USE_FIXED_POINT_MOTION
+      return st_fp_current_speed();
+    #else
+      return prep.current_speed;
+    #endif
   }
   return 0.0f;
 }
+
+
+#ifdef STEPPER_ISR_PROFILER
+  // Called by the ISR profile report. Copies and clears the counters atomically, so the next report
+  // covers the time since this one.
+  void st_isr_profile_fetch(st_isr_profile_t *profile)
+  {
+    uint8_t sreg = SREG;
+    cli();
+    memcpy(profile, isr_profile, sizeof(isr_profile));
+    memset(isr_profile, 0, sizeof(isr_profile));
+    SREG = sreg;
+  }
+
+
+  // Called by the ISR profile report. Only the main program writes these counters.
+  void st_prep_profile_fetch(st_prep_profile_t *profile)
+  {
+    memcpy(profile, &prep_profile, sizeof(prep_profile));
+    memset(&prep_profile, 0, sizeof(prep_profile));
+  }
+#endif
@@ -39,6 +39,14 @@ void st_go_idle();
 // Generate the step and direction port invert masks.
 void st_generate_step_dir_invert_masks();
 
+#ifdef ENABLE_INPUT_SHAPING
+  // Computes the input shaper impulses from the shaper settings.
+  void st_generate_input_shaper();
+
+  // Returns the time the input shaper adds to each shaped ramp in (min). Zero when shaping is disabled.
+  float st_get_input_shaper_time();
+#endif
+
 // Reset the stepper subsystem variables
 void st_reset();
 
@@ -54,7 +62,45 @@ void st_prep_buffer();
 // Called by planner_recalculate() when the executing block is updated by the new plan.
 void st_update_plan_block_parameters();
 
+#ifdef SHAPED_RAMPS
+  // Returns true while the step segment buffer is executing the planner block at the buffer tail.
+  uint8_t st_is_block_in_progress();
+#endif
+
 // Called by realtime status reporting if realtime rate reporting is enabled in config.h.
 float st_get_realtime_rate();
 
+// Copies the real-time machine position in steps, which sys_position only holds up to the
+// executing step segment.
+void st_get_position(int32_t *position);
+
+#ifdef STEPPER_ISR_PROFILER
+  #define ISR_PROFILE_LEVELS 4        // One profile per AMASS level, 0 to MAX_AMASS_LEVEL.
+  #define ISR_PROFILE_BINS 8          // Histogram bins. The last bin collects all longer ticks.
+  #define ISR_PROFILE_BIN_CYCLES 64   // Histogram bin width in CPU cycles. 4usec at 16MHz.
+
+  typedef struct {
+    uint32_t count;        // Number of profiled ISR ticks.
+    uint32_t sum;          // Sum of their durations in CPU cycles, for the mean.
+    uint16_t min;          // Shortest and longest ISR durations in CPU cycles.
+    uint16_t max;
+    uint16_t latency_max;  // Longest delay from Timer1 compare match to ISR entry in CPU cycles.
+    uint16_t overruns;     // ISR ticks that ran past the next Timer1 compare match.
+    uint16_t histogram[ISR_PROFILE_BINS];
+  } st_isr_profile_t;
+
+  typedef struct {
+    uint32_t count;        // Number of step segments prepared.
+    uint32_t sum;          // Sum of their preparation times in CPU cycles, for the mean.
+    uint32_t min;          // Shortest and longest preparation times in CPU cycles.
+    uint32_t max;
+  } st_prep_profile_t;
+
+  // Copies the stepper ISR profile of each AMASS level into profile[] and clears the counters.
+  void st_isr_profile_fetch(st_isr_profile_t *profile);
+
+  // Copies the step segment preparation profile into profile and clears the counters.
+  void st_prep_profile_fetch(st_prep_profile_t *profile);
+#endif
+
 #endif
@@ -103,6 +103,43 @@ void system_execute_startup(char *line)
 }
 
 
+// Switches the serial baud rate until the next power-up, for the $B= command. Grbl announces the
+// switch at the current baud rate and, once sent, switches. The host must then confirm with a line
+// holding '$B' at the new baud rate within SERIAL_BAUD_CONFIRM_TIMEOUT, which is answered by 'ok'.
+// Otherwise, Grbl falls back to the previous baud rate and answers with an error.
+static uint8_t system_switch_baud_rate(uint32_t baud_rate)
+{
+  if (!serial_check_baud_rate(baud_rate)) { return(STATUS_BAUD_RATE_ERROR); }
+  uint32_t previous_rate = serial_get_baud_rate();
+  report_feedback_message(MESSAGE_BAUD_RATE_SWITCH);
+  while (serial_get_tx_buffer_count()) {} // Wait until sent, but for the last two bytes in the USART.
+  delay_us(20000000/previous_rate + 1); // Two bytes of 10 bits.
+  serial_set_baud_rate(baud_rate);
+  serial_reset_read_buffer(); // Drop anything the host sent at the previous baud rate.
+
+  uint8_t matched = 0; // Characters of the "$B" confirmation received.
+  uint16_t timeout = SERIAL_BAUD_CONFIRM_TIMEOUT;
+  do {
+    uint8_t c;
+    while ((c = serial_read()) != SERIAL_NO_DATA) {
+      if ((c == '\n') || (c == '\r')) {
+        if (matched == 2) { return(STATUS_OK); }
+        matched = 0;
+      } else if ((matched == 0) && (c == '$')) { matched = 1; }
+      else if ((matched == 1) && ((c == 'B') || (c == 'b'))) { matched = 2; }
+      else { matched = 3; } // Anything else, including garbled data, until the line end.
+    }
+    protocol_execute_realtime(); // Keep realtime commands working. A reset aborts and keeps the new rate.
+    if (sys.abort) { return(STATUS_OK); }
+    delay_ms(1);
+  } while (--timeout);
+
+  serial_set_baud_rate(previous_rate);
+  serial_reset_read_buffer();
+  return(STATUS_BAUD_RATE_ERROR);
+}
+
+
 // Directs and executes one line of formatted input from protocol_process. While mostly
 // incoming streaming g-code blocks, this also executes Grbl internal commands, such as
 // settings, initiating the homing cycle, and toggling switch states. This differs from
@@ -280,6 +317,13 @@ uint8_t system_execute_line(char *line)
           #endif
           }
           break;
+        case 'B' : // Switch serial baud rate until power-up. [IDLE/ALARM]
+          if (line[++char_counter] != '=') { return(STATUS_INVALID_STATEMENT); }
+          char_counter++;
+          if (!read_float(line, &char_counter, &value)) { return(STATUS_BAUD_RATE_ERROR); }
+          if (line[char_counter] != 0) { return(STATUS_INVALID_STATEMENT); }
+          if ((value < 0.0) || (value > F_CPU/8)) { return(STATUS_BAUD_RATE_ERROR); }
+          return(system_switch_baud_rate(value));
         case 'R' : // Restore defaults [IDLE/ALARM]
           if ((line[2] != 'S') || (line[3] != 'T') || (line[4] != '=') || (line[6] != 0)) { return(STATUS_INVALID_STATEMENT); }
           switch (line[5]) {
@@ -294,6 +338,7 @@ uint8_t system_execute_line(char *line)
             #endif
             default: return(STATUS_INVALID_STATEMENT);
           }
+          eeprom_flush(); // Ensure the restore is stored before reporting, since a power cycle may follow.
           report_feedback_message(MESSAGE_RESTORE_DEFAULTS);
           mc_reset(); // Force reset to ensure settings are initialized correctly.
           break;
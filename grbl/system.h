@@ -167,9 +167,27 @@ extern uint8_t axis_H_mask; // Global mask for axis C bits
 extern unsigned char axis_name[N_AXIS]; // Global table of axis names
 #ifdef DEBUG
   #define EXEC_DEBUG_REPORT  bit(0)
+#endif
+#ifdef STEPPER_ISR_PROFILER
+  #define EXEC_ISR_PROFILE_REPORT  bit(1)
+#endif
+#ifdef REPORT_FIELD_STARVATION_COUNTERS
+  #define EXEC_STARVATION_RESET  bit(2)
+#endif
+#if defined(DEBUG) || defined(STEPPER_ISR_PROFILER) || defined(REPORT_FIELD_STARVATION_COUNTERS)
   extern volatile uint8_t sys_rt_exec_debug;
 #endif
 
+#ifdef REPORT_FIELD_STARVATION_COUNTERS
+  // Buffer starvation event counters, reported by the '|St:' status report field. They wrap around.
+  typedef struct {
+    uint16_t planner;          // Segment preparation found the planner buffer empty during a cycle.
+    volatile uint16_t segment; // Stepper ISR found the segment buffer empty with planner steps left.
+    uint16_t serial;           // Serial read buffer ran empty with free planner blocks during a cycle.
+  } starvation_t;
+  extern starvation_t sys_starvation;
+#endif
+
 // Initialize the serial protocol
 void system_init();
 
@@ -0,0 +1,35 @@
+/*
+  interrupt.h - AVR interrupt stubs for the Grbl host simulator
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Interrupt service routines become ordinary functions named after their vector, which the
+// simulator calls when the matching virtual timer or serial event fires. The global interrupt
+// flag lives in bit 7 of the stubbed SREG, so `sreg = SREG; cli(); ... SREG = sreg;` blocks
+// keep their meaning. Interrupts that come due while the flag is clear are held pending.
+
+#ifndef sim_avr_interrupt_h
+#define sim_avr_interrupt_h
+
+#include "avr/io.h"
+
+#define SREG_I 7
+
+#define ISR(vector, ...) void vector(void)
+#define sei() (SREG |= (1<<SREG_I))
+#define cli() (SREG &= ~(1<<SREG_I))
+
+#endif
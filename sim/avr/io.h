@@ -0,0 +1,204 @@
+/*
+  io.h - ATmega2560 register stubs for the Grbl host simulator
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Every I/O register used by Grbl is modeled as a plain volatile global. The firmware reads and
+// writes them exactly as it would on the AVR, and the simulator inspects them after each
+// interrupt to drive the virtual timers, the serial port and the step/direction log.
+
+#ifndef sim_avr_io_h
+#define sim_avr_io_h
+
+#include <stdint.h>
+
+#define SIM_REGISTERS_8(X) \
+  X(SREG) \
+  X(PINA) X(DDRA) X(PORTA) X(PINB) X(DDRB) X(PORTB) X(PINC) X(DDRC) X(PORTC) \
+  X(PIND) X(DDRD) X(PORTD) X(PINE) X(DDRE) X(PORTE) X(PINF) X(DDRF) X(PORTF) \
+  X(PING) X(DDRG) X(PORTG) X(PINH) X(DDRH) X(PORTH) X(PINJ) X(DDRJ) X(PORTJ) \
+  X(PINK) X(DDRK) X(PORTK) X(PINL) X(DDRL) X(PORTL) \
+  X(TCCR0A) X(TCCR0B) X(TCNT0) X(OCR0A) X(OCR0B) X(TIMSK0) X(TIFR0) \
+  X(TCCR1A) X(TCCR1B) X(TCCR1C) X(TIMSK1) X(TIFR1) \
+  X(TCCR2A) X(TCCR2B) X(TCNT2) X(OCR2A) X(OCR2B) X(TIMSK2) X(TIFR2) \
+  X(TCCR3A) X(TCCR3B) X(TCCR3C) X(TIMSK3) X(TIFR3) \
+  X(TCCR4A) X(TCCR4B) X(TCCR4C) X(TIMSK4) X(TIFR4) \
+  X(TCCR5A) X(TCCR5B) X(TCCR5C) X(TIMSK5) X(TIFR5) \
+  X(UCSR0A) X(UCSR0B) X(UCSR0C) X(UBRR0H) X(UBRR0L) X(UDR0) \
+  X(EECR) X(EEDR) X(EEARH) X(EEARL) \
+  X(PCICR) X(PCIFR) X(PCMSK0) X(PCMSK1) X(PCMSK2) \
+  X(EICRA) X(EICRB) X(EIMSK) X(EIFR) \
+  X(MCUSR) X(WDTCSR) X(SMCR) X(ADCSRA) X(ADCSRB) X(ADMUX) X(ADCL) X(ADCH)
+
+#define SIM_REGISTERS_16(X) \
+  X(TCNT1) X(OCR1A) X(OCR1B) X(OCR1C) X(ICR1) \
+  X(TCNT3) X(OCR3A) X(OCR3B) X(OCR3C) X(ICR3) \
+  X(TCNT4) X(OCR4A) X(OCR4B) X(OCR4C) X(ICR4) \
+  X(TCNT5) X(OCR5A) X(OCR5B) X(OCR5C) X(ICR5) \
+  X(EEAR) X(UBRR0) X(ADC)
+
+#define SIM_DECLARE_REGISTER_8(reg) extern volatile uint8_t reg;
+#define SIM_DECLARE_REGISTER_16(reg) extern volatile uint16_t reg;
+SIM_REGISTERS_8(SIM_DECLARE_REGISTER_8)
+SIM_REGISTERS_16(SIM_DECLARE_REGISTER_16)
+
+// Timer/counter control bits. Shared by all timers, as on the AVR.
+#define CS00 0
+#define CS01 1
+#define CS02 2
+#define WGM00 0
+#define WGM01 1
+#define WGM02 3
+#define COM0B0 4
+#define COM0B1 5
+#define COM0A0 6
+#define COM0A1 7
+#define TOIE0 0
+#define OCIE0A 1
+#define OCIE0B 2
+
+#define CS10 0
+#define CS11 1
+#define CS12 2
+#define WGM10 0
+#define WGM11 1
+#define WGM12 3
+#define WGM13 4
+#define COM1C0 2
+#define COM1C1 3
+#define COM1B0 4
+#define COM1B1 5
+#define COM1A0 6
+#define COM1A1 7
+#define TOIE1 0
+#define OCIE1A 1
+#define OCIE1B 2
+#define OCIE1C 3
+
+#define CS20 0
+#define CS21 1
+#define CS22 2
+#define WGM20 0
+#define WGM21 1
+#define WGM22 3
+#define COM2B0 4
+#define COM2B1 5
+#define COM2A0 6
+#define COM2A1 7
+#define TOIE2 0
+#define OCIE2A 1
+#define OCIE2B 2
+
+#define CS30 0
+#define CS31 1
+#define CS32 2
+#define WGM30 0
+#define WGM31 1
+#define WGM32 3
+#define WGM33 4
+#define COM3C0 2
+#define COM3C1 3
+#define COM3B0 4
+#define COM3B1 5
+#define COM3A0 6
+#define COM3A1 7
+#define TOIE3 0
+#define OCIE3A 1
+#define OCIE3B 2
+#define OCIE3C 3
+#define OCF3B 2
+
+#define CS40 0
+#define CS41 1
+#define CS42 2
+#define WGM40 0
+#define WGM41 1
+#define WGM42 3
+#define WGM43 4
+#define COM4C0 2
+#define COM4C1 3
+#define COM4B0 4
+#define COM4B1 5
+#define COM4A0 6
+#define COM4A1 7
+#define TOIE4 0
+#define OCIE4A 1
+#define OCIE4B 2
+#define OCIE4C 3
+
+#define CS50 0
+#define CS51 1
+#define CS52 2
+#define WGM50 0
+#define WGM51 1
+#define WGM52 3
+#define WGM53 4
+#define COM5C0 2
+#define COM5C1 3
+#define COM5B0 4
+#define COM5B1 5
+#define COM5A0 6
+#define COM5A1 7
+#define TOIE5 0
+#define OCIE5A 1
+#define OCIE5B 2
+#define OCIE5C 3
+#define FOC5C 5
+#define FOC5B 6
+#define FOC5A 7
+
+// USART0 bits
+#define MPCM0 0
+#define U2X0 1
+#define UPE0 2
+#define DOR0 3
+#define FE0 4
+#define UDRE0 5
+#define TXC0 6
+#define RXC0 7
+#define TXB80 0
+#define RXB80 1
+#define UCSZ02 2
+#define TXEN0 3
+#define RXEN0 4
+#define UDRIE0 5
+#define TXCIE0 6
+#define RXCIE0 7
+#define UCSZ00 1
+#define UCSZ01 2
+
+// EEPROM control bits
+#define EERE 0
+#define EEPE 1
+#define EEMPE 2
+#define EERIE 3
+#define EEPM0 4
+#define EEPM1 5
+
+// Pin change and external interrupt bits
+#define PCIE0 0
+#define PCIE1 1
+#define PCIE2 2
+
+// Watchdog, sleep and ADC bits
+#define WDRF 3
+#define WDE 3
+#define WDCE 4
+#define SE 0
+#define ADEN 7
+#define ADSC 6
+
+#endif
@@ -0,0 +1,108 @@
+#!/usr/bin/env python3
+"""\
+Compares two step logs written by the Grbl host simulator
+
+Meant to check a change to the step generation, such as the
+USE_FIXED_POINT_MOTION option, against a reference build on the
+same G-code. For every axis it reports the step count and the
+final position of both logs, and how far the time of each step
+deviates between them. Steps are paired in order per axis, with
+both logs aligned on their first step, so the start-up delay of
+the simulator does not count.
+
+The simulator feeds the input against wall-clock time, so a program
+that streams while it runs does not plan the same way twice. Hold
+the cycle with '!' until the whole program is queued, then start it
+with '~', and compare the reference with itself first to see the
+noise floor.
+
+Usage: compare_steps.py reference.log test.log
+
+---------------------
+Part of Grbl
+
+Grbl is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Grbl is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+---------------------
+"""
+
+import math
+import sys
+
+F_CPU = 16000000.0
+
+
+def read_log(filename):
+    """Returns the clock rate and, per axis name, the step times and the final position."""
+    f_cpu = F_CPU
+    steps = {}
+    position = {}
+    direction = {}
+    with open(filename) as log:
+        for line in log:
+            if line.startswith('#'):
+                if 'CPU cycles at' in line:
+                    f_cpu = float(line.split('CPU cycles at')[1].split()[0])
+                continue
+            fields = line.split()
+            if len(fields) != 5:
+                continue
+            time, axis, pin, level = int(fields[0]), fields[2], fields[3], int(fields[4])
+            steps.setdefault(axis, [])
+            position.setdefault(axis, 0)
+            if pin == 'dir':
+                direction[axis] = level
+            elif level:  # Rising edge starts the step pulse.
+                steps[axis].append(time)
+                position[axis] += -1 if direction.get(axis, 0) else 1
+    return f_cpu, steps, position
+
+
+def first_step(steps):
+    times = [axis_steps[0] for axis_steps in steps.values() if axis_steps]
+    return min(times) if times else 0
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit(__doc__.split('---')[0].rstrip())
+    f_cpu, ref_steps, ref_position = read_log(sys.argv[1])
+    _, test_steps, test_position = read_log(sys.argv[2])
+    ref_start = first_step(ref_steps)
+    test_start = first_step(test_steps)
+    usec = 1e6/f_cpu
+
+    mismatch = False
+    print('axis   steps(ref)  steps(test)  pos(ref)  pos(test)  dt mean(us)  dt rms(us)  dt max(us)')
+    for axis in sorted(set(ref_steps) | set(test_steps)):
+        ref = [t - ref_start for t in ref_steps.get(axis, [])]
+        test = [t - test_start for t in test_steps.get(axis, [])]
+        if len(ref) != len(test) or ref_position.get(axis) != test_position.get(axis):
+            mismatch = True
+        deltas = [(b - a)*usec for a, b in zip(ref, test)]
+        if deltas:
+            mean = sum(deltas)/len(deltas)
+            rms = math.sqrt(sum(d*d for d in deltas)/len(deltas))
+            worst = max(deltas, key=abs)
+        else:
+            mean = rms = worst = 0.0
+        print('%-4s %11d %12d %9d %10d %12.2f %11.2f %11.2f' % (axis, len(ref), len(test),
+              ref_position.get(axis, 0), test_position.get(axis, 0), mean, rms, worst))
+
+    ref_end = max([s[-1] for s in ref_steps.values() if s] or [ref_start]) - ref_start
+    test_end = max([s[-1] for s in test_steps.values() if s] or [test_start]) - test_start
+    print('duration: %.6f s (ref), %.6f s (test)' % (ref_end/f_cpu, test_end/f_cpu))
+    if mismatch:
+        print('MISMATCH: step counts or final positions differ.')
+        sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()
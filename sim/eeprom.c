@@ -0,0 +1,88 @@
+/*
+  eeprom.c - EEPROM emulation for the Grbl host simulator
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Replaces grbl/eeprom.c. The AVR version drives EECR/EEDR directly, which a register stub
+// cannot answer, so the 4KB EEPROM is kept in memory instead and optionally backed by a file.
+
+#include <stdio.h>
+#include <string.h>
+#include "simulator.h"
+#include "../grbl/eeprom.h"
+
+#define SIM_EEPROM_SIZE 4096
+
+static unsigned char sim_eeprom[SIM_EEPROM_SIZE];
+static FILE *sim_eeprom_file = NULL;
+
+
+// Loads the EEPROM image from a file, if given. A missing or short file reads as erased (0xFF),
+// which makes Grbl restore its defaults on the first run.
+void sim_eeprom_init(const char *filename)
+{
+  memset(sim_eeprom, 0xff, SIM_EEPROM_SIZE);
+  if (filename == NULL) { return; }
+  sim_eeprom_file = fopen(filename, "r+b");
+  if (sim_eeprom_file == NULL) { sim_eeprom_file = fopen(filename, "w+b"); }
+  if (sim_eeprom_file == NULL) { perror(filename); return; }
+  if (fread(sim_eeprom, 1, SIM_EEPROM_SIZE, sim_eeprom_file)) { }
+}
+
+
+unsigned char eeprom_get_char(unsigned int addr)
+{
+  return(sim_eeprom[addr % SIM_EEPROM_SIZE]);
+}
+
+
+void eeprom_put_char(unsigned int addr, unsigned char new_value)
+{
+  addr %= SIM_EEPROM_SIZE;
+  sim_eeprom[addr] = new_value;
+  if (sim_eeprom_file != NULL) {
+    fseek(sim_eeprom_file, addr, SEEK_SET);
+    fputc(new_value, sim_eeprom_file);
+    fflush(sim_eeprom_file);
+  }
+}
+
+
+// Writes above are immediate, so there is never anything pending to program.
+void eeprom_flush() { }
+
+// Same algorithm as grbl/eeprom.c, so images are interchangeable with a real controller.
+void memcpy_to_eeprom_with_checksum(unsigned int destination, char *source, unsigned int size) {
+  unsigned char checksum = 0;
+  for(; size > 0; size--) {
+    checksum = (checksum << 1) || (checksum >> 7);
+    checksum += *source;
+    eeprom_put_char(destination++, *(source++));
+  }
+  eeprom_put_char(destination, checksum);
+}
+
+
+int memcpy_from_eeprom_with_checksum(char *destination, unsigned int source, unsigned int size) {
+  unsigned char data, checksum = 0;
+  for(; size > 0; size--) {
+    data = eeprom_get_char(source++);
+    checksum = (checksum << 1) || (checksum >> 7);
+    checksum += data;
+    *(destination++) = data;
+  }
+  return(checksum == eeprom_get_char(source));
+}
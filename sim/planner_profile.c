@@ -0,0 +1,85 @@
+/*
+  planner_profile.c - planner timing for the Grbl host simulator
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* The simulator is linked with --wrap=plan_buffer_line, so every call from the motion control
+   and jogging code passes through here. With -p, the host time spent planning each block is
+   measured and summarized on exit. The simulator watchdog is held off while a block is planned, so
+   interrupt emulation is not counted. Host times are no substitute for AVR cycle counts, but
+   they compare planner algorithms on the same G-code trace.
+*/
+
+#include <inttypes.h>
+#include <signal.h>
+#include <time.h>
+#include "../grbl/grbl.h"
+#include "simulator.h"
+
+#define SIM_PLANNER_HISTOGRAM_BINS 8 // Power of two bins from 1 us.
+
+static struct {
+  uint32_t blocks;
+  uint32_t empty;
+  uint64_t total_ns;
+  uint64_t max_ns;
+  uint32_t histogram[SIM_PLANNER_HISTOGRAM_BINS];
+} profile;
+
+uint8_t __real_plan_buffer_line(float *target, plan_line_data_t *pl_data);
+
+
+uint8_t __wrap_plan_buffer_line(float *target, plan_line_data_t *pl_data)
+{
+  if (!sim.planner_profile || (pl_data->condition & PL_COND_FLAG_SYSTEM_MOTION)) {
+    return(__real_plan_buffer_line(target, pl_data));
+  }
+
+  sigset_t mask, old_mask;
+  struct timespec start, end;
+  sigemptyset(&mask);
+  sigaddset(&mask, SIGALRM);
+  sigprocmask(SIG_BLOCK, &mask, &old_mask);
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  uint8_t plan_status = __real_plan_buffer_line(target, pl_data);
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  sigprocmask(SIG_SETMASK, &old_mask, NULL);
+
+  if (plan_status != PLAN_OK) { profile.empty++; return(plan_status); }
+  uint64_t ns = (uint64_t)(end.tv_sec-start.tv_sec)*1000000000 + end.tv_nsec - start.tv_nsec;
+  profile.blocks++;
+  profile.total_ns += ns;
+  if (ns > profile.max_ns) { profile.max_ns = ns; }
+  uint8_t bin = 0;
+  for (ns /= 1000; (ns > 0) && (bin < SIM_PLANNER_HISTOGRAM_BINS-1); ns >>= 1) { bin++; }
+  profile.histogram[bin]++;
+  return(plan_status);
+}
+
+
+void sim_planner_profile_report(FILE *out)
+{
+  fprintf(out, "# planner: %" PRIu32 " blocks, %" PRIu32 " empty, %.3f ms total, %.0f ns/block mean, %" PRIu64 " ns max\n",
+          profile.blocks, profile.empty, profile.total_ns/1e6,
+          (profile.blocks ? (double)profile.total_ns/profile.blocks : 0.0), profile.max_ns);
+  fprintf(out, "# planner histogram (us):");
+  uint8_t bin;
+  for (bin=0; bin<SIM_PLANNER_HISTOGRAM_BINS-1; bin++) {
+    fprintf(out, " <%u:%" PRIu32, 1u<<bin, profile.histogram[bin]);
+  }
+  fprintf(out, " >=%u:%" PRIu32, 1u<<(bin-1), profile.histogram[bin]);
+  fprintf(out, "\n");
+}
@@ -0,0 +1,619 @@
+/*
+  simulator.c - host simulator for Grbl
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* The simulator runs the unmodified Grbl sources natively. The firmware main loop runs as the
+   host's main program and drives a virtual clock counted in CPU cycles. Wherever the main program
+   loops or waits, it polls: the simulator wraps serial_read(), serial_write(), st_prep_buffer()
+   and protocol_execute_realtime() at link time, and implements the busy-wait delays. Each poll
+   advances the clock by SIM_POLL_CYCLES and calls the TIMER1, TIMER0, TIMER3 and USART0 interrupt
+   routines at the exact virtual times the programmed timer registers and the baud rate call for.
+   The Timer5 one-shot step pulses of STEP_PULSE_OUTPUT_COMPARE are timed the same way. Interrupts
+   fire only while the stubbed SREG I-flag is set, so Grbl's critical sections behave as on the AVR.
+
+   Since virtual time only depends on the program, and not on the speed of the host, the same
+   input always gives the same output and step log. A wall-clock watchdog runs virtual time for a
+   main program that spins without polling, like the wait for a reset after a critical alarm.
+
+   Serial data is read from stdin and Grbl's responses are written to stdout. Every step and
+   direction pin edge is logged with its virtual timestamp, so step timing can be checked
+   against the planner and stepper algorithms without a logic analyzer.
+*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <signal.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+#include "../grbl/grbl.h"
+#include "simulator.h"
+
+// Define the stubbed I/O registers declared in avr/io.h.
+#define SIM_DEFINE_REGISTER_8(reg) volatile uint8_t reg;
+#define SIM_DEFINE_REGISTER_16(reg) volatile uint16_t reg;
+SIM_REGISTERS_8(SIM_DEFINE_REGISTER_8)
+SIM_REGISTERS_16(SIM_DEFINE_REGISTER_16)
+
+// Interrupt vectors. Weak, since some only exist with certain config.h options.
+void TIMER0_OVF_vect(void) __attribute__((weak));
+void TIMER0_COMPA_vect(void) __attribute__((weak));
+void TIMER1_COMPA_vect(void) __attribute__((weak));
+void TIMER3_COMPB_vect(void) __attribute__((weak));
+void TIMER3_OVF_vect(void) __attribute__((weak));
+void USART0_RX_vect(void) __attribute__((weak));
+void USART0_UDRE_vect(void) __attribute__((weak));
+
+int avr_main(void); // Grbl's main(), renamed by the simulator Makefile.
+
+// Firmware functions wrapped by the simulator Makefile, see the polls below.
+uint8_t __real_serial_read();
+void __real_serial_write(uint8_t data);
+void __real_st_prep_buffer();
+void __real_protocol_execute_realtime();
+
+sim_t sim;
+
+
+// Returns the timer clock divider selected by the CSn2:0 bits of a TCCRnB register. Zero when
+// the timer is stopped or clocked externally.
+static uint16_t sim_timer_prescaler(uint8_t tccrb)
+{
+  switch (tccrb & 0x07) {
+    case 1: return(1);
+    case 2: return(8);
+    case 3: return(64);
+    case 4: return(256);
+    case 5: return(1024);
+  }
+  return(0);
+}
+
+
+// Samples the logical step and direction level of each axis and logs any change. Levels are
+// reported after the invert masks are applied, so a step '1' always marks the active pulse.
+// Changes are logged at the scheduled time of the interrupt, which the simulator may service
+// late when the main loop held the I-flag clear over a poll. The AVR only takes microseconds.
+// The axis index is logged with the name, since cloned axes share a name.
+static void sim_log_axis(uint8_t idx, uint8_t step_pin, uint8_t dir_pin)
+{
+  if (bit_istrue(settings.step_invert_mask,bit(idx))) { step_pin ^= 1; }
+  if (bit_istrue(settings.dir_invert_mask,bit(idx))) { dir_pin ^= 1; }
+  uint8_t pins = step_pin | (dir_pin << 1);
+  uint8_t changed = pins ^ sim.axis_pins[idx];
+  if (changed & 0x02) { fprintf(sim.step_log, "%" PRIu64 " %d %c dir %d\n", sim.event_time, idx, axis_name[idx], dir_pin); }
+  if (changed & 0x01) { fprintf(sim.step_log, "%" PRIu64 " %d %c step %d\n", sim.event_time, idx, axis_name[idx], step_pin); }
+  sim.axis_pins[idx] = pins;
+}
+
+#ifdef STEP_PULSE_OUTPUT_COMPARE
+  // Returns the level of a Timer5 output compare pin. While connected, the compare output drives
+  // it: active from the compare match until BOTTOM, idle otherwise. Grbl forces the compare
+  // output latches to the idle level beforehand, so the idle level follows from the mode alone.
+  static uint8_t sim_oc5_level(uint8_t channel, uint8_t port_level)
+  {
+    uint8_t com = (TCCR5A >> (6-2*channel)) & 0x03;
+    if (!com) { return(port_level); }
+    uint8_t active = (sim.timer5_pulse >> channel) & 1;
+    return((com == 3) ? active : !active); // Set on match for 3, cleared on match for 2.
+  }
+
+
+  // Returns the level of a step pin, which may be driven by a Timer5 output compare unit.
+  static uint8_t sim_step_pin(uint8_t idx, uint8_t port_level)
+  {
+    #ifdef STEP_OC5A_AXIS
+      if (idx == STEP_OC5A_AXIS) { return(sim_oc5_level(0, port_level)); }
+    #endif
+    #ifdef STEP_OC5B_AXIS
+      if (idx == STEP_OC5B_AXIS) { return(sim_oc5_level(1, port_level)); }
+    #endif
+    #ifdef STEP_OC5C_AXIS
+      if (idx == STEP_OC5C_AXIS) { return(sim_oc5_level(2, port_level)); }
+    #endif
+    return(port_level);
+  }
+#else
+  #define sim_step_pin(idx, port_level) (port_level)
+#endif
+
+#define SIM_LOG_AXIS(i) sim_log_axis(i, sim_step_pin(i, (STEP_PORT(i) >> STEP_BIT(i)) & 1), (DIRECTION_PORT(i) >> DIRECTION_BIT(i)) & 1)
+
+static void sim_log_pins()
+{
+  if (sim.step_log == NULL) { return; }
+  SIM_LOG_AXIS(0);
+  SIM_LOG_AXIS(1);
+  SIM_LOG_AXIS(2);
+  #if N_AXIS > 3
+    SIM_LOG_AXIS(3);
+  #endif
+  #if N_AXIS > 4
+    SIM_LOG_AXIS(4);
+  #endif
+  #if N_AXIS > 5
+    SIM_LOG_AXIS(5);
+  #endif
+}
+
+
+// Executes an interrupt routine the way the AVR does: with the I-flag cleared on entry and set
+// again by RETI. Grbl's stepper ISR re-enables interrupts internally, but nested interrupts are
+// simply deferred to their own scheduled time here.
+static void sim_interrupt(void (*vector)(void))
+{
+  if (vector == NULL) { return; }
+  SREG &= ~(1<<SREG_I);
+  vector();
+  SREG |= (1<<SREG_I);
+  sim_log_pins();
+}
+
+
+// Tracks the response stream to know when every line sent to Grbl has been answered.
+static void sim_serial_output(uint8_t data)
+{
+  putchar(data);
+  #ifdef ENABLE_BINARY_PROTOCOL
+    if (sim.tx_ack_remaining) { sim.tx_ack_remaining--; return; }
+    if (data == SERIAL_FRAME_ACK) { // A binary frame ack is one response.
+      if (sim.ready) { sim.responses++; }
+      sim.tx_ack_remaining = 4;
+      return;
+    }
+  #endif
+  if ((data == '\n') || (data == '\r')) {
+    if (sim.tx_line_length) {
+      sim.tx_line[sim.tx_line_length] = 0;
+      if (strncmp(sim.tx_line, "Grbl ", 5) == 0) { sim.ready = true; } // Welcome message.
+      else if (sim.ready && ((strcmp(sim.tx_line, "ok") == 0) || (strncmp(sim.tx_line, "error:", 6) == 0))) { sim.responses++; }
+    }
+    sim.tx_line_length = 0;
+  } else if (sim.tx_line_length < sizeof(sim.tx_line)-1) {
+    sim.tx_line[sim.tx_line_length++] = data;
+  }
+}
+
+
+#ifdef ENABLE_BINARY_PROTOCOL
+  // Binary frame tracking states of the host bytes. Follows the RX interrupt in serial.c.
+  #define SIM_FRAME_OFF     0
+  #define SIM_FRAME_IDLE    1
+  #define SIM_FRAME_LENGTH  2
+  #define SIM_FRAME_DATA    3
+  #define SIM_FRAME_ESCAPED bit(7)
+#endif
+
+// Counts the lines and binary frames sent to Grbl, each of which is answered by one response.
+static void sim_count_input(uint8_t data)
+{
+  #ifdef ENABLE_BINARY_PROTOCOL
+    uint8_t state = sim.rx_frame_state & ~SIM_FRAME_ESCAPED;
+    if (state >= SIM_FRAME_LENGTH) {
+      if (data == CMD_RESET) {
+        sim.rx_frame_state = SIM_FRAME_OFF;
+      } else if (data == SERIAL_FRAME_START) {
+        sim.rx_frame_state = SIM_FRAME_LENGTH; // The broken frame is acked with an error.
+        sim.lines_sent++;
+      } else if (data == SERIAL_FRAME_ESCAPE) {
+        sim.rx_frame_state |= SIM_FRAME_ESCAPED;
+      } else {
+        if (sim.rx_frame_state & SIM_FRAME_ESCAPED) { data ^= 0x20; }
+        if (state == SIM_FRAME_LENGTH) { sim.rx_frame_remaining = data; }
+        else { sim.rx_frame_remaining--; }
+        sim.rx_frame_state = SIM_FRAME_DATA;
+        if (sim.rx_frame_remaining == 0) {
+          sim.rx_frame_state = SIM_FRAME_IDLE;
+          sim.lines_sent++;
+        }
+      }
+      return;
+    }
+    if (state == SIM_FRAME_IDLE) {
+      if (data == SERIAL_FRAME_START) { sim.rx_frame_state = SIM_FRAME_LENGTH; }
+      else if (data == CMD_BINARY_MODE_EXIT) { sim.rx_frame_state = SIM_FRAME_OFF; }
+      return;
+    }
+    if (data == CMD_BINARY_MODE_ENTER) { sim.rx_frame_state = SIM_FRAME_IDLE; }
+  #endif
+  if ((data == '\n') || (data == '\r')) { sim.lines_sent++; }
+}
+
+
+// Fetches the next host byte. Like a host that waits for the welcome message, nothing is sent
+// before Grbl is ready, and bytes are only handed to the RX interrupt when Grbl's receive buffer
+// has room, which acts like hardware flow control. The read blocks virtual time until the byte
+// is there, so every byte arrives at the same virtual time in each run. Only interactive input
+// is read without blocking, and virtual time runs on while the user types.
+static void sim_serial_input()
+{
+  if ((sim.rx_byte >= 0) || sim.eof || !sim.ready) { return; }
+  uint8_t data;
+  if (!sim.interactive) { fflush(stdout); } // A waiting host gets all responses first.
+  ssize_t count = read(STDIN_FILENO, &data, 1);
+  if (count == 1) {
+    sim.rx_byte = data;
+  } else if ((count == 0) || ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR))) {
+    sim.eof = true;
+  }
+}
+
+
+// Arms or disarms the virtual timers according to their current control registers.
+static void sim_schedule_timers()
+{
+  uint16_t prescaler = sim_timer_prescaler(TCCR1B);
+  if ((TIMSK1 & (1<<OCIE1A)) && prescaler) {
+    if (!sim.timer1_next) { sim.timer1_next = sim.clock + ((uint64_t)OCR1A+1)*prescaler; }
+  } else {
+    sim.timer1_next = 0;
+  }
+
+  if (!sim_timer_prescaler(TCCR0B)) {
+    sim.timer0_ovf_next = 0;
+    sim.timer0_compa_next = 0;
+  }
+
+  prescaler = sim_timer_prescaler(TCCR3B);
+  if ((TIMSK3 & (1<<TOIE3)) && prescaler) {
+    if (!sim.timer3_next) { sim.timer3_next = sim.clock + (0x10000-(uint64_t)TCNT3)*prescaler; }
+  } else {
+    sim.timer3_next = 0;
+  }
+
+  // Timer3 does not count here, so the compare match comes OCR3B-TCNT3 ticks after it is armed.
+  // Grbl clears the compare flag, which takes a written one, whenever it sets a new match.
+  if ((TIMSK3 & (1<<OCIE3B)) && prescaler) {
+    if (!sim.timer3_compb_next || (TIFR3 & (1<<OCF3B))) {
+      sim.timer3_compb_next = sim.clock + (uint64_t)((uint16_t)(OCR3B-TCNT3))*prescaler;
+    }
+  } else {
+    sim.timer3_compb_next = 0;
+  }
+  TIFR3 &= ~(1<<OCF3B);
+
+  // Time to shift one byte through the USART, with start, 8 data and stop bits, at the programmed
+  // baud rate. Follows baud rate changes by $B=.
+  uint64_t char_time = 10*(((uint16_t)UBRR0H << 8) + UBRR0L + 1)*((UCSR0A & (1<<U2X0)) ? 8 : 16);
+  sim_serial_input();
+  if ((sim.rx_byte >= 0) && (UCSR0B & (1<<RXCIE0)) && serial_get_rx_buffer_available()) {
+    if (!sim.rx_next) { sim.rx_next = sim.clock + char_time; }
+  } else {
+    sim.rx_next = 0;
+  }
+
+  if (UCSR0B & (1<<UDRIE0)) {
+    if (!sim.tx_next) { sim.tx_next = sim.clock + char_time; }
+  } else {
+    sim.tx_next = 0;
+  }
+}
+
+
+// Starts Timer0 from the count just loaded by the stepper interrupt.
+static void sim_start_timer0()
+{
+  uint16_t prescaler = sim_timer_prescaler(TCCR0B);
+  if (!prescaler) { return; }
+  if (TIMSK0 & (1<<TOIE0)) { sim.timer0_ovf_next = sim.event_time + (0x100-(uint64_t)TCNT0)*prescaler; }
+  if (TIMSK0 & (1<<OCIE0A)) { sim.timer0_compa_next = sim.event_time + ((uint8_t)(OCR0A-TCNT0))*(uint64_t)prescaler; }
+}
+
+
+// Starts the Timer5 one-shot from the count just loaded by the stepper interrupt. Timer5 rests at
+// zero, as TOP, between the pulses. A loaded count runs up to the compare matches, where the
+// connected pins turn active, and on to the wrap to BOTTOM, where they return to idle.
+static void sim_start_timer5()
+{
+  uint16_t prescaler = sim_timer_prescaler(TCCR5B);
+  if (!prescaler || ICR5 || !TCNT5) { return; }
+  uint16_t compare[3] = { OCR5A, OCR5B, OCR5C };
+  uint8_t channel;
+  for (channel = 0; channel < 3; channel++) {
+    sim.timer5_match_next[channel] = 0;
+    if (compare[channel] > TCNT5) {
+      sim.timer5_match_next[channel] = sim.event_time + (uint64_t)(compare[channel]-TCNT5)*prescaler;
+    }
+  }
+  sim.timer5_bottom_next = sim.event_time + (0x10000-(uint64_t)TCNT5)*prescaler;
+  TCNT5 = 0;
+}
+
+
+// Returns true and updates *next if the event time is set and earlier than *next.
+static uint8_t sim_earliest(uint64_t event, uint64_t *next)
+{
+  if (event && (event <= *next)) { *next = event; return(true); }
+  return(false);
+}
+
+
+// Advances the virtual clock to sim.target, firing every interrupt that comes due on the way.
+// Timers keep counting while the I-flag is clear. Interrupts that come due meanwhile stay pending
+// and fire late, as on the AVR, once the next poll finds the flag set again.
+static void sim_advance()
+{
+  for (;;) {
+    sim_schedule_timers();
+
+    uint64_t next = sim.target;
+    uint8_t event = 0;
+    if (sim_earliest(sim.timer5_bottom_next, &next)) { event = 8; }
+    if (sim_earliest(sim.timer5_match_next[0], &next) | sim_earliest(sim.timer5_match_next[1], &next) |
+        sim_earliest(sim.timer5_match_next[2], &next)) { event = 7; }
+    if (sim_earliest(sim.tx_next, &next)) { event = 6; }
+    if (sim_earliest(sim.rx_next, &next)) { event = 5; }
+    if (sim_earliest(sim.timer3_next, &next)) { event = 4; }
+    if (sim_earliest(sim.timer3_compb_next, &next)) { event = 9; }
+    if (sim_earliest(sim.timer0_ovf_next, &next)) { event = 3; }
+    if (sim_earliest(sim.timer0_compa_next, &next)) { event = 2; }
+    if (sim_earliest(sim.timer1_next, &next)) { event = 1; } // Highest priority vector last.
+
+    if (event && !(SREG & (1<<SREG_I))) {
+      sim.clock = sim.target;
+      return;
+    }
+    if (next > sim.clock) { sim.clock = next; }
+    sim.event_time = next;
+
+    switch (event) {
+      case 0: return;
+      case 1:
+        sim_interrupt(TIMER1_COMPA_vect);
+        // CTC mode: the counter restarted at the match, and a new OCR1A applies to this period.
+        sim.timer1_next = 0;
+        if (TIMSK1 & (1<<OCIE1A)) {
+          sim.timer1_next = next + ((uint64_t)OCR1A+1)*sim_timer_prescaler(TCCR1B);
+        }
+        sim_start_timer0();
+        sim_start_timer5();
+        break;
+      case 2:
+        sim.timer0_compa_next = 0;
+        sim_interrupt(TIMER0_COMPA_vect);
+        break;
+      case 3:
+        sim_interrupt(TIMER0_OVF_vect);
+        sim.timer0_ovf_next = 0;
+        if (sim_timer_prescaler(TCCR0B)) { sim.timer0_ovf_next = next + 0x100*(uint64_t)sim_timer_prescaler(TCCR0B); }
+        break;
+      case 4:
+        sim_interrupt(TIMER3_OVF_vect);
+        sim.timer3_next = next + 0x10000*(uint64_t)sim_timer_prescaler(TCCR3B);
+        break;
+      case 5:
+        sim.rx_next = 0;
+        UDR0 = sim.rx_byte;
+        sim_count_input(sim.rx_byte);
+        sim.rx_byte = -1;
+        sim_interrupt(USART0_RX_vect);
+        break;
+      case 6:
+        sim.tx_next = 0;
+        sim_interrupt(USART0_UDRE_vect);
+        sim_serial_output(UDR0);
+        break;
+      case 7: {
+        uint8_t channel;
+        for (channel = 0; channel < 3; channel++) {
+          if (sim.timer5_match_next[channel] == next) {
+            sim.timer5_match_next[channel] = 0;
+            sim.timer5_pulse |= bit(channel);
+          }
+        }
+        sim_log_pins();
+        break;
+      }
+      case 8:
+        sim.timer5_bottom_next = 0;
+        sim.timer5_pulse = 0;
+        sim_log_pins();
+        break;
+      case 9:
+        sim.timer3_compb_next = 0;
+        sim_interrupt(TIMER3_COMPB_vect);
+        break;
+    }
+  }
+}
+
+
+// Stops the simulation once the input is exhausted, every line has been answered and the
+// machine has come to rest, or when the virtual time limit is reached. The rest condition must
+// hold for SIM_REST_CYCLES, so the main loop gets to act on realtime commands sent last.
+static void sim_check_finished()
+{
+  uint8_t finished = (sim.time_limit && (sim.clock >= sim.time_limit));
+  if (sim.eof && (sim.rx_byte < 0) && (serial_get_rx_buffer_count() == 0) &&
+      (sim.responses >= sim.lines_sent) && !serial_get_tx_buffer_count() && !sys_rt_exec_state &&
+      (plan_get_current_block() == NULL) && !(sys.state & (STATE_CYCLE | STATE_HOMING | STATE_JOG | STATE_HOLD))) {
+    if (!sim.rest_since) { sim.rest_since = sim.clock; }
+    else if (sim.clock-sim.rest_since >= SIM_REST_CYCLES) { finished = true; }
+  } else {
+    sim.rest_since = 0;
+  }
+  if (finished) {
+    fflush(stdout);
+    if (sim.planner_profile) { sim_planner_profile_report(stderr); }
+    if (sim.step_log != NULL) {
+      fprintf(sim.step_log, "# end %" PRIu64 "\n", sim.clock);
+      fflush(sim.step_log);
+    }
+    _exit(0);
+  }
+}
+
+
+static uint64_t sim_host_time_ns()
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return((uint64_t)now.tv_sec*1000000000 + now.tv_nsec);
+}
+
+
+// Sleeps while virtual time runs ahead of the -s pace. Pacing does not change any result.
+static void sim_pace()
+{
+  if ((sim.speedup <= 0.0) || (sim.polls & 0xff)) { return; }
+  double ahead_ns = sim.clock*(1e9/F_CPU)/sim.speedup - (double)(sim_host_time_ns()-sim.pace_start_ns);
+  if (ahead_ns > 1e6) {
+    struct timespec delay = { (time_t)(ahead_ns/1e9), (long)fmod(ahead_ns, 1e9) };
+    nanosleep(&delay, NULL);
+  }
+}
+
+
+// Advances virtual time by the given number of cycles. Interrupt routines that poll or delay
+// only move the clock on, since the AVR would not serve other interrupts from them either.
+static void sim_run(uint64_t cycles)
+{
+  if (sim.in_poll) {
+    sim.clock += cycles;
+    return;
+  }
+  sim.in_poll = true;
+  sim.polls++;
+  sim.target = sim.clock + cycles;
+  sim_advance();
+  sim_pace();
+  if (sim.interactive) { fflush(stdout); }
+  sim_check_finished();
+  sim.in_poll = false;
+}
+
+
+void sim_poll()
+{
+  sim_run(SIM_POLL_CYCLES);
+}
+
+
+void sim_delay_us(double us)
+{
+  sim_run((uint64_t)(us*(F_CPU/1000000.0)));
+}
+
+
+// Runs virtual time in real time for a main program that has not polled for a whole watchdog
+// period. This only happens in loops that wait for an interrupt without calling anything the
+// simulator wraps, like the wait for a reset after a critical alarm.
+static void sim_watchdog(int signum)
+{
+  static uint32_t polls;
+  if (!sim.in_poll && (sim.polls == polls)) { sim_run(SIM_WATCHDOG_USEC*(F_CPU/1000000)); }
+  polls = sim.polls;
+}
+
+
+// Wrapped firmware functions. The main program calls these wherever it loops or waits.
+uint8_t __wrap_serial_read()
+{
+  sim_poll();
+  return(__real_serial_read());
+}
+
+
+void __wrap_serial_write(uint8_t data)
+{
+  // Polls while the TX buffer is full, where serial_write() would wait for the UDRE interrupt.
+  while ((serial_get_tx_buffer_count() >= TX_BUFFER_SIZE) && !(sys_rt_exec_state & EXEC_RESET) && !sim.in_poll) {
+    sim_poll();
+  }
+  __real_serial_write(data);
+}
+
+
+void __wrap_st_prep_buffer()
+{
+  sim_poll();
+  __real_st_prep_buffer();
+}
+
+
+void __wrap_protocol_execute_realtime()
+{
+  sim_poll();
+  __real_protocol_execute_realtime();
+}
+
+
+static void sim_usage(const char *name)
+{
+  fprintf(stderr,
+    "Usage: %s [options] < input.gcode\n"
+    "  -l <file>   Write the step/direction edge log to <file> (default: stderr)\n"
+    "  -n          Disable the step/direction edge log\n"
+    "  -e <file>   Keep the EEPROM image in <file> across runs\n"
+    "  -p          Time the planner for every block and report on exit (stderr)\n"
+    "  -i          Read stdin without blocking, for a host that waits for responses (default: if a terminal)\n"
+    "  -s <factor> Pace virtual time at <factor> times real time (default: unpaced)\n"
+    "  -t <sec>    Stop after <sec> seconds of virtual time\n", name);
+  exit(1);
+}
+
+
+int main(int argc, char *argv[])
+{
+  const char *eeprom_file = NULL;
+  int opt;
+
+  sim.step_log = stderr;
+  sim.rx_byte = -1;
+  sim.interactive = isatty(STDIN_FILENO);
+  while ((opt = getopt(argc, argv, "l:ne:pis:t:h")) != -1) {
+    switch (opt) {
+      case 'l':
+        sim.step_log = fopen(optarg, "w");
+        if (sim.step_log == NULL) { perror(optarg); exit(1); }
+        break;
+      case 'n': sim.step_log = NULL; break;
+      case 'e': eeprom_file = optarg; break;
+      case 'p': sim.planner_profile = true; break;
+      case 'i': sim.interactive = true; break;
+      case 's': sim.speedup = atof(optarg); if (sim.speedup <= 0.0) { sim_usage(argv[0]); } break;
+      case 't': sim.time_limit = (uint64_t)(atof(optarg)*F_CPU); break;
+      default: sim_usage(argv[0]);
+    }
+  }
+  if (sim.step_log != NULL) {
+    fprintf(sim.step_log, "# Grbl %s simulator step log. Time in CPU cycles at %lu Hz.\n", GRBL_VERSION, (unsigned long)F_CPU);
+    fprintf(sim.step_log, "# time axis_index axis_name step|dir level\n");
+  }
+
+  sim.pace_start_ns = sim_host_time_ns();
+  sim_eeprom_init(eeprom_file);
+
+  // Input pins idle high through the AVR pull-ups: limits, probe and control inputs released.
+  PINA = PINB = PINC = PIND = PINE = PINF = PING = PINH = PINJ = PINK = PINL = 0xff;
+  // Start with interrupts enabled. On a blank EEPROM, settings_init() prints the whole settings
+  // report before main() calls sei(), which would otherwise stall on the full TX buffer.
+  SREG = (1<<SREG_I);
+
+  if (sim.interactive) { fcntl(STDIN_FILENO, F_SETFL, fcntl(STDIN_FILENO, F_GETFL) | O_NONBLOCK); }
+
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = sim_watchdog;
+  action.sa_flags = SA_RESTART;
+  sigaction(SIGALRM, &action, NULL);
+  struct itimerval timer = { { 0, SIM_WATCHDOG_USEC }, { 0, SIM_WATCHDOG_USEC } };
+  setitimer(ITIMER_REAL, &timer, NULL);
+
+  return(avr_main());
+}
@@ -0,0 +1,89 @@
+/*
+  simulator.h - host simulator for Grbl
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef simulator_h
+#define simulator_h
+
+#include <stdint.h>
+#include <stdio.h>
+
+// Virtual CPU cycles that each poll by the firmware takes. Polls are the calls the main program
+// makes while it loops or waits, see sim_poll(). They alone advance virtual time.
+#define SIM_POLL_CYCLES 160
+
+// Wall-clock period of the watchdog, which runs virtual time in real time for a main program
+// that is stuck in a loop without any poll, like the wait for a reset after a critical alarm.
+#define SIM_WATCHDOG_USEC 10000
+
+// The machine must stay at rest this many virtual cycles after the input ended to finish the run.
+#define SIM_REST_CYCLES (F_CPU/1000)
+
+typedef struct {
+  volatile uint64_t clock;    // Virtual time in CPU cycles since power-up.
+  uint64_t target;            // Virtual time the simulator is catching up to.
+  uint64_t time_limit;        // Stop after this many virtual cycles. Zero disables.
+  double speedup;             // Virtual time paced at this many times real time. Zero runs unpaced.
+  uint64_t pace_start_ns;     // Host time the pacing started at.
+  uint32_t polls;             // Polls so far. The watchdog checks that it keeps changing.
+  uint8_t in_poll;            // Set while polling. Interrupt routines may poll too.
+  uint8_t interactive;        // stdin is a terminal. Read without blocking.
+
+  uint64_t timer0_ovf_next;   // Next event times in CPU cycles. Zero when not scheduled.
+  uint64_t timer0_compa_next;
+  uint64_t timer1_next;
+  uint64_t timer3_next;
+  uint64_t timer3_compb_next; // Stepper idle lock timeout.
+  uint64_t timer5_match_next[3]; // Output compare A, B and C matches of the Timer5 one-shot step pulse.
+  uint64_t timer5_bottom_next;
+  uint64_t rx_next;
+  uint64_t tx_next;
+  uint64_t event_time;        // Scheduled time of the interrupt being serviced.
+
+  uint8_t ready;              // Set once Grbl has printed its welcome message.
+  int rx_byte;                // Next host byte waiting for the RX interrupt. -1 when none.
+  uint8_t eof;                // Set when stdin reaches end of file.
+  uint32_t lines_sent;        // Line terminators passed to Grbl.
+  uint32_t responses;         // 'ok' and 'error:' responses received from Grbl.
+  uint64_t rest_since;        // Virtual time the machine was first found at rest after the input ended.
+  char tx_line[8];            // Start of the current response line, for counting responses.
+  uint8_t tx_line_length;
+  uint8_t rx_frame_state;     // Binary frame tracking of the host bytes, as in serial.c.
+  uint8_t rx_frame_remaining;
+  uint8_t tx_ack_remaining;   // Binary ack bytes still to pass, not part of a response line.
+
+  uint8_t planner_profile;    // Time plan_buffer_line() calls and report on exit.
+
+  FILE *step_log;             // Step/direction edge log. NULL disables logging.
+  uint8_t axis_pins[6];       // Last logged step (bit 0) and direction (bit 1) levels per axis.
+  uint8_t timer5_pulse;       // Timer5 output compare channels between their match and BOTTOM.
+} sim_t;
+extern sim_t sim;
+
+// Loads the emulated EEPROM from a file image. NULL keeps it in memory only.
+void sim_eeprom_init(const char *filename);
+
+// Prints the plan_buffer_line() timing summary collected with -p.
+void sim_planner_profile_report(FILE *out);
+
+// Advances virtual time by one poll, firing the interrupts that come due.
+void sim_poll();
+
+// Advances the virtual clock by the given time, as a busy-wait delay on the AVR would.
+void sim_delay_us(double us);
+
+#endif
@@ -0,0 +1,46 @@
+/*
+  trig_check.c - accuracy check of sin_cos_f() against libm
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Sweeps sin_cos_f() from nuts_bolts.c over the angles that the arc code passes to it, and
+   reports the largest error against the double precision libm sin() and cos(). Built by
+   'make trig_check' with USE_TRIG_LOOKUP_TABLE, so the table kernel is the one checked.
+*/
+
+#include <stdio.h>
+#include "../grbl/grbl.h"
+
+#define TRIG_CHECK_RANGE (4.0*M_PI) // Angles in [-RANGE,RANGE]. Arcs pass at most 2*pi.
+#define TRIG_CHECK_STEPS 2000000
+
+int main(void)
+{
+  double max_err = 0.0, max_err_angle = 0.0, sum_err = 0.0;
+  float s, c;
+  long i;
+  for (i=0; i<=TRIG_CHECK_STEPS; i++) {
+    float angle = TRIG_CHECK_RANGE*(2.0*i/TRIG_CHECK_STEPS - 1.0);
+    sin_cos_f(angle, &s, &c);
+    double err = fmax(fabs(s - sin((double)angle)), fabs(c - cos((double)angle)));
+    sum_err += err;
+    if (err > max_err) { max_err = err; max_err_angle = angle; }
+  }
+  // Float ulp of values near one is 1.19e-7. Errors of the same order come from float rounding.
+  printf("sin_cos_f: %ld angles in [-%.4f,%.4f] rad, max error %.3g at %.6f rad, mean error %.3g\n",
+    (long)TRIG_CHECK_STEPS+1, TRIG_CHECK_RANGE, TRIG_CHECK_RANGE, max_err, max_err_angle, sum_err/(TRIG_CHECK_STEPS+1));
+  return(max_err > 5.0e-7);
+}